@@ -6,10 +6,12 @@
 
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport concurrent
 
 TARGET = Plot_tool
 TEMPLATE = app
+# C++17, so new honours the cache line alignment of CSpscRing in heap allocated owners
+CONFIG += c++17
 
 # The following define makes your compiler emit warnings if you use
 # any feature of Qt which as been marked as deprecated (the exact warnings
@@ -17,6 +19,12 @@ TEMPLATE = app
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
+# Lets QCustomPlot reduce the data of all graphs concurrently during a replot (QCP::phConcurrentLines)
+greaterThan(QT_MAJOR_VERSION, 4): DEFINES += QCUSTOMPLOT_USE_CONCURRENT
+
+# Debug builds check the plotted data and compare the vectorized min/max kernels of QCustomPlot with its scalar loops
+CONFIG(debug, debug|release): DEFINES += QCUSTOMPLOT_CHECK_DATA
+
 # You can also make your code fail to compile if you use deprecated APIs.
 # In order to do so, uncomment the following line.
 # You can also select to disable deprecated APIs only up to a certain version of Qt.
@@ -27,13 +35,51 @@ SOURCES += \
         main.cpp \
         mainwindow.cpp \
         cethercatthread.cpp \
+        ccyclictimer.cpp \
+        clatencystats.cpp \
+        chdrhistogram.cpp \
+        cecatsimbackend.cpp \
+        cpdodecoder.cpp \
+        crtplacement.cpp \
+        ccapturefile.cpp \
+        ccapturerecorder.cpp \
+        ccapturereplayer.cpp \
+        ctrigger.cpp \
+        cclockmapping.cpp \
+        ctriggerdialog.cpp \
         qcustomplot.cpp
 
 HEADERS += \
         mainwindow.h \
         cethercatthread.h \
+        cethercatcommand.h \
+        ccyclictimer.h \
+        clatencystats.h \
+        chdrhistogram.h \
+        cecatbackend.h \
+        cecatsimbackend.h \
+        cpdodecoder.h \
+        crtplacement.h \
+        csamplerecord.h \
+        cspscring.h \
+        ccapturefile.h \
+        ccapturerecorder.h \
+        ccapturereplayer.h \
+        ctrigger.h \
+        cclockmapping.h \
+        ctriggerdialog.h \
         qcustomplot.h
 
 
+# Build against the IgH EtherCAT master with "qmake CONFIG+=igh",
+# otherwise only the simulated bus is available.
+igh {
+    DEFINES += HAVE_ECRT
+    LIBS += -lethercat
+    SOURCES += cecatmasterbackend.cpp
+    HEADERS += cecatmasterbackend.h
+}
+
 FORMS += \
-        mainwindow.ui
+        mainwindow.ui \
+        ctriggerdialog.ui
@@ -0,0 +1,227 @@
+#include "ccapturefile.h"
+#include <cstring>
+#include <limits>
+
+const char CCaptureFile::MAGIC[8] = { 'E', 'C', 'A', 'T', 'C', 'A', 'P', '\0' };
+
+Q_STATIC_ASSERT(sizeof(CCaptureHeader) == 64);
+
+CCaptureFile::CCaptureFile() :
+    _writing(false),
+    _bytesWritten(0),
+    _mapping(0),
+    _cycleCount(0)
+{
+    memset(&_header, 0, sizeof(_header));
+}
+
+CCaptureFile::~CCaptureFile()
+{
+    close();
+}
+
+bool CCaptureFile::create(const QString &path, int channelCount, qint64 cycleTimeNs, quint64 firstCycle, qint64 startTimestampNs)
+{
+    close();
+    _bytesWritten = 0;
+    if (channelCount <= 0 || channelCount > CSampleRecord::MAX_CHANNELS)
+        return fail(QString("Invalid channel count %1").arg(channelCount));
+
+    memset(&_header, 0, sizeof(_header));
+    memcpy(_header.magic, MAGIC, sizeof(MAGIC));
+    _header.version = VERSION;
+    _header.headerSize = sizeof(CCaptureHeader);
+    _header.channelCount = quint32(channelCount);
+    _header.cycleTimeNs = cycleTimeNs;
+    _header.firstCycle = firstCycle;
+    _header.startTimestampNs = startTimestampNs;
+
+    // The rows are buffered here, a second buffer inside QFile would only add a copy
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered))
+        return fail(_file.errorString());
+    _writing = true;
+    _writeBuffer.reserve(WRITE_BUFFER_SIZE);
+    _writeBuffer.append(reinterpret_cast<const char *>(&_header), sizeof(_header));
+    return true;
+}
+
+bool CCaptureFile::append(const CSampleRecord &record)
+{
+    if (!_writing)
+        return false;
+
+    const quint64 nextCycle = _header.firstCycle + _cycleCount;
+    if (record.cycle < nextCycle)
+        return fail(QString("Cycle %1 does not follow cycle %2").arg(record.cycle).arg(nextCycle - 1));
+    const int channels = channelCount();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    // Lost cycles are kept as NaN rows so the row index stays the cycle offset
+    for (quint64 cycle = nextCycle; cycle < record.cycle; ++cycle) {
+        char *row = appendRow();
+        if (!row)
+            return false;
+        memset(row, 0, valueOffset());
+        float *values = reinterpret_cast<float *>(row + valueOffset());
+        for (int ch = 0; ch < channels; ++ch)
+            values[ch] = nan;
+    }
+
+    char *row = appendRow();
+    if (!row)
+        return false;
+    memcpy(row, &record.timestampNs, sizeof(qint64));
+    memcpy(row + sizeof(qint64), &record.dcTimeNs, sizeof(quint64));
+    float *values = reinterpret_cast<float *>(row + valueOffset());
+    for (int ch = 0; ch < channels; ++ch)
+        values[ch] = ch < int(record.channelCount) ? float(record.values[ch]) : nan;
+    return true;
+}
+
+bool CCaptureFile::flush()
+{
+    if (!_writing)
+        return false;
+    return writeBuffer();
+}
+
+bool CCaptureFile::open(const QString &path)
+{
+    close();
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::ReadOnly))
+        return fail(_file.errorString());
+
+    if (_file.read(reinterpret_cast<char *>(&_header), sizeof(_header)) != qint64(sizeof(_header))
+            || memcmp(_header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        _file.close();
+        return fail(QString("%1 is not a capture file").arg(path));
+    }
+    if (_header.version == 0 || _header.version > VERSION || _header.headerSize < sizeof(CCaptureHeader)
+            || _header.channelCount == 0 || _header.channelCount > CSampleRecord::MAX_CHANNELS) {
+        _file.close();
+        return fail(QString("Unsupported capture format in %1").arg(path));
+    }
+
+    if (!map()) {
+        _file.close();
+        return false;
+    }
+    return true;
+}
+
+bool CCaptureFile::refresh()
+{
+    if (!_mapping)
+        return false;
+    const quint64 mappedCycles = _cycleCount;
+    return map() && _cycleCount > mappedCycles;
+}
+
+void CCaptureFile::close()
+{
+    if (_writing)
+        writeBuffer();
+    _writeBuffer.clear();
+    if (_mapping)
+        _file.unmap(_mapping);
+    _mapping = 0;
+    _writing = false;
+    _cycleCount = 0;
+    if (_file.isOpen())
+        _file.close();
+}
+
+const char *CCaptureFile::channelValues(int channel) const
+{
+    if (!_mapping || channel < 0 || channel >= channelCount())
+        return 0;
+    return reinterpret_cast<const char *>(_mapping) + _header.headerSize + valueOffset() + channel * int(sizeof(float));
+}
+
+qint64 CCaptureFile::timestamp(quint64 row) const
+{
+    if (!_mapping || row >= _cycleCount)
+        return 0;
+    qint64 timestampNs;
+    memcpy(&timestampNs, _mapping + _header.headerSize + row * quint64(rowSize()), sizeof(timestampNs));
+    return timestampNs;
+}
+
+quint64 CCaptureFile::dcTimestamp(quint64 row) const
+{
+    if (!_mapping || row >= _cycleCount || _header.version < 2)
+        return 0;
+    quint64 dcTimeNs;
+    memcpy(&dcTimeNs, _mapping + _header.headerSize + row * quint64(rowSize()) + sizeof(qint64), sizeof(dcTimeNs));
+    return dcTimeNs;
+}
+
+quint64 CCaptureFile::findRow(qint64 timestampNs) const
+{
+    // Binary search over the deadlines, which only grow from row to row
+    quint64 lower = 0;
+    quint64 upper = _cycleCount;
+    while (lower < upper) {
+        const quint64 middle = lower + (upper - lower) / 2;
+        // Rows of lost cycles have no deadline, the next recorded row stands in for them
+        quint64 probe = middle;
+        while (probe < upper && timestamp(probe) == 0)
+            ++probe;
+        if (probe < upper && timestamp(probe) < timestampNs)
+            lower = probe + 1;
+        else
+            upper = middle;
+    }
+    while (lower < _cycleCount && timestamp(lower) == 0)
+        ++lower;
+    return lower;
+}
+
+bool CCaptureFile::fail(const QString &message)
+{
+    _errorString = message;
+    return false;
+}
+
+char *CCaptureFile::appendRow()
+{
+    const int size = rowSize();
+    if (_writeBuffer.size() + size > WRITE_BUFFER_SIZE && !writeBuffer())
+        return 0;
+    const int offset = _writeBuffer.size();
+    _writeBuffer.resize(offset + size);
+    ++_cycleCount;
+    return _writeBuffer.data() + offset;
+}
+
+bool CCaptureFile::writeBuffer()
+{
+    if (_writeBuffer.isEmpty())
+        return true;
+    const qint64 written = _file.write(_writeBuffer.constData(), _writeBuffer.size());
+    if (written != _writeBuffer.size())
+        return fail(_file.errorString());
+    _bytesWritten += quint64(written);
+    _writeBuffer.resize(0);
+    return true;
+}
+
+bool CCaptureFile::map()
+{
+    // A writer may be in the middle of a row, only complete rows are mapped
+    const qint64 fileSize = _file.size();
+    const quint64 cycles = fileSize > _header.headerSize ? quint64(fileSize - _header.headerSize) / quint64(rowSize()) : 0;
+    if (_mapping && cycles == _cycleCount)
+        return true;
+
+    // The mapping starts at offset 0, which keeps it page aligned, and includes the header
+    uchar *mapping = _file.map(0, qint64(_header.headerSize) + qint64(cycles) * rowSize());
+    if (!mapping)
+        return fail(_file.errorString());
+    if (_mapping)
+        _file.unmap(_mapping);
+    _mapping = mapping;
+    _cycleCount = cycles;
+    return true;
+}
@@ -0,0 +1,179 @@
+#ifndef CCAPTUREFILE_H
+#define CCAPTUREFILE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+#include "csamplerecord.h"
+
+/**
+ * @brief Fixed-size header at the start of a capture file
+ *
+ * The header is written once when the capture is created and never changed,
+ * so a reader can map a file that is still being appended to. The number of
+ * recorded cycles follows from the file size.
+ */
+struct CCaptureHeader
+{
+    /**
+     * @brief Identifies the file format, CCaptureFile::MAGIC
+     */
+    char magic[8];
+    quint32 version;
+    /**
+     * @brief Offset of the first row in bytes
+     */
+    quint32 headerSize;
+    quint32 channelCount;
+    quint32 reserved;
+    qint64 cycleTimeNs;
+    /**
+     * @brief Cycle counter of the first row
+     */
+    quint64 firstCycle;
+    /**
+     * @brief CLOCK_MONOTONIC time of the first cycle deadline, in nanoseconds
+     */
+    qint64 startTimestampNs;
+    quint8 padding[16];
+};
+
+/**
+ * @brief Append-only binary recording of the sampled channels
+ *
+ * After the CCaptureHeader the file holds one row per bus cycle: the
+ * CLOCK_MONOTONIC deadline of the cycle as qint64 nanoseconds and the
+ * distributed-clock time of its frame as quint64 nanoseconds, followed by
+ * one float per channel. The DC time is 0 if the bus had no reference clock.
+ * Version 1 files have no DC time column, they are still read. Rows are only ever appended and cycles lost on the
+ * way are written as NaN rows, so row @em i always belongs to cycle
+ * firstCycle + @em i and the keys of a channel are implicit.
+ *
+ * Rows are collected in a large buffer and handed to the operating system in
+ * WRITE_BUFFER_SIZE chunks, so recording costs few system calls.
+ *
+ * A file is either created for writing with create() and append(), or
+ * opened for reading with open(). A reader maps the file into memory instead
+ * of loading it, so captures larger than RAM can be plotted with
+ * QCPGraphColumnContainer::setExternalValues() on channelValues(). A writer
+ * may keep appending to the same file while it is read, refresh() maps the
+ * rows written since.
+ */
+class CCaptureFile
+{
+public:
+    /**
+     * @brief Format identifier stored in CCaptureHeader::magic
+     */
+    static const char MAGIC[8];
+    enum { VERSION = 2 };
+    /**
+     * @brief Bytes collected by append() before they are written out
+     */
+    enum { WRITE_BUFFER_SIZE = 4 * 1024 * 1024 };
+
+    CCaptureFile();
+    ~CCaptureFile();
+
+    /**
+     * @brief Creates or truncates @p path and writes the header
+     *
+     * The first appended record must belong to @p firstCycle.
+     */
+    bool create(const QString &path, int channelCount, qint64 cycleTimeNs, quint64 firstCycle, qint64 startTimestampNs);
+    /**
+     * @brief Appends the row of @p record, preceded by NaN rows for the cycles lost since the last one
+     *
+     * Fails for a record of a cycle that was already written, e.g. after the
+     * cycle counter restarted with the bus, nothing is written then. The row
+     * is buffered, see flush().
+     */
+    bool append(const CSampleRecord &record);
+    /**
+     * @brief Hands the buffered rows to the operating system, so readers see them
+     */
+    bool flush();
+    /**
+     * @brief Bytes handed to the operating system since create(), including the header
+     */
+    quint64 bytesWritten() const { return _bytesWritten; }
+    /**
+     * @brief Opens an existing capture for reading and maps all complete rows
+     */
+    bool open(const QString &path);
+    /**
+     * @brief Maps the rows a writer has appended since open() or the last refresh()
+     *
+     * Returns @em true if there are new rows. The previous mapping is released,
+     * so the pointers returned by channelValues() before must not be used
+     * anymore.
+     */
+    bool refresh();
+    /**
+     * @brief Finishes writing or releases the mapping
+     */
+    void close();
+
+    bool isWriting() const { return _writing; }
+    bool isMapped() const { return _mapping != 0; }
+    QString fileName() const { return _file.fileName(); }
+    QString errorString() const { return _errorString; }
+    int channelCount() const { return int(_header.channelCount); }
+    qint64 cycleTime() const { return _header.cycleTimeNs; }
+    quint64 firstCycle() const { return _header.firstCycle; }
+    qint64 startTimestamp() const { return _header.startTimestampNs; }
+    /**
+     * @brief Number of complete rows, written or mapped
+     */
+    quint64 cycleCount() const { return _cycleCount; }
+    /**
+     * @brief Size of one row in bytes, the stride between two values of a channel
+     */
+    int rowSize() const { return valueOffset() + channelCount() * int(sizeof(float)); }
+    /**
+     * @brief Cycle deadline of mapped row @p row in nanoseconds, 0 for rows of lost cycles
+     */
+    qint64 timestamp(quint64 row) const;
+    /**
+     * @brief First mapped row whose cycle deadline is not earlier than @p timestampNs
+     *
+     * Rows of lost cycles are skipped. Returns cycleCount() if there is none.
+     */
+    quint64 findRow(qint64 timestampNs) const;
+    /**
+     * @brief Distributed-clock time of mapped row @p row in nanoseconds, 0 for rows of lost cycles and without DC
+     */
+    quint64 dcTimestamp(quint64 row) const;
+    /**
+     * @brief First value of @p channel in the mapped rows, consecutive values are rowSize() apart
+     */
+    const char *channelValues(int channel) const;
+
+private:
+    QFile _file;
+    CCaptureHeader _header;
+    bool _writing;
+    /**
+     * @brief Rows appended but not written yet, see #WRITE_BUFFER_SIZE
+     */
+    QByteArray _writeBuffer;
+    quint64 _bytesWritten;
+    /**
+     * @brief Mapping of the header and all complete rows of a file opened for reading
+     */
+    uchar *_mapping;
+    quint64 _cycleCount;
+    QString _errorString;
+
+    bool fail(const QString &message);
+    char *appendRow();
+    bool writeBuffer();
+    bool map();
+    /**
+     * @brief Offset of the first channel value within a row, after the time columns of the file version
+     */
+    int valueOffset() const { return _header.version >= 2 ? 2 * int(sizeof(qint64)) : int(sizeof(qint64)); }
+};
+
+#endif // CCAPTUREFILE_H
@@ -0,0 +1,131 @@
+#include "ccapturerecorder.h"
+
+#include <QThread>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include "ccyclictimer.h"
+
+CCaptureRecorder::CCaptureRecorder(CSpscRing<CSampleRecord> *source, QObject *parent) :
+    QObject(parent),
+    _source(source),
+    _requestNs(0),
+    _batch(BATCH_SIZE),
+    _running(false),
+    _stop(false),
+    _bytesWritten(0),
+    _closedBytes(0),
+    _cyclesWritten(0),
+    _fileCount(0),
+    _lostCycles(0),
+    _peakBacklog(0)
+{
+}
+
+void CCaptureRecorder::requestRecording(const QString &path)
+{
+    _path = path;
+    _requestNs = CCyclicTimer::nowNs();
+    _bytesWritten.store(0, std::memory_order_relaxed);
+    _closedBytes = 0;
+    _cyclesWritten.store(0, std::memory_order_relaxed);
+    _fileCount.store(0, std::memory_order_relaxed);
+    _lostCycles.store(0, std::memory_order_relaxed);
+    _peakBacklog.store(0, std::memory_order_relaxed);
+    _stop.store(false, std::memory_order_release);
+    _running.store(true, std::memory_order_release);
+    qDebug()<<"Request recording to"<<path<<"in Thread "<<thread()->currentThreadId();
+
+    emit workRequested();
+}
+
+void CCaptureRecorder::stop()
+{
+    _stop.store(true, std::memory_order_release);
+}
+
+void CCaptureRecorder::doWork()
+{
+    qDebug()<<"Starting recorder in Thread "<<thread()->currentThreadId();
+
+    qint64 lastFlushNs = CCyclicTimer::nowNs();
+    bool ok = true;
+    while (ok) {
+        // Read the flag before draining, so everything queued before stop() is still written
+        const bool stopRequested = _stop.load(std::memory_order_acquire);
+
+        const quint32 backlog = _source->size();
+        if (backlog > _peakBacklog.load(std::memory_order_relaxed))
+            _peakBacklog.store(backlog, std::memory_order_relaxed);
+        const quint32 count = _source->popBulk(_batch.data(), quint32(_batch.size()));
+        ok = writeBatch(count);
+
+        const qint64 nowNs = CCyclicTimer::nowNs();
+        if (ok && _file.isWriting() && nowNs - lastFlushNs >= FLUSH_INTERVAL_MS * 1000000LL) {
+            ok = _file.flush();
+            lastFlushNs = nowNs;
+        }
+        _bytesWritten.store(_closedBytes + _file.bytesWritten(), std::memory_order_relaxed);
+
+        if (count == 0) {
+            if (stopRequested)
+                break;
+            // Nothing queued, the ring holds seconds of cycles so a short nap is safe
+            QThread::msleep(5);
+        }
+    }
+
+    if (!ok)
+        emit error(QString("Recording to %1 failed: %2").arg(_file.fileName(), _file.errorString()));
+    _file.close();
+    _bytesWritten.store(_closedBytes + _file.bytesWritten(), std::memory_order_relaxed);
+    _running.store(false, std::memory_order_release);
+
+    qDebug()<<"Recorder finished in Thread "<<thread()->currentThreadId();
+    emit finished();
+}
+
+bool CCaptureRecorder::writeBatch(quint32 count)
+{
+    for (quint32 i = 0; i < count; ++i) {
+        const CSampleRecord &record = _batch.at(int(i));
+        if (record.publishNs < _requestNs)
+            continue;
+        // The rows of a file are keyed by one cycle grid, a new run of the bus or another cycle time starts the next file
+        if (_file.isWriting()
+                && (record.cycle < _file.firstCycle() + _file.cycleCount()
+                    || record.cycleTimeNs != _file.cycleTime()
+                    || int(record.channelCount) != _file.channelCount())) {
+            if (!_file.flush())
+                return false;
+            _file.close();
+            _closedBytes += _file.bytesWritten();
+        }
+        if (!_file.isWriting()) {
+            const quint32 index = _fileCount.load(std::memory_order_relaxed) + 1;
+            if (!_file.create(filePath(index), int(record.channelCount), record.cycleTimeNs, record.cycle, record.timestampNs))
+                return false;
+            _fileCount.store(index, std::memory_order_relaxed);
+        }
+
+        const quint64 before = _file.cycleCount();
+        if (!_file.append(record))
+            return false;
+        const quint64 added = _file.cycleCount() - before;
+        if (added > 1)
+            _lostCycles.fetch_add(added - 1, std::memory_order_relaxed);
+        _cyclesWritten.fetch_add(added, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+QString CCaptureRecorder::filePath(quint32 index) const
+{
+    if (index <= 1)
+        return _path;
+    const QFileInfo info(_path);
+    const QString name = info.suffix().isEmpty()
+            ? QString("%1-%2").arg(info.completeBaseName()).arg(index)
+            : QString("%1-%2.%3").arg(info.completeBaseName()).arg(index).arg(info.suffix());
+    return info.dir().filePath(name);
+}
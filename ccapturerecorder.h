@@ -0,0 +1,139 @@
+#ifndef CCAPTURERECORDER_H
+#define CCAPTURERECORDER_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <atomic>
+#include "ccapturefile.h"
+#include "csamplerecord.h"
+#include "cspscring.h"
+
+/**
+ * @brief Writes the cycles of the acquisition thread to a CCaptureFile
+ *
+ * Runs on a thread of its own and drains the record ring the acquisition
+ * thread fills (CEthercatThread::recordRing()), so the cycle loop never waits
+ * for the disk: if the recorder falls behind, the ring absorbs the backlog,
+ * and only if it overflows the producer counts the cycle as dropped. Cycles
+ * missing in the ring are written as NaN rows and counted in lostCycles().
+ *
+ * A file only holds one run of the bus at one cycle time and channel count.
+ * When the cycle counter restarts or one of these changes, the file is
+ * closed and the recording continues in the next one, see fileCount().
+ *
+ * The counters are updated while recording and can be read from any thread.
+ */
+class CCaptureRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Creates a recorder consuming @p source, which must outlive it
+     */
+    explicit CCaptureRecorder(CSpscRing<CSampleRecord> *source, QObject *parent = 0);
+
+    /**
+     * @brief Requests a recording into @p path
+     *
+     * Records queued before this call are discarded. The file is created
+     * when the first record arrives, since it carries the first cycle and
+     * the cycle time. Further files of the recording get a counter appended
+     * to the base name of @p path, "capture-2.ecap" for instance.
+     */
+    void requestRecording(const QString &path);
+    /**
+     * @brief Requests the recording to stop after writing all queued records
+     */
+    void stop();
+    bool isRecording() const { return _running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Bytes written to the file since the recording started
+     */
+    quint64 bytesWritten() const { return _bytesWritten.load(std::memory_order_relaxed); }
+    /**
+     * @brief Cycles written to the file, including NaN rows of lost cycles
+     */
+    quint64 cyclesWritten() const { return _cyclesWritten.load(std::memory_order_relaxed); }
+    /**
+     * @brief Files the recording was written to so far
+     */
+    quint32 fileCount() const { return _fileCount.load(std::memory_order_relaxed); }
+    /**
+     * @brief Cycles missing in the ring, written as NaN rows
+     */
+    quint64 lostCycles() const { return _lostCycles.load(std::memory_order_relaxed); }
+    /**
+     * @brief Largest number of records that waited in the ring, headroom left before drops
+     */
+    quint32 peakBacklog() const { return _peakBacklog.load(std::memory_order_relaxed); }
+
+private:
+    enum {
+        /**
+         * @brief Records moved out of the ring per popBulk()
+         */
+        BATCH_SIZE = 1024,
+        /**
+         * @brief Interval at which buffered rows are handed to the OS, so readers can follow
+         */
+        FLUSH_INTERVAL_MS = 250
+    };
+
+    CSpscRing<CSampleRecord> *_source;
+    CCaptureFile _file;
+    QString _path;
+    /**
+     * @brief Monotonic time of requestRecording(), older records are stale
+     */
+    qint64 _requestNs;
+    /**
+     * @brief Preallocated destination for CSpscRing::popBulk()
+     */
+    QVector<CSampleRecord> _batch;
+    std::atomic<bool> _running;
+    std::atomic<bool> _stop;
+    std::atomic<quint64> _bytesWritten;
+    /**
+     * @brief Bytes of the files of the recording that were already closed
+     */
+    quint64 _closedBytes;
+    std::atomic<quint64> _cyclesWritten;
+    std::atomic<quint32> _fileCount;
+    std::atomic<quint64> _lostCycles;
+    std::atomic<quint32> _peakBacklog;
+
+    /**
+     * @brief Writes the records of one batch, returns @em false on a file error
+     */
+    bool writeBatch(quint32 count);
+    /**
+     * @brief Path of the @p index-th file of the recording, counting from 1
+     */
+    QString filePath(quint32 index) const;
+
+signals:
+    /**
+     * @brief This signal is emitted when the recording was requested
+     * @sa requestRecording()
+     */
+    void workRequested();
+    /**
+     * @brief This signal is emitted when the capture file could not be written
+     */
+    void error(const QString &message);
+    /**
+     * @brief This signal is emitted when the recording has stopped and the file is closed
+     */
+    void finished();
+
+public slots:
+    /**
+     * @brief Drains the record ring into the file until stop() is called
+     */
+    void doWork();
+};
+
+#endif // CCAPTURERECORDER_H
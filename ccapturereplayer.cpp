@@ -0,0 +1,145 @@
+#include "ccapturereplayer.h"
+
+#include <QThread>
+#include <QDebug>
+#include <cstring>
+#include <limits>
+#include "ccyclictimer.h"
+
+CCaptureReplayer::CCaptureReplayer(QObject *parent) :
+    QObject(parent),
+    _samples(65536),
+    _row(0),
+    _speed(1.0),
+    _seekNs(-1),
+    _position(0),
+    _running(false),
+    _abort(false)
+{
+}
+
+bool CCaptureReplayer::open(const QString &path)
+{
+    _row = 0;
+    _seekNs.store(-1, std::memory_order_relaxed);
+    _position.store(0, std::memory_order_relaxed);
+    return _file.open(path);
+}
+
+void CCaptureReplayer::close()
+{
+    _file.close();
+}
+
+qint64 CCaptureReplayer::duration() const
+{
+    const quint64 rows = _file.cycleCount();
+    for (quint64 row = rows; row > 0; --row) {
+        const qint64 timestampNs = _file.timestamp(row - 1);
+        if (timestampNs != 0)
+            return timestampNs - _file.startTimestamp();
+    }
+    return 0;
+}
+
+void CCaptureReplayer::requestReplay()
+{
+    _abort.store(false, std::memory_order_release);
+    _running.store(true, std::memory_order_release);
+    qDebug()<<"Request replay of"<<_file.fileName()<<"in Thread "<<thread()->currentThreadId();
+
+    emit workRequested();
+}
+
+void CCaptureReplayer::abort()
+{
+    _abort.store(true, std::memory_order_release);
+}
+
+void CCaptureReplayer::setSpeed(double speed)
+{
+    _speed.store(qMax(speed, 0.0), std::memory_order_relaxed);
+}
+
+void CCaptureReplayer::seek(qint64 offsetNs)
+{
+    _seekNs.store(qMax(offsetNs, qint64(0)), std::memory_order_relaxed);
+}
+
+void CCaptureReplayer::doWork()
+{
+    qDebug()<<"Starting replay in Thread "<<thread()->currentThreadId();
+
+    const quint64 rows = _file.cycleCount();
+    const int channelCount = _file.channelCount();
+    CSampleRecord record;
+    memset(&record, 0, sizeof(record));
+    record.channelCount = quint32(channelCount);
+    // A capture row holds every channel, as if all domains were exchanged in every cycle
+    record.domainMask = ~0u;
+    record.channelMask = ~0u;
+    record.cycleTimeNs = _file.cycleTime();
+
+    // The replay clock maps capture deadlines to wall-clock times, anchored at the last start, seek or speed change
+    double speed = _speed.load(std::memory_order_relaxed);
+    qint64 wallAnchorNs = CCyclicTimer::nowNs();
+    while (_row < rows && _file.timestamp(_row) == 0)
+        ++_row;
+    qint64 captureAnchorNs = _file.timestamp(_row);
+    qint64 lastTimestampNs = captureAnchorNs;
+
+    while (!_abort.load(std::memory_order_acquire)) {
+        // A seek is handled before the end check, so seeking a finished replay restarts it
+        const qint64 seekNs = _seekNs.exchange(-1, std::memory_order_relaxed);
+        if (seekNs >= 0) {
+            _row = _file.findRow(_file.startTimestamp() + seekNs);
+            lastTimestampNs = _file.timestamp(_row);
+            captureAnchorNs = lastTimestampNs;
+            wallAnchorNs = CCyclicTimer::nowNs();
+        }
+        if (_row >= rows)
+            break;
+        const double requestedSpeed = _speed.load(std::memory_order_relaxed);
+        if (requestedSpeed != speed) {
+            speed = requestedSpeed;
+            captureAnchorNs = lastTimestampNs;
+            wallAnchorNs = CCyclicTimer::nowNs();
+        }
+
+        // Release every row that is due by now, at most one batch before checking the requests again
+        const qint64 nowNs = CCyclicTimer::nowNs();
+        const qint64 dueNs = speed > 0 ? captureAnchorNs + qint64((nowNs - wallAnchorNs) * speed)
+                                       : std::numeric_limits<qint64>::max();
+        int published = 0;
+        while (published < BATCH_SIZE && _row < rows) {
+            const qint64 timestampNs = _file.timestamp(_row);
+            if (timestampNs == 0) { // lost cycle, the gap in the cycle counter carries it on
+                ++_row;
+                continue;
+            }
+            if (timestampNs > dueNs)
+                break;
+
+            record.cycle = _file.firstCycle() + _row;
+            record.timestampNs = speed > 0 ? wallAnchorNs + qint64((timestampNs - captureAnchorNs) / speed) : nowNs;
+            record.dcTimeNs = _file.dcTimestamp(_row);
+            const float *values = reinterpret_cast<const float *>(_file.channelValues(0) + _row * quint64(_file.rowSize()));
+            for (int ch = 0; ch < channelCount; ++ch)
+                record.values[ch] = values[ch];
+            record.publishNs = CCyclicTimer::nowNs();
+            if (!_samples.push(record))
+                break; // the GUI is behind, wait for it instead of dropping
+            lastTimestampNs = timestampNs;
+            ++_row;
+            ++published;
+        }
+        _position.store(lastTimestampNs - _file.startTimestamp(), std::memory_order_relaxed);
+
+        if (published < BATCH_SIZE)
+            QThread::usleep(500);
+    }
+
+    _running.store(false, std::memory_order_release);
+    qDebug()<<"Replay finished in Thread "<<thread()->currentThreadId();
+    emit finished();
+}
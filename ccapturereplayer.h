@@ -0,0 +1,122 @@
+#ifndef CCAPTUREREPLAYER_H
+#define CCAPTUREREPLAYER_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include "ccapturefile.h"
+#include "csamplerecord.h"
+#include "cspscring.h"
+
+/**
+ * @brief Plays a CCaptureFile back as a stream of CSampleRecord
+ *
+ * The records go into sampleRing(), which the GUI drains exactly like the
+ * ring of CEthercatThread, so a replay exercises the same display path as
+ * the live bus. Runs on a thread of its own and reads the mapped file, so
+ * captures larger than RAM replay without loading them.
+ *
+ * Rows are released at their recorded deadlines scaled by setSpeed(). Each
+ * replayed record carries the wall-clock time it was due as its timestamp,
+ * so the latency statistics of the GUI stay meaningful. Unlike the live bus
+ * the replay never drops records: when the ring is full it waits for the GUI,
+ * which makes "as fast as possible" mean "as fast as the GUI drains".
+ */
+class CCaptureReplayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CCaptureReplayer(QObject *parent = 0);
+
+    /**
+     * @brief Opens the capture to replay, only call while no replay is running
+     */
+    bool open(const QString &path);
+    /**
+     * @brief Closes the capture, only call while no replay is running
+     */
+    void close();
+    QString errorString() const { return _file.errorString(); }
+    int channelCount() const { return _file.channelCount(); }
+    qint64 cycleTime() const { return _file.cycleTime(); }
+    /**
+     * @brief Time between the first and the last recorded deadline of the capture
+     */
+    qint64 duration() const;
+
+    /**
+     * @brief Requests the replay to start at the current position
+     */
+    void requestReplay();
+    /**
+     * @brief Requests the replay to stop, thread safe
+     */
+    void abort();
+    /**
+     * @brief Sets the replay speed relative to real time, 0 replays as fast as possible
+     *
+     * Thread safe, takes effect immediately.
+     */
+    void setSpeed(double speed);
+    double speed() const { return _speed.load(std::memory_order_relaxed); }
+    /**
+     * @brief Continues the replay at @p offsetNs after the first deadline of the capture
+     *
+     * Thread safe. Records of the old position that are still in the ring are
+     * delivered first, the cycle counter then jumps to the new position.
+     */
+    void seek(qint64 offsetNs);
+    /**
+     * @brief Deadline of the last replayed row, relative to the first deadline of the capture
+     */
+    qint64 position() const { return _position.load(std::memory_order_relaxed); }
+    bool isReplaying() const { return _running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Ring the replay writes its records into, drained by the GUI with CSpscRing::popBulk()
+     */
+    CSpscRing<CSampleRecord> *sampleRing() { return &_samples; }
+
+private:
+    enum {
+        /**
+         * @brief Most records published between two checks of the clock and the requests
+         */
+        BATCH_SIZE = 4096
+    };
+
+    CCaptureFile _file;
+    CSpscRing<CSampleRecord> _samples;
+    /**
+     * @brief Next row to replay, only touched by the replay thread while running
+     */
+    quint64 _row;
+    std::atomic<double> _speed;
+    /**
+     * @brief Pending seek offset, -1 if none
+     */
+    std::atomic<qint64> _seekNs;
+    std::atomic<qint64> _position;
+    std::atomic<bool> _running;
+    std::atomic<bool> _abort;
+
+signals:
+    /**
+     * @brief This signal is emitted when the replay was requested
+     * @sa requestReplay()
+     */
+    void workRequested();
+    /**
+     * @brief This signal is emitted when the replay reached the end of the capture or was aborted
+     */
+    void finished();
+
+public slots:
+    /**
+     * @brief Publishes the rows of the capture paced by their deadlines
+     */
+    void doWork();
+};
+
+#endif // CCAPTUREREPLAYER_H
@@ -0,0 +1,47 @@
+#include "cclockmapping.h"
+
+CClockMapping::CClockMapping()
+{
+    reset();
+}
+
+void CClockMapping::reset()
+{
+    _x0 = 0;
+    _y0 = 0;
+    _count = 0;
+    _weight = 0;
+    _meanX = 0;
+    _meanY = 0;
+    _sxx = 0;
+    _sxy = 0;
+}
+
+void CClockMapping::update(qint64 x, qint64 y)
+{
+    if (_count == 0) {
+        _x0 = x;
+        _y0 = y;
+    }
+    ++_count;
+
+    // Weighted Welford update, the older pairs decay by (1 - 1/TIME_CONSTANT) with every new one
+    const double decay = 1.0 - 1.0 / TIME_CONSTANT;
+    const double dx = double(x - _x0) - _meanX;
+    const double dy = double(y - _y0) - _meanY;
+    _weight = _weight * decay + 1.0;
+    _meanX += dx / _weight;
+    _meanY += dy / _weight;
+    _sxx = _sxx * decay + dx * (double(x - _x0) - _meanX);
+    _sxy = _sxy * decay + dx * (double(y - _y0) - _meanY);
+}
+
+qint64 CClockMapping::map(qint64 x) const
+{
+    return _y0 + qRound64(_meanY + rate() * (double(x - _x0) - _meanX));
+}
+
+qint64 CClockMapping::unmap(qint64 y) const
+{
+    return _x0 + qRound64(_meanX + (double(y - _y0) - _meanY) / rate());
+}
@@ -0,0 +1,89 @@
+#ifndef CCLOCKMAPPING_H
+#define CCLOCKMAPPING_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Linear mapping between two clocks, fitted incrementally from pairs of readings
+ *
+ * Each update() feeds one reading of both clocks taken at the same instant,
+ * e.g. the CLOCK_MONOTONIC time a frame was sent and the distributed-clock
+ * time it passed the reference clock. The mapping is the exponentially weighted least-squares line
+ * through roughly the last #TIME_CONSTANT pairs, so it follows the drift
+ * between the clocks and averages out the jitter of the single readings.
+ *
+ * update() is a handful of floating point operations without allocation,
+ * cheap enough for every cycle of the acquisition loop. The readings are kept
+ * relative to the first pair, so nanosecond timestamps of any epoch keep
+ * their precision. The mapping is a plain value and not thread safe, copies
+ * are handed between threads.
+ */
+class CClockMapping
+{
+public:
+    /**
+     * @brief Number of pairs after which the weight of a pair has dropped to 1/e
+     */
+    enum { TIME_CONSTANT = 1024 };
+
+    CClockMapping();
+
+    /**
+     * @brief Forgets all pairs
+     */
+    void reset();
+    /**
+     * @brief Adds the pair of readings @p x of the source clock and @p y of the target clock
+     */
+    void update(qint64 x, qint64 y);
+
+    /**
+     * @brief @em true once the pairs span more than one source clock reading
+     */
+    bool isValid() const { return _sxx > 0; }
+    /**
+     * @brief @em true once #TIME_CONSTANT pairs were fitted, so the jitter of the first readings has averaged out
+     */
+    bool isSettled() const { return isValid() && _count >= quint64(TIME_CONSTANT); }
+    quint64 count() const { return _count; }
+    /**
+     * @brief Target clock ticks per source clock tick, 1 while not valid
+     */
+    double rate() const { return isValid() ? _sxy / _sxx : 1.0; }
+    /**
+     * @brief Target clock reading corresponding to the source clock reading @p x
+     */
+    qint64 map(qint64 x) const;
+    /**
+     * @brief Source clock reading corresponding to the target clock reading @p y
+     */
+    qint64 unmap(qint64 y) const;
+    /**
+     * @brief Difference of the target clock to the source clock at @p x, map(@p x) - @p x
+     */
+    qint64 offset(qint64 x) const { return map(x) - x; }
+
+private:
+    /**
+     * @brief First pair, the origin of the relative readings
+     */
+    qint64 _x0;
+    qint64 _y0;
+    quint64 _count;
+    /**
+     * @brief Sum of the decayed weights
+     */
+    double _weight;
+    /**
+     * @brief Weighted means of the relative readings
+     */
+    double _meanX;
+    double _meanY;
+    /**
+     * @brief Weighted sums of the squared and cross deviations from the means
+     */
+    double _sxx;
+    double _sxy;
+};
+
+#endif // CCLOCKMAPPING_H
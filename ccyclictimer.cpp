@@ -0,0 +1,72 @@
+#include "ccyclictimer.h"
+#include <errno.h>
+
+const qint64 CCyclicTimer::MIN_CYCLE_TIME_NS;
+
+CCyclicTimer::CCyclicTimer(qint64 cycleTimeNs) :
+    _cycleTimeNs(MIN_CYCLE_TIME_NS),
+    _freeRunning(false),
+    _cycleCount(0),
+    _overruns(0)
+{
+    _deadline.tv_sec = 0;
+    _deadline.tv_nsec = 0;
+    setCycleTime(cycleTimeNs);
+}
+
+void CCyclicTimer::setCycleTime(qint64 cycleTimeNs)
+{
+    _cycleTimeNs = qMax(cycleTimeNs, MIN_CYCLE_TIME_NS);
+}
+
+void CCyclicTimer::start()
+{
+    _deadline = fromNs(nowNs());
+    _cycleCount = 0;
+    _overruns = 0;
+}
+
+quint32 CCyclicTimer::waitNextCycle()
+{
+    quint32 skipped = 0;
+    qint64 next = toNs(_deadline) + _cycleTimeNs;
+
+    if (_freeRunning) {
+        _deadline = fromNs(next);
+        ++_cycleCount;
+        return 0;
+    }
+
+    const qint64 now = nowNs();
+
+    if (now > next + _cycleTimeNs) {
+        // We are more than a full period late: drop the missed cycles and
+        // realign to the grid instead of running them back to back.
+        skipped = quint32((now - next) / _cycleTimeNs);
+        next += qint64(skipped) * _cycleTimeNs;
+        _overruns += skipped;
+    }
+
+    _deadline = fromNs(next);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &_deadline, NULL) == EINTR) {
+        // Restart after signal delivery, the deadline is absolute.
+    }
+
+    ++_cycleCount;
+    return skipped;
+}
+
+qint64 CCyclicTimer::nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return toNs(ts);
+}
+
+struct timespec CCyclicTimer::fromNs(qint64 ns)
+{
+    struct timespec ts;
+    ts.tv_sec = time_t(ns / 1000000000LL);
+    ts.tv_nsec = long(ns % 1000000000LL);
+    return ts;
+}
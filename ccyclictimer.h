@@ -0,0 +1,81 @@
+#ifndef CCYCLICTIMER_H
+#define CCYCLICTIMER_H
+
+#include <QtGlobal>
+#include <time.h>
+
+/**
+ * @brief Absolute-deadline cycle timer for the acquisition loop
+ *
+ * Sleeps with clock_nanosleep(TIMER_ABSTIME) on CLOCK_MONOTONIC, so the
+ * period does not drift with the time spent in the cycle body. No Qt event
+ * loop or allocation is involved once the timer is started.
+ */
+class CCyclicTimer
+{
+public:
+    /**
+     * @brief Shortest supported cycle time, 250 us (4 kHz)
+     */
+    static const qint64 MIN_CYCLE_TIME_NS = 250000;
+
+    explicit CCyclicTimer(qint64 cycleTimeNs = 1000000);
+
+    /**
+     * @brief Sets the cycle period in nanoseconds
+     *
+     * Values below #MIN_CYCLE_TIME_NS are clamped. Takes effect at the next
+     * call to waitNextCycle().
+     */
+    void setCycleTime(qint64 cycleTimeNs);
+    qint64 cycleTime() const { return _cycleTimeNs; }
+    /**
+     * @brief When @em true, waitNextCycle() does not sleep
+     *
+     * The deadlines still advance by one period per cycle, so they form a
+     * simulated time base. Meant for load tests against a simulated bus.
+     */
+    void setFreeRunning(bool enabled) { _freeRunning = enabled; }
+    bool freeRunning() const { return _freeRunning; }
+
+    /**
+     * @brief Anchors the cycle grid at the current time
+     */
+    void start();
+    /**
+     * @brief Sleeps until the next absolute deadline
+     *
+     * If the deadline has already passed (overrun), the timer does not try to
+     * catch up with a burst of back-to-back cycles: the missed periods are
+     * skipped and added to overruns().
+     *
+     * @return number of periods skipped by this call (0 when on time)
+     */
+    quint32 waitNextCycle();
+
+    /**
+     * @brief Deadline of the cycle that has just been entered
+     */
+    const struct timespec &deadline() const { return _deadline; }
+    /**
+     * @brief Number of cycles started since start()
+     */
+    quint64 cycleCount() const { return _cycleCount; }
+    /**
+     * @brief Total number of skipped periods since start()
+     */
+    quint64 overruns() const { return _overruns; }
+
+    static qint64 nowNs();
+    static qint64 toNs(const struct timespec &ts) { return qint64(ts.tv_sec) * 1000000000LL + ts.tv_nsec; }
+    static struct timespec fromNs(qint64 ns);
+
+private:
+    qint64 _cycleTimeNs;
+    bool _freeRunning;
+    struct timespec _deadline;
+    quint64 _cycleCount;
+    quint64 _overruns;
+};
+
+#endif // CCYCLICTIMER_H
@@ -0,0 +1,108 @@
+#ifndef CECATBACKEND_H
+#define CECATBACKEND_H
+
+#include <QtGlobal>
+#include <QString>
+
+/**
+ * @brief Identifies one PDO entry of one slave on the bus
+ */
+struct CEcatEntry
+{
+    /**
+     * @brief Ring position of the slave
+     */
+    quint16 position;
+    quint32 vendorId;
+    quint32 productCode;
+    quint16 index;
+    quint8 subindex;
+};
+
+/**
+ * @brief Process-data access to an EtherCAT master, as used by CEthercatThread
+ *
+ * Call order is open(), createDomain() for every domain beyond the first,
+ * registerEntry() for every entry of interest, activate(), then
+ * receive()/send() once per cycle from the acquisition thread, and finally
+ * close(). Failures are reported by the return value and described by
+ * errorString().
+ *
+ * Entries are grouped into process-data domains that are exchanged at rates
+ * of their own: receive() and send() only handle the domains selected by a
+ * bit mask, so a slow domain costs neither bus bandwidth nor CPU in the
+ * cycles it is not due.
+ */
+class CEcatBackend
+{
+public:
+    /**
+     * @brief Most domains a backend handles, one bit each in the masks of receive() and send()
+     */
+    enum { MAX_DOMAINS = 32 };
+
+    virtual ~CEcatBackend() {}
+
+    /**
+     * @brief Acquires the master and prepares an empty process-data domain 0
+     */
+    virtual bool open() = 0;
+    /**
+     * @brief Adds another empty process-data domain
+     * @return index of the new domain, or -1 on error
+     */
+    virtual int createDomain() = 0;
+    virtual int domainCount() const = 0;
+    /**
+     * @brief Adds @a entry to @a domain
+     * @param bitPosition receives the bit offset inside the returned byte, may be 0
+     * @return byte offset of the entry in processData() of @a domain, or -1 on error
+     */
+    virtual int registerEntry(const CEcatEntry &entry, int domain, uint *bitPosition) = 0;
+    /**
+     * @brief Finishes configuration and brings the domains into cyclic operation
+     */
+    virtual bool activate() = 0;
+    /**
+     * @brief Fetches the frames of the last cycle and updates processData() of the @a domains
+     *
+     * Bit i of @a domains selects domain i.
+     */
+    virtual void receive(quint32 domains) = 0;
+    /**
+     * @brief Queues the @a domains and sends the frames of the next cycle
+     */
+    virtual void send(quint32 domains) = 0;
+    virtual void close() = 0;
+    /**
+     * @brief Period receive() and send() are called with, in nanoseconds
+     *
+     * Called after open() before the first cycle and again whenever the cycle
+     * time changes at runtime. Ignored by default.
+     */
+    virtual void setCycleTime(qint64 cycleTimeNs) { Q_UNUSED(cycleTimeNs); }
+    /**
+     * @brief Distributed-clock time at which the frame read by the last receive() passed the reference clock
+     *
+     * EtherCAT system time in nanoseconds. The inputs of that receive() were
+     * latched in this frame, so it is the DC timestamp of the cycle. Returns
+     * @em false if the bus has no DC reference clock, the default.
+     */
+    virtual bool referenceClockTime(quint64 *timeNs) const { Q_UNUSED(timeNs); return false; }
+
+    /**
+     * @brief Raw image of @a domain, valid between activate() and close()
+     */
+    virtual const quint8 *processData(int domain) const = 0;
+    virtual quint32 processDataSize(int domain) const = 0;
+
+    QString errorString() const { return _errorString; }
+
+protected:
+    void setErrorString(const QString &errorString) { _errorString = errorString; }
+
+private:
+    QString _errorString;
+};
+
+#endif // CECATBACKEND_H
@@ -0,0 +1,162 @@
+#include "cecatmasterbackend.h"
+#include "ccyclictimer.h"
+
+CEcatMasterBackend::CEcatMasterBackend(uint masterIndex, quint16 dcAssignActivate) :
+    _masterIndex(masterIndex),
+    _dcAssignActivate(dcAssignActivate),
+    _cycleTimeNs(1000000),
+    _master(0),
+    _dcTimeNs(0),
+    _dcTimeValid(false)
+{
+}
+
+CEcatMasterBackend::~CEcatMasterBackend()
+{
+    close();
+}
+
+bool CEcatMasterBackend::open()
+{
+    close();
+
+    _master = ecrt_request_master(_masterIndex);
+    if (!_master) {
+        setErrorString(QString("Failed to request EtherCAT master %1").arg(_masterIndex));
+        return false;
+    }
+
+    if (createDomain() < 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+int CEcatMasterBackend::createDomain()
+{
+    if (!_master) {
+        setErrorString("Master is not open");
+        return -1;
+    }
+    if (_domains.size() >= MAX_DOMAINS) {
+        setErrorString(QString("At most %1 process data domains are supported").arg(int(MAX_DOMAINS)));
+        return -1;
+    }
+
+    ec_domain_t *domain = ecrt_master_create_domain(_master);
+    if (!domain) {
+        setErrorString("Failed to create process data domain");
+        return -1;
+    }
+    _domains.append(domain);
+    _processData.append(0);
+    _processDataSize.append(0);
+    return _domains.size() - 1;
+}
+
+int CEcatMasterBackend::registerEntry(const CEcatEntry &entry, int domain, uint *bitPosition)
+{
+    if (domain < 0 || domain >= _domains.size()) {
+        setErrorString(QString("Process data domain %1 does not exist").arg(domain));
+        return -1;
+    }
+
+    ec_slave_config_t *sc = _slaveConfigs.value(entry.position, 0);
+    if (!sc) {
+        sc = ecrt_master_slave_config(_master, 0, entry.position, entry.vendorId, entry.productCode);
+        if (!sc) {
+            setErrorString(QString("Failed to configure slave at position %1").arg(entry.position));
+            return -1;
+        }
+        _slaveConfigs.insert(entry.position, sc);
+    }
+
+    int offset = ecrt_slave_config_reg_pdo_entry(sc, entry.index, entry.subindex, _domains.at(domain), bitPosition);
+    if (offset < 0) {
+        setErrorString(QString("Failed to register PDO entry 0x%1:%2 of slave %3")
+                       .arg(entry.index, 4, 16, QChar('0')).arg(entry.subindex).arg(entry.position));
+        return -1;
+    }
+    return offset;
+}
+
+bool CEcatMasterBackend::activate()
+{
+    if (_dcAssignActivate != 0 && !_slaveConfigs.isEmpty()) {
+        // SYNC0 fires once per cycle, without shift, SYNC1 stays off
+        for (QMap<quint16, ec_slave_config_t *>::const_iterator it = _slaveConfigs.constBegin(); it != _slaveConfigs.constEnd(); ++it)
+            ecrt_slave_config_dc(it.value(), _dcAssignActivate, uint32_t(_cycleTimeNs), 0, 0, 0);
+        // The map is ordered by ring position, the first slave is closest to the master
+        if (ecrt_master_select_reference_clock(_master, _slaveConfigs.constBegin().value())) {
+            setErrorString(QString("Failed to select slave %1 as DC reference clock").arg(_slaveConfigs.constBegin().key()));
+            return false;
+        }
+    }
+
+    // The reference clock starts from the application time, which also gives the upper bits of its 32 bit reads
+    _dcTimeNs = quint64(CCyclicTimer::nowNs());
+    _dcTimeValid = false;
+    ecrt_master_application_time(_master, _dcTimeNs);
+    if (ecrt_master_activate(_master)) {
+        setErrorString("Failed to activate master");
+        return false;
+    }
+
+    for (int i = 0; i < _domains.size(); ++i) {
+        _processData[i] = ecrt_domain_data(_domains.at(i));
+        _processDataSize[i] = quint32(ecrt_domain_size(_domains.at(i)));
+        if (!_processData.at(i)) {
+            setErrorString(QString("Failed to get the data of domain %1").arg(i));
+            return false;
+        }
+    }
+    return true;
+}
+
+void CEcatMasterBackend::receive(quint32 domains)
+{
+    ecrt_master_receive(_master);
+    for (int i = 0; i < _domains.size(); ++i) {
+        if (domains & (1u << i))
+            ecrt_domain_process(_domains.at(i));
+    }
+
+    // Only the lower 32 bits are read (4.3 s), unwrapped against the last read
+    uint32_t dcTime;
+    _dcTimeValid = ecrt_master_reference_clock_time(_master, &dcTime) == 0;
+    if (_dcTimeValid)
+        _dcTimeNs += quint64(qint64(qint32(dcTime - quint32(_dcTimeNs))));
+}
+
+void CEcatMasterBackend::send(quint32 domains)
+{
+    // Domains that are not due stay off the wire until their next cycle
+    for (int i = 0; i < _domains.size(); ++i) {
+        if (domains & (1u << i))
+            ecrt_domain_queue(_domains.at(i));
+    }
+    ecrt_master_application_time(_master, quint64(CCyclicTimer::nowNs()));
+    ecrt_master_sync_slave_clocks(_master);
+    ecrt_master_send(_master);
+}
+
+void CEcatMasterBackend::close()
+{
+    if (_master)
+        ecrt_release_master(_master);
+
+    _master = 0;
+    _domains.clear();
+    _slaveConfigs.clear();
+    _processData.clear();
+    _processDataSize.clear();
+    _dcTimeValid = false;
+}
+
+bool CEcatMasterBackend::referenceClockTime(quint64 *timeNs) const
+{
+    if (_dcTimeValid)
+        *timeNs = _dcTimeNs;
+    return _dcTimeValid;
+}
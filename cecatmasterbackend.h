@@ -0,0 +1,74 @@
+#ifndef CECATMASTERBACKEND_H
+#define CECATMASTERBACKEND_H
+
+#include <QMap>
+#include <QVector>
+#include <ecrt.h>
+#include "cecatbackend.h"
+
+/**
+ * @brief CEcatBackend on top of the IgH EtherCAT master (ecrt_* API)
+ *
+ * Slaves are configured with their default PDO assignment from the SII, only
+ * the entries passed to registerEntry() are mapped into the domains. Each
+ * domain is an ec_domain_t of its own, processed and queued only in the
+ * cycles it is selected.
+ *
+ * The application time is CLOCK_MONOTONIC. activate() configures
+ * distributed clocks on every slave with the assign-activate word of the
+ * constructor and a SYNC0 period of the cycle time, and selects the first
+ * slave as the reference clock. Every send() also queues the datagram that
+ * distributes the reference clock to the other DC slaves, its answer is read
+ * back as referenceClockTime(). The reference clock is never adjusted to the
+ * host, CEthercatThread fits the mapping between the two. The SYNC0 period
+ * stays at the cycle time of activate(), later setCycleTime() calls only
+ * change how often the frames are sent.
+ */
+class CEcatMasterBackend : public CEcatBackend
+{
+public:
+    /**
+     * @brief Assign-activate word that enables SYNC0 on most slaves
+     */
+    enum { DC_ASSIGN_ACTIVATE_SYNC0 = 0x0300 };
+
+    /**
+     * @param dcAssignActivate written to register 0x0980 of every slave, 0 leaves distributed clocks off
+     */
+    explicit CEcatMasterBackend(uint masterIndex = 0, quint16 dcAssignActivate = DC_ASSIGN_ACTIVATE_SYNC0);
+    ~CEcatMasterBackend();
+
+    bool open();
+    int createDomain();
+    int domainCount() const { return _domains.size(); }
+    int registerEntry(const CEcatEntry &entry, int domain, uint *bitPosition);
+    bool activate();
+    void receive(quint32 domains);
+    void send(quint32 domains);
+    void close();
+    void setCycleTime(qint64 cycleTimeNs) { _cycleTimeNs = cycleTimeNs; }
+    bool referenceClockTime(quint64 *timeNs) const;
+
+    const quint8 *processData(int domain) const { return _processData.at(domain); }
+    quint32 processDataSize(int domain) const { return _processDataSize.at(domain); }
+
+private:
+    uint _masterIndex;
+    quint16 _dcAssignActivate;
+    qint64 _cycleTimeNs;
+    ec_master_t *_master;
+    QVector<ec_domain_t *> _domains;
+    /**
+     * @brief Slave configurations created so far, by ring position
+     */
+    QMap<quint16, ec_slave_config_t *> _slaveConfigs;
+    QVector<quint8 *> _processData;
+    QVector<quint32> _processDataSize;
+    /**
+     * @brief Reference clock time read by the last receive(), extended from the 32 bits on the wire
+     */
+    quint64 _dcTimeNs;
+    bool _dcTimeValid;
+};
+
+#endif // CECATMASTERBACKEND_H
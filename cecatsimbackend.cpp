@@ -0,0 +1,220 @@
+#include "cecatsimbackend.h"
+#include <qmath.h>
+
+CEcatSimBackend::CEcatSimBackend(quint32 seed) :
+    _cycleTimeNs(1000000),
+    _cycle(0),
+    _timeNs(0),
+    _dcTimeNs(0),
+    _seed(seed ? seed : 1),
+    _random(_seed),
+    _open(false)
+{
+}
+
+quint16 CEcatSimBackend::addSlave(quint32 vendorId, quint32 productCode)
+{
+    Slave slave;
+    slave.vendorId = vendorId;
+    slave.productCode = productCode;
+    _slaves.append(slave);
+    return quint16(_slaves.size() - 1);
+}
+
+void CEcatSimBackend::addSignal(quint16 position, const Signal &signal)
+{
+    if (position < _slaves.size())
+        _slaves[position].signalList.append(signal);
+}
+
+void CEcatSimBackend::addDemoLine(int slaveCount)
+{
+    for (int i = 0; i < slaveCount; ++i) {
+        quint16 position = addSlave(0x000022d2, 0x00000201);
+        const double f = 0.5 + 0.25 * i;
+        // position, velocity and torque actual values plus a status word, like a CiA 402 drive
+        Signal actualPosition = { 0x6064, 0, CPdoField::UInt32, Encoder, 4096.0 * (i + 1), 0.0, 0.0, 0 };
+        Signal velocity = { 0x606c, 0, CPdoField::Int32, Sine, 3000.0, f, 0.0, 0 };
+        Signal torque = { 0x6077, 0, CPdoField::Int16, Noise, 50.0, 0.0, 100.0 * i, 0 };
+        Signal ramp = { 0x2401, 1, CPdoField::Int16, Ramp, 1000.0, f, -500.0, 1 };
+        Signal status = { 0x6041, 0, CPdoField::UInt16, Step, 0x0400, 0.1 * (i + 1), 0x0237, 0 };
+        addSignal(position, actualPosition);
+        addSignal(position, velocity);
+        addSignal(position, torque);
+        addSignal(position, ramp);
+        addSignal(position, status);
+    }
+}
+
+QVector<CPdoField> CEcatSimBackend::mapping() const
+{
+    QVector<CPdoField> result;
+    for (int pos = 0; pos < _slaves.size(); ++pos) {
+        const Slave &slave = _slaves.at(pos);
+        for (int i = 0; i < slave.signalList.size(); ++i) {
+            const Signal &signal = slave.signalList.at(i);
+            CPdoField field;
+            field.name = QString("%1.%2:%3").arg(pos).arg(signal.index, 4, 16, QChar('0')).arg(signal.subindex);
+            field.entry.position = quint16(pos);
+            field.entry.vendorId = slave.vendorId;
+            field.entry.productCode = slave.productCode;
+            field.entry.index = signal.index;
+            field.entry.subindex = signal.subindex;
+            field.type = signal.type;
+            field.bitOffset = 0;
+            field.scale = 1.0;
+            field.offset = 0.0;
+            field.domain = signal.domain;
+            result.append(field);
+
+            if (signal.index == 0x6041) {
+                field.name += ".10";
+                field.type = CPdoField::Bit;
+                field.bitOffset = 10;
+                result.append(field);
+            }
+        }
+    }
+    return result;
+}
+
+bool CEcatSimBackend::open()
+{
+    for (int pos = 0; pos < _slaves.size(); ++pos) {
+        Slave &slave = _slaves[pos];
+        slave.domains.fill(-1, slave.signalList.size());
+        slave.offsets.fill(-1, slave.signalList.size());
+    }
+    _images.clear();
+    _images.append(QVector<quint8>());
+    _cycle = 0;
+    _timeNs = 0;
+    _dcTimeNs = 0;
+    _random = _seed;
+    _open = true;
+    return true;
+}
+
+int CEcatSimBackend::createDomain()
+{
+    if (!_open) {
+        setErrorString("Simulator is not open");
+        return -1;
+    }
+    if (_images.size() >= MAX_DOMAINS) {
+        setErrorString(QString("At most %1 process data domains are supported").arg(int(MAX_DOMAINS)));
+        return -1;
+    }
+    _images.append(QVector<quint8>());
+    return _images.size() - 1;
+}
+
+int CEcatSimBackend::registerEntry(const CEcatEntry &entry, int domain, uint *bitPosition)
+{
+    if (!_open) {
+        setErrorString("Simulator is not open");
+        return -1;
+    }
+    if (domain < 0 || domain >= _images.size()) {
+        setErrorString(QString("Process data domain %1 does not exist").arg(domain));
+        return -1;
+    }
+    if (entry.position < _slaves.size()) {
+        Slave &slave = _slaves[entry.position];
+        for (int i = 0; i < slave.signalList.size(); ++i) {
+            if (slave.signalList.at(i).index != entry.index || slave.signalList.at(i).subindex != entry.subindex)
+                continue;
+            // Append the entry to its domain image on first registration, byte aligned
+            if (slave.offsets.at(i) < 0) {
+                slave.domains[i] = domain;
+                slave.offsets[i] = _images.at(domain).size();
+                _images[domain].resize(_images.at(domain).size() + (CPdoField::bitLength(slave.signalList.at(i).type) + 7) / 8);
+            } else if (slave.domains.at(i) != domain) {
+                setErrorString(QString("PDO entry 0x%1:%2 of slave %3 is already mapped into domain %4")
+                               .arg(entry.index, 4, 16, QChar('0')).arg(entry.subindex).arg(entry.position).arg(slave.domains.at(i)));
+                return -1;
+            }
+            if (bitPosition)
+                *bitPosition = 0;
+            return slave.offsets.at(i);
+        }
+    }
+    setErrorString(QString("No simulated PDO entry 0x%1:%2 on slave %3")
+                   .arg(entry.index, 4, 16, QChar('0')).arg(entry.subindex).arg(entry.position));
+    return -1;
+}
+
+bool CEcatSimBackend::activate()
+{
+    if (!_open) {
+        setErrorString("Simulator is not open");
+        return false;
+    }
+    return true;
+}
+
+void CEcatSimBackend::receive(quint32 domains)
+{
+    const double t = double(_timeNs) * 1e-9;
+    _dcTimeNs = quint64(qRound64((double(_timeNs) + DC_FRAME_DELAY_NS) * (1.0 + DC_DRIFT_PPB * 1e-9)));
+
+    for (int pos = 0; pos < _slaves.size(); ++pos) {
+        const Slave &slave = _slaves.at(pos);
+        for (int i = 0; i < slave.signalList.size(); ++i) {
+            const int domain = slave.domains.at(i);
+            if (domain < 0 || !(domains & (1u << domain)))
+                continue;
+            const Signal &signal = slave.signalList.at(i);
+            const quint32 raw = quint32(qint64(qFloor(sample(signal, t) + 0.5)));
+            quint8 *dst = _images[domain].data() + slave.offsets.at(i);
+            for (int b = 0; b < CPdoField::bitLength(signal.type) / 8 && b < 4; ++b)
+                dst[b] = quint8(raw >> (8 * b));
+        }
+    }
+    ++_cycle;
+    _timeNs += _cycleTimeNs;
+}
+
+void CEcatSimBackend::close()
+{
+    _images.clear();
+    _open = false;
+}
+
+bool CEcatSimBackend::referenceClockTime(quint64 *timeNs) const
+{
+    if (_open && _cycle > 0)
+        *timeNs = _dcTimeNs;
+    return _open && _cycle > 0;
+}
+
+double CEcatSimBackend::sample(const Signal &signal, double t)
+{
+    switch (signal.waveform) {
+    case Sine:
+        return signal.amplitude * qSin(2.0 * M_PI * signal.frequency * t) + signal.offset;
+    case Ramp: {
+        const double phase = signal.frequency * t;
+        return signal.offset + signal.amplitude * (phase - qFloor(phase));
+    }
+    case Noise:
+        return signal.offset + signal.amplitude * (2.0 * (nextRandom() / 4294967295.0) - 1.0);
+    case Step: {
+        const double phase = signal.frequency * t;
+        return signal.offset + ((phase - qFloor(phase)) < 0.5 ? 0.0 : signal.amplitude);
+    }
+    case Encoder:
+        // wrap explicitly so the counter behaves like a 32 bit encoder register
+        return double(quint32(quint64(signal.amplitude * t)));
+    }
+    return signal.offset;
+}
+
+quint32 CEcatSimBackend::nextRandom()
+{
+    // xorshift32, cheap and reproducible
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
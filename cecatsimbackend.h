@@ -0,0 +1,140 @@
+#ifndef CECATSIMBACKEND_H
+#define CECATSIMBACKEND_H
+
+#include <QVector>
+#include "cecatbackend.h"
+#include "cpdodecoder.h"
+
+/**
+ * @brief Deterministic stand-in for an EtherCAT bus
+ *
+ * Every receive() advances the simulated time by one cycle and writes the
+ * registered signals of the selected domains into their process images, as
+ * little-endian signed integers. Each domain image holds its entries back to
+ * back in registration order. Output only depends on the configuration, the cycle time
+ * and the seed, so runs are reproducible without hardware.
+ *
+ * A simulated DC reference clock starts at 0 with open() and runs
+ * #DC_DRIFT_PPB fast against the simulated time, the frames pass it
+ * #DC_FRAME_DELAY_NS after the start of their cycle.
+ */
+class CEcatSimBackend : public CEcatBackend
+{
+public:
+    enum Waveform {
+        Sine,       ///< amplitude * sin(2 pi f t) + offset
+        Ramp,       ///< sawtooth from offset to offset + amplitude at frequency f
+        Noise,      ///< uniform noise in [offset - amplitude, offset + amplitude]
+        Step,       ///< square wave between offset and offset + amplitude at frequency f
+        Encoder     ///< wrapping counter advancing amplitude counts per second
+    };
+
+    /**
+     * @brief One simulated PDO entry
+     */
+    struct Signal
+    {
+        quint16 index;
+        quint8 subindex;
+        /**
+         * @brief Encoding in the image, integer types only
+         */
+        CPdoField::Type type;
+        Waveform waveform;
+        double amplitude;
+        double frequency;
+        double offset;
+        /**
+         * @brief Domain mapping() puts the entry in, 0 unless it is a slow channel
+         */
+        int domain;
+    };
+
+    enum {
+        /**
+         * @brief Drift of the simulated reference clock, in parts per billion
+         */
+        DC_DRIFT_PPB = 30000,
+        DC_FRAME_DELAY_NS = 20000
+    };
+
+    explicit CEcatSimBackend(quint32 seed = 1);
+
+    /**
+     * @brief Appends a slave to the simulated ring
+     * @return ring position of the new slave
+     */
+    quint16 addSlave(quint32 vendorId, quint32 productCode);
+    /**
+     * @brief Adds @a signal to the slave at @a position
+     */
+    void addSignal(quint16 position, const Signal &signal);
+    /**
+     * @brief Populates @a slaveCount drive-like slaves with a mix of all waveforms
+     *
+     * The drive signals go to domain 0, the analog input of each slave to the
+     * slower domain 1, like an I/O terminal next to a drive.
+     */
+    void addDemoLine(int slaveCount);
+    /**
+     * @brief One unscaled field per configured signal, in image order
+     *
+     * Status words (index 0x6041) additionally get a bit field for bit 10,
+     * "target reached".
+     */
+    QVector<CPdoField> mapping() const;
+    /**
+     * @brief Sets the simulated time step of the following receive() calls, in nanoseconds
+     */
+    void setCycleTime(qint64 cycleTimeNs) { _cycleTimeNs = cycleTimeNs; }
+
+    bool open();
+    int createDomain();
+    int domainCount() const { return _images.size(); }
+    int registerEntry(const CEcatEntry &entry, int domain, uint *bitPosition);
+    bool activate();
+    void receive(quint32 domains);
+    void send(quint32 domains) { Q_UNUSED(domains); }
+    void close();
+    bool referenceClockTime(quint64 *timeNs) const;
+
+    const quint8 *processData(int domain) const { return _images.at(domain).constData(); }
+    quint32 processDataSize(int domain) const { return quint32(_images.at(domain).size()); }
+
+private:
+    struct Slave
+    {
+        quint32 vendorId;
+        quint32 productCode;
+        QVector<Signal> signalList;
+        /**
+         * @brief Domain and byte offset in its image of each signal, -1 until registered
+         */
+        QVector<int> domains;
+        QVector<int> offsets;
+    };
+
+    QVector<Slave> _slaves;
+    /**
+     * @brief Process image of each domain
+     */
+    QVector<QVector<quint8> > _images;
+    qint64 _cycleTimeNs;
+    quint64 _cycle;
+    /**
+     * @brief Simulated time of the next receive(), the sum of the cycle times so far
+     */
+    qint64 _timeNs;
+    /**
+     * @brief Reference clock time of the frame of the last receive()
+     */
+    quint64 _dcTimeNs;
+    quint32 _seed;
+    quint32 _random;
+    bool _open;
+
+    double sample(const Signal &signal, double t);
+    quint32 nextRandom();
+};
+
+#endif // CECATSIMBACKEND_H
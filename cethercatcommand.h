@@ -0,0 +1,41 @@
+#ifndef CETHERCATCOMMAND_H
+#define CETHERCATCOMMAND_H
+
+#include <QtGlobal>
+
+class CTrigger;
+
+/**
+ * @brief Runtime change of the acquisition, applied by the cycle loop of CEthercatThread
+ *
+ * Plain data, copied through the command ring of CEthercatThread. Commands
+ * take effect in the order they were posted, at the start of the first cycle
+ * after their arrival, without stopping the bus.
+ */
+struct CEthercatCommand
+{
+    enum Type {
+        SetCycleTime,       ///< #value is the new period in nanoseconds
+        SetChannelEnabled,  ///< decodes and publishes #channel while #value is not 0
+        ArmTrigger,         ///< #trigger replaces the current trigger, 0 disarms
+        SetRecording        ///< copies the cycles into the record ring while #value is not 0
+    };
+
+    Type type;
+    int channel;
+    qint64 value;
+    /**
+     * @brief Trigger handed over by #ArmTrigger, owned by the command until it is applied
+     */
+    CTrigger *trigger;
+
+    explicit CEthercatCommand(Type type = SetCycleTime, qint64 value = 0, int channel = -1, CTrigger *trigger = 0) :
+        type(type),
+        channel(channel),
+        value(value),
+        trigger(trigger)
+    {
+    }
+};
+
+#endif // CETHERCATCOMMAND_H
@@ -1,70 +1,307 @@
 #include "cethercatthread.h"
-#include <QTimer>
-#include <QEventLoop>
 
 #include <QThread>
 #include <QDebug>
+#include <string.h>
 
 CEthercatThread::CEthercatThread(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    _abort(false),
+    _working(false),
+    _cycleTimeNs(1000000),
+    _commands(64),
+    _commandDeferred(false),
+    _backend(0),
+    _enabledChannels(~0u),
+    _samples(16384),
+    _droppedSamples(0),
+    _records(65536),
+    _recording(false),
+    _droppedRecords(0),
+    _triggerResults(8),
+    _trigger(0),
+    _missedDeadlines(0),
+    _dcMappings(4)
 {
-    _working =false;
-    _abort = false;
+}
+
+CEthercatThread::~CEthercatThread()
+{
+    delete _backend;
+    // The worker has stopped, so both ends of the rings belong to this thread now
+    CEthercatCommand command;
+    while (_commands.pop(command)) {
+        if (command.type == CEthercatCommand::ArmTrigger)
+            delete command.trigger;
+    }
+    if (_commandDeferred && _deferredCommand.type == CEthercatCommand::ArmTrigger)
+        delete _deferredCommand.trigger;
+    CTrigger *trigger;
+    while (_triggerResults.pop(trigger))
+        delete trigger;
+    delete _trigger;
 }
 
 void CEthercatThread::requestWork()
 {
-    mutex.lock();
-    _working = true;
-    _abort = false;
+    _abort.store(false, std::memory_order_relaxed);
+    _working.store(true, std::memory_order_release);
     qDebug()<<"Request worker start in Thread "<<thread()->currentThreadId();
-    mutex.unlock();
 
     emit workRequested();
 }
 
 void CEthercatThread::abort()
 {
-    mutex.lock();
-    if (_working) {
-        _abort = true;
+    if (_working.load(std::memory_order_acquire)) {
+        _abort.store(true, std::memory_order_release);
         qDebug()<<"Request worker aborting in Thread "<<thread()->currentThreadId();
     }
-    mutex.unlock();
+}
+
+bool CEthercatThread::setCycleTime(qint64 cycleTimeNs)
+{
+    cycleTimeNs = qMax(cycleTimeNs, CCyclicTimer::MIN_CYCLE_TIME_NS);
+    // A request that did not fit into the queue leaves the cycle time as it was, so it can be retried
+    if (!post(CEthercatCommand(CEthercatCommand::SetCycleTime, cycleTimeNs)))
+        return false;
+    _cycleTimeNs.store(cycleTimeNs, std::memory_order_relaxed);
+    return true;
+}
+
+bool CEthercatThread::setChannelEnabled(int channel, bool enabled)
+{
+    if (channel < 0 || channel >= CSampleRecord::MAX_CHANNELS)
+        return false;
+    return post(CEthercatCommand(CEthercatCommand::SetChannelEnabled, enabled, channel));
+}
+
+void CEthercatThread::setFreeRunning(bool enabled)
+{
+    _timer.setFreeRunning(enabled);
+}
+
+void CEthercatThread::setBackend(CEcatBackend *backend)
+{
+    delete _backend;
+    _backend = backend;
+}
+
+void CEthercatThread::setMapping(const QVector<CPdoField> &mapping)
+{
+    _mapping = mapping.mid(0, CSampleRecord::MAX_CHANNELS);
+}
+
+void CEthercatThread::setDomainDivisors(const QVector<int> &divisors)
+{
+    _divisors = divisors.mid(0, CEcatBackend::MAX_DOMAINS);
+}
+
+int CEthercatThread::domainDivisor(int domain) const
+{
+    return qMax(_divisors.value(domain, 1), 1);
+}
+
+int CEthercatThread::channelDomain(int channel) const
+{
+    return channel >= 0 && channel < _mapping.size() ? _mapping.at(channel).domain : 0;
+}
+
+bool CEthercatThread::startBus()
+{
+    if (!_backend) {
+        emit error("No EtherCAT backend configured");
+        return false;
+    }
+    if (_mapping.isEmpty()) {
+        emit error("No PDO mapping configured, pass a mapping file with --mapping");
+        return false;
+    }
+    if (!_backend->open()) {
+        emit error(_backend->errorString());
+        return false;
+    }
+    _backend->setCycleTime(_timer.cycleTime());
+
+    if (!_decoder.compile(_mapping, _backend)) {
+        emit error(_decoder.errorString());
+        _backend->close();
+        return false;
+    }
+
+    if (!_backend->activate()) {
+        emit error(_backend->errorString());
+        _backend->close();
+        return false;
+    }
+
+    if (!_decoder.validate(_backend)) {
+        emit error(_decoder.errorString());
+        _backend->close();
+        return false;
+    }
+
+    // Channels switched off in an earlier run stay off
+    const quint32 enabled = _enabledChannels.load(std::memory_order_relaxed);
+    for (int channel = 0; channel < _decoder.channelCount(); ++channel)
+        _decoder.setChannelEnabled(channel, channel >= CSampleRecord::MAX_CHANNELS || (enabled & (1u << channel)));
+    return true;
+}
+
+void CEthercatThread::applyCommands()
+{
+    if (_commandDeferred) {
+        if (!applyCommand(_deferredCommand))
+            return;
+        _commandDeferred = false;
+    }
+
+    // Keep the order: a command that has to wait holds back the ones posted after it
+    CEthercatCommand command;
+    while (_commands.pop(command)) {
+        if (!applyCommand(command)) {
+            _deferredCommand = command;
+            _commandDeferred = true;
+            return;
+        }
+    }
+}
+
+bool CEthercatThread::applyCommand(const CEthercatCommand &command)
+{
+    switch (command.type) {
+    case CEthercatCommand::SetCycleTime:
+        // The deadline of the next cycle is the first one on the new period
+        _timer.setCycleTime(command.value);
+        _backend->setCycleTime(_timer.cycleTime());
+        break;
+    case CEthercatCommand::SetChannelEnabled: {
+        const quint32 bit = 1u << command.channel;
+        const quint32 enabled = _enabledChannels.load(std::memory_order_relaxed);
+        _enabledChannels.store(command.value ? enabled | bit : enabled & ~bit, std::memory_order_relaxed);
+        _decoder.setChannelEnabled(command.channel, command.value != 0);
+        break;
+    }
+    case CEthercatCommand::ArmTrigger:
+        // The replaced trigger is handed back to its owner, it waits until there is room for it
+        if (_trigger && !_triggerResults.push(_trigger))
+            return false;
+        _trigger = command.trigger;
+        break;
+    case CEthercatCommand::SetRecording:
+        _recording.store(command.value != 0, std::memory_order_release);
+        break;
+    }
+    return true;
+}
+
+void CEthercatThread::updateTrigger(const CSampleRecord &record)
+{
+    if (!_trigger)
+        return;
+
+    if (_trigger->state() != CTrigger::Done)
+        _trigger->process(record);
+    // If the GUI has not collected the earlier results yet, the next cycle tries again
+    if (_trigger->state() == CTrigger::Done && _triggerResults.push(_trigger))
+        _trigger = 0;
 }
 
 void CEthercatThread::doWork()
 {
     qDebug()<<"Starting worker process in Thread "<<thread()->currentThreadId();
 
-    for (int i = 0; i < 60; i ++) {
+    _timer.setCycleTime(cycleTime());
+    const bool busStarted = startBus();
+    // Placed once the bus is up, so the locked memory includes the domain of the backend
+    if (busStarted) {
+        if (!_placement.apply())
+            emit error(_placement.errorString());
+        qDebug()<<"Worker placement:"<<_placement.toString();
+    }
+    _timer.start();
 
-        // Checks if the process should be aborted
-        mutex.lock();
-        bool abort = _abort;
-        mutex.unlock();
+    CSampleRecord record;
+    memset(&record, 0, sizeof(record));
+    record.channelCount = quint32(_decoder.channelCount());
+    // Divisors as a flat array, the due domains are worked out every cycle
+    const int domainCount = busStarted ? _backend->domainCount() : 0;
+    quint64 divisors[CEcatBackend::MAX_DOMAINS];
+    for (int domain = 0; domain < domainCount; ++domain)
+        divisors[domain] = quint64(domainDivisor(domain));
+    // The cycle counter restarts with the bus, a half captured window of the last run is discarded
+    if (_trigger && _trigger->state() != CTrigger::Done)
+        _trigger->rearm();
+    _wakeLatency.reset();
+    _executionTime.reset();
+    _missedDeadlines.store(0, std::memory_order_relaxed);
+    _dcMapping.reset();
+    // Host time of the last send, the frame the next receive reads back
+    qint64 sendNs = 0;
 
-        if (abort) {
+    while (busStarted) {
+
+        // Checks if the process should be aborted
+        if (_abort.load(std::memory_order_acquire)) {
             qDebug()<<"Aborting worker process in Thread "<<thread()->currentThreadId();
             break;
         }
 
-        // This will stupidly wait 1 sec doing nothing...
-        QEventLoop loop;
-        QTimer::singleShot(1000, &loop, SLOT(quit()));
-        loop.exec();
+        // Sleep until the absolute deadline of the next cycle
+        const quint32 skipped = _timer.waitNextCycle();
+        const qint64 wakeNs = CCyclicTimer::nowNs();
+        if (skipped > 0)
+            _missedDeadlines.fetch_add(skipped, std::memory_order_relaxed);
+        if (!_timer.freeRunning())
+            _wakeLatency.record(wakeNs - CCyclicTimer::toNs(_timer.deadline()));
+
+        // Changes posted since the last cycle take effect from this one on
+        applyCommands();
+        record.cycle = _timer.cycleCount();
+        record.timestampNs = CCyclicTimer::toNs(_timer.deadline());
+        record.cycleTimeNs = _timer.cycleTime();
+        record.channelMask = _enabledChannels.load(std::memory_order_relaxed);
+        quint32 due = 0;
+        for (int domain = 0; domain < domainCount; ++domain) {
+            if (record.cycle % divisors[domain] == 0)
+                due |= 1u << domain;
+        }
+        record.domainMask = due;
+
+        // Domains that are not due keep their last values in the record
+        _backend->receive(due);
+        record.dcTimeNs = 0;
+        if (_backend->referenceClockTime(&record.dcTimeNs) && sendNs != 0) {
+            // A few flops per cycle, if the GUI has not taken the last copies this one is skipped
+            _dcMapping.update(sendNs, qint64(record.dcTimeNs));
+            _dcMappings.push(_dcMapping);
+        }
+        for (int domain = 0; domain < domainCount; ++domain) {
+            if (due & (1u << domain))
+                _decoder.decode(domain, _backend->processData(domain), record.values);
+        }
+        sendNs = CCyclicTimer::nowNs();
+        _backend->send(due);
 
-        // Once we're done waiting, value is updated
-        emit valueChanged(QString::number(i));
+        // Hand the cycle over to the GUI without blocking, if it can't keep up the sample is dropped
+        record.publishNs = CCyclicTimer::nowNs();
+        if (!_samples.push(record))
+            _droppedSamples.fetch_add(1, std::memory_order_relaxed);
+        if (_recording.load(std::memory_order_relaxed) && !_records.push(record))
+            _droppedRecords.fetch_add(1, std::memory_order_relaxed);
+        // The trigger sees every cycle, also those the GUI is too slow to plot
+        updateTrigger(record);
+        _executionTime.record(CCyclicTimer::nowNs() - wakeNs);
     }
 
+    if (busStarted)
+        _backend->close();
+
     // Set _working to false, meaning the process can't be aborted anymore.
-    mutex.lock();
-    _working = false;
-    mutex.unlock();
+    _working.store(false, std::memory_order_release);
 
     qDebug()<<"Worker process finished in Thread "<<thread()->currentThreadId();
 
-    //Once 60 sec passed, the finished signal is sent
+    //Once aborted, the finished signal is sent
     emit finished();
 }
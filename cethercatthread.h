@@ -2,40 +2,280 @@
 #define CETHERCATTHREAD_H
 
 #include <QObject>
-#include <QMutex>
+#include <QVector>
+#include <atomic>
+#include "cclockmapping.h"
+#include "cecatbackend.h"
+#include "cethercatcommand.h"
+#include "ccyclictimer.h"
+#include "chdrhistogram.h"
+#include "cpdodecoder.h"
+#include "crtplacement.h"
+#include "csamplerecord.h"
+#include "cspscring.h"
+#include "ctrigger.h"
 
+/**
+ * @brief Worker running the cyclic EtherCAT acquisition
+ *
+ * Nothing the cycle loop reads is guarded by a lock. Flags are atomics, and
+ * changes that have to happen between two cycles (cycle time, channels,
+ * trigger, recording) are posted as CEthercatCommand through a wait-free
+ * SPSC ring. The loop applies them at the start of the next cycle, so the
+ * bus keeps running while the acquisition is reconfigured. All posting
+ * methods are meant to be called from one thread, the GUI thread.
+ */
 class CEthercatThread : public QObject
 {
     Q_OBJECT
 
 public:
     explicit CEthercatThread(QObject *parent = 0);
+    ~CEthercatThread();
     /**
      * @brief Requests the process to start
-     *
-     * It is thread safe as it uses #mutex to protect access to #_working variable.
      */
     void requestWork();
     /**
-     * @brief Requests the process to abort
-     *
-     * It is thread safe as it uses #mutex to protect access to #_abort variable.
+     * @brief Requests the process to abort, the loop stops before its next cycle
      */
     void abort();
+    /**
+     * @brief Queues @p command for the cycle loop
+     *
+     * Commands posted while the worker is not running are applied before the
+     * first cycle of the next run. Returns @em false if the queue is full.
+     */
+    bool post(const CEthercatCommand &command) { return _commands.push(command); }
+    /**
+     * @brief Sets the bus cycle time in nanoseconds
+     *
+     * Clamped to CCyclicTimer::MIN_CYCLE_TIME_NS. A running loop switches at
+     * the next cycle, the bus is not restarted.
+     */
+    bool setCycleTime(qint64 cycleTimeNs);
+    qint64 cycleTime() const { return _cycleTimeNs.load(std::memory_order_relaxed); }
+    /**
+     * @brief Runs the cycle loop without sleeping, on simulated time
+     *
+     * See CCyclicTimer::setFreeRunning(). Only call while the worker is not running.
+     */
+    void setFreeRunning(bool enabled);
+    /**
+     * @brief Sets the master the worker talks to, taking ownership of @a backend
+     *
+     * Only call while the worker is not running.
+     */
+    void setBackend(CEcatBackend *backend);
+    /**
+     * @brief Sets the PDO mapping decoded every cycle, one channel per field
+     *
+     * At most CSampleRecord::MAX_CHANNELS are used. The mapping is compiled
+     * into #_decoder when the bus starts. Only call while the worker is not running.
+     */
+    void setMapping(const QVector<CPdoField> &mapping);
+    /**
+     * @brief Exchanges domain i only every @p divisors[i]-th cycle
+     *
+     * A domain is due in the cycles whose counter is a multiple of its
+     * divisor, domains without a divisor are exchanged every cycle. Only call
+     * while the worker is not running.
+     */
+    void setDomainDivisors(const QVector<int> &divisors);
+    /**
+     * @brief Cycle divisor of @p domain, 1 if none was set
+     */
+    int domainDivisor(int domain) const;
+    /**
+     * @brief Domain the field of @p channel is mapped into
+     */
+    int channelDomain(int channel) const;
+    /**
+     * @brief Fields set with setMapping(), one per channel
+     */
+    const QVector<CPdoField> &mapping() const { return _mapping; }
+    /**
+     * @brief Starts or stops decoding and publishing @p channel
+     *
+     * Only the channels of the mapping can be switched, adding fields to it
+     * needs a restart of the bus. Disabled channels keep their last value in
+     * the records and are left out of CSampleRecord::channelMask.
+     */
+    bool setChannelEnabled(int channel, bool enabled);
+    /**
+     * @brief Channels the loop currently decodes, bit i for channel i
+     */
+    quint32 enabledChannels() const { return _enabledChannels.load(std::memory_order_relaxed); }
+    /**
+     * @brief Sets the CPU, scheduling and memory placement of the worker thread
+     *
+     * Applied in doWork() once the bus is up, before the first cycle. A placement
+     * that cannot be applied is reported through error() and the bus runs
+     * without it. Only call while the worker is not running.
+     */
+    void setRtPlacement(const CRtPlacement &placement) { _placement = placement; }
+    const CRtPlacement &rtPlacement() const { return _placement; }
+    /**
+     * @brief Ring the worker writes one CSampleRecord per cycle into
+     *
+     * The GUI thread is the single consumer and drains it with
+     * CSpscRing::popBulk().
+     */
+    CSpscRing<CSampleRecord> *sampleRing() { return &_samples; }
+    /**
+     * @brief Number of records dropped because #_samples was full
+     */
+    quint64 droppedSamples() const { return _droppedSamples.load(std::memory_order_relaxed); }
+    /**
+     * @brief Starts or stops copying every cycle into recordRing()
+     *
+     * Takes effect with the next cycle.
+     */
+    bool setRecording(bool enabled) { return post(CEthercatCommand(CEthercatCommand::SetRecording, enabled)); }
+    bool isRecording() const { return _recording.load(std::memory_order_acquire); }
+    /**
+     * @brief Ring the worker writes one CSampleRecord per cycle into while recording
+     *
+     * Drained by a CCaptureRecorder on a thread of its own, so disk stalls
+     * never delay the cycle loop.
+     */
+    CSpscRing<CSampleRecord> *recordRing() { return &_records; }
+    /**
+     * @brief Number of records not recorded because #_records was full
+     */
+    quint64 droppedRecords() const { return _droppedRecords.load(std::memory_order_relaxed); }
+    /**
+     * @brief Hands @p trigger to the cycle loop, which evaluates it on every cycle from then on
+     *
+     * Takes ownership unless it returns @em false because the command queue
+     * is full. The trigger replaces the current one, 0 disarms. Replaced and
+     * completed triggers come back through triggerResults().
+     */
+    bool armTrigger(CTrigger *trigger) { return post(CEthercatCommand(CEthercatCommand::ArmTrigger, 0, -1, trigger)); }
+    /**
+     * @brief Ring handing back triggers that completed their window or were replaced
+     *
+     * Ownership goes to the consumer, a trigger in state CTrigger::Done holds
+     * its captured window. It can be rearmed and passed to armTrigger() again.
+     */
+    CSpscRing<CTrigger *> *triggerResults() { return &_triggerResults; }
+    /**
+     * @brief Delay from the cycle deadline to the wake-up of the worker, in nanoseconds
+     *
+     * Not recorded while free running, the deadlines are simulated then.
+     * Like executionTime() and missedDeadlines() it restarts with each run
+     * and can be read from any thread while the worker updates it.
+     */
+    const CHdrHistogram &wakeLatency() const { return _wakeLatency; }
+    /**
+     * @brief Time from the wake-up to the end of the cycle body, in nanoseconds
+     */
+    const CHdrHistogram &executionTime() const { return _executionTime; }
+    /**
+     * @brief Periods skipped because the worker woke up more than a period late
+     */
+    quint64 missedDeadlines() const { return _missedDeadlines.load(std::memory_order_relaxed); }
+    /**
+     * @brief Ring carrying copies of the mapping from CLOCK_MONOTONIC to distributed-clock time
+     *
+     * The worker pairs the host time each frame was sent with its DC time and
+     * offers the updated CClockMapping every cycle, while the ring has room.
+     * The consumer keeps the last one it pops, it is the only mapping between
+     * the two clocks. Stays empty if the bus has no DC reference clock.
+     */
+    CSpscRing<CClockMapping> *dcMappings() { return &_dcMappings; }
 
 private:
     /**
      * @brief Process is aborted when @em true
      */
-    bool _abort;
+    std::atomic<bool> _abort;
     /**
      * @brief @em true when Worker is doing work
      */
-    bool _working;
+    std::atomic<bool> _working;
+    /**
+     * @brief Cycle period last requested, in nanoseconds
+     */
+    std::atomic<qint64> _cycleTimeNs;
+    /**
+     * @brief Changes for the cycle loop, in the order they were posted
+     */
+    CSpscRing<CEthercatCommand> _commands;
+    /**
+     * @brief Command popped from #_commands that could not be applied yet, it blocks the ones behind it
+     */
+    CEthercatCommand _deferredCommand;
+    bool _commandDeferred;
+    /**
+     * @brief Paces the cycle loop, only touched by the worker thread
+     */
+    CCyclicTimer _timer;
+    /**
+     * @brief Placement the worker thread applies to itself in doWork()
+     */
+    CRtPlacement _placement;
+    /**
+     * @brief Process-data access, owned
+     */
+    CEcatBackend *_backend;
+    /**
+     * @brief Fields decoded each cycle
+     */
+    QVector<CPdoField> _mapping;
+    /**
+     * @brief #_mapping compiled against the current domains
+     */
+    CPdoDecoder _decoder;
+    QVector<int> _divisors;
+    /**
+     * @brief Channels decoded by the loop, written by the worker thread only
+     */
+    std::atomic<quint32> _enabledChannels;
+    /**
+     * @brief Hand-off of cycle samples to the GUI thread
+     */
+    CSpscRing<CSampleRecord> _samples;
+    std::atomic<quint64> _droppedSamples;
+    /**
+     * @brief Hand-off of cycle samples to the recorder, sized for seconds of disk stalls
+     */
+    CSpscRing<CSampleRecord> _records;
+    /**
+     * @brief Copy the cycles into #_records, written by the worker thread only
+     */
+    std::atomic<bool> _recording;
+    std::atomic<quint64> _droppedRecords;
+    CSpscRing<CTrigger *> _triggerResults;
+    /**
+     * @brief Trigger evaluated every cycle, only touched by the worker thread
+     */
+    CTrigger *_trigger;
+    CHdrHistogram _wakeLatency;
+    CHdrHistogram _executionTime;
+    std::atomic<quint64> _missedDeadlines;
+    /**
+     * @brief Fit of the host time the frames were sent to their DC time, only touched by the worker thread
+     */
+    CClockMapping _dcMapping;
+    CSpscRing<CClockMapping> _dcMappings;
+
+    /**
+     * @brief Opens the backend, compiles #_mapping and activates the domain
+     */
+    bool startBus();
+    /**
+     * @brief Applies the commands posted since the last cycle, called at the start of every cycle
+     */
+    void applyCommands();
+    /**
+     * @brief Applies @p command, @em false if it has to wait for a later cycle
+     */
+    bool applyCommand(const CEthercatCommand &command);
     /**
-     * @brief Protects access to #_abort
+     * @brief Evaluates the trigger on @p record and hands it back once complete, called every cycle
      */
-    QMutex mutex;
+    void updateTrigger(const CSampleRecord &record);
 
 signals:
     /**
@@ -44,20 +284,21 @@ signals:
      */
     void workRequested();
     /**
-     * @brief This signal is emitted when counted value is changed (every sec)
+     * @brief This signal is emitted when the bus could not be started
      */
-    void valueChanged(const QString &value);
+    void error(const QString &message);
     /**
-     * @brief This signal is emitted when process is finished (either by counting 60 sec or being aborted)
+     * @brief This signal is emitted when process is finished (after being aborted)
      */
     void finished();
 
 public slots:
     /**
-     * @brief Does something
+     * @brief Runs the cyclic acquisition loop
      *
-     * Counts 60 sec in this example.
-     * Counting is interrupted if #_aborted is set to true.
+     * Each cycle waits for the next absolute deadline of #_timer, applies the
+     * posted commands and then processes the bus. The loop runs until #_abort
+     * is set to true.
      */
     void doWork();
 };
@@ -0,0 +1,104 @@
+#include "chdrhistogram.h"
+#include <limits>
+
+CHdrHistogram::CHdrHistogram()
+{
+    reset();
+}
+
+void CHdrHistogram::record(qint64 value)
+{
+    if (value < 0)
+        value = 0;
+
+    // Single writer, so plain load and store instead of read-modify-write instructions
+    std::atomic<quint64> &bucket = _buckets[bucketIndex(quint64(value))];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _count.store(_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _sum.store(_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    if (value < _minimum.load(std::memory_order_relaxed))
+        _minimum.store(value, std::memory_order_relaxed);
+    if (value > _maximum.load(std::memory_order_relaxed))
+        _maximum.store(value, std::memory_order_relaxed);
+}
+
+void CHdrHistogram::reset()
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+        _buckets[i].store(0, std::memory_order_relaxed);
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _minimum.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    _maximum.store(0, std::memory_order_relaxed);
+}
+
+qint64 CHdrHistogram::minimum() const
+{
+    return count() > 0 ? _minimum.load(std::memory_order_relaxed) : 0;
+}
+
+double CHdrHistogram::mean() const
+{
+    const quint64 values = count();
+    return values > 0 ? double(_sum.load(std::memory_order_relaxed)) / values : 0;
+}
+
+qint64 CHdrHistogram::percentile(double fraction) const
+{
+    const quint64 values = count();
+    if (values == 0)
+        return 0;
+
+    const quint64 rank = qMax(quint64(1), quint64(qBound(0.0, fraction, 1.0) * values + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += bucket(i);
+        if (seen >= rank)
+            return qMin(bucketLower(i) + bucketWidth(i) - 1, maximum());
+    }
+    return maximum();
+}
+
+qint64 CHdrHistogram::bucketLower(int index)
+{
+    if (index < 2 * SUB_BUCKETS)
+        return index;
+    const int shift = (index - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+    const qint64 top = (index - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return top << shift;
+}
+
+qint64 CHdrHistogram::bucketWidth(int index)
+{
+    if (index < 2 * SUB_BUCKETS)
+        return 1;
+    return qint64(1) << ((index - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1);
+}
+
+QVector<double> CHdrHistogram::histogram(qint64 binWidth, int binCount) const
+{
+    QVector<double> bins(qMax(0, binCount), 0);
+    if (binCount <= 0 || binWidth <= 0)
+        return bins;
+
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        const quint64 counts = bucket(i);
+        if (counts == 0)
+            continue;
+        const qint64 bin = qMin(bucketLower(i) / binWidth, qint64(binCount - 1));
+        bins[int(bin)] += counts;
+    }
+    return bins;
+}
+
+int CHdrHistogram::bucketIndex(quint64 value)
+{
+    if (value < 2 * SUB_BUCKETS)
+        return int(value);
+    // The highest bit selects the power of two, the next SUB_BUCKET_BITS bits the linear bucket in it
+    const int msb = 63 - __builtin_clzll(value);
+    if (msb >= MAX_VALUE_BITS)
+        return BUCKET_COUNT - 1;
+    const int shift = msb - SUB_BUCKET_BITS;
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + int(value >> shift) - SUB_BUCKETS;
+}
@@ -0,0 +1,87 @@
+#ifndef CHDRHISTOGRAM_H
+#define CHDRHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief Log-linear histogram of durations, written by one thread and read by any
+ *
+ * Like an HDR histogram, every power of two is split into #SUB_BUCKETS
+ * linear buckets, so each value is kept with a relative error below
+ * 1/#SUB_BUCKETS (about 6 %) from nanoseconds up to minutes in a fixed
+ * array. record() is a few integer operations and relaxed stores without
+ * allocation or locking, cheap enough for every cycle of the acquisition
+ * loop.
+ *
+ * Only one thread may call record() and reset(). Other threads read the
+ * counters while they change, so a snapshot may be off by the values recorded
+ * while it was taken.
+ */
+class CHdrHistogram
+{
+public:
+    enum {
+        /**
+         * @brief Linear buckets per power of two, as a power of two
+         */
+        SUB_BUCKET_BITS = 4,
+        SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+        /**
+         * @brief Values of this many bits or more land in the last bucket (about 18 minutes in ns)
+         */
+        MAX_VALUE_BITS = 40,
+        BUCKET_COUNT = 2 * SUB_BUCKETS + (MAX_VALUE_BITS - SUB_BUCKET_BITS - 1) * SUB_BUCKETS
+    };
+
+    CHdrHistogram();
+
+    /**
+     * @brief Counts @p value, negative values count as 0, writer only
+     */
+    void record(qint64 value);
+    /**
+     * @brief Drops all counts, writer only
+     */
+    void reset();
+
+    quint64 count() const { return _count.load(std::memory_order_relaxed); }
+    qint64 minimum() const;
+    qint64 maximum() const { return _maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+    /**
+     * @brief Upper bound of the bucket below which @p fraction (0 to 1) of the values lie
+     *
+     * Returns 0 if nothing was recorded yet.
+     */
+    qint64 percentile(double fraction) const;
+
+    quint64 bucket(int index) const { return _buckets[index].load(std::memory_order_relaxed); }
+    /**
+     * @brief Smallest value counted in bucket @p index
+     */
+    static qint64 bucketLower(int index);
+    /**
+     * @brief Number of values covered by bucket @p index
+     */
+    static qint64 bucketWidth(int index);
+    /**
+     * @brief Re-bins the counts into @p binCount bins of @p binWidth
+     *
+     * A bucket is counted in the bin of its lower bound, buckets beyond the
+     * covered range are counted in the last bin.
+     */
+    QVector<double> histogram(qint64 binWidth, int binCount) const;
+
+private:
+    std::atomic<quint64> _buckets[BUCKET_COUNT];
+    std::atomic<quint64> _count;
+    std::atomic<qint64> _sum;
+    std::atomic<qint64> _minimum;
+    std::atomic<qint64> _maximum;
+
+    static int bucketIndex(quint64 value);
+};
+
+#endif // CHDRHISTOGRAM_H
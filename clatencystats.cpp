@@ -0,0 +1,68 @@
+#include "clatencystats.h"
+#include <algorithm>
+#include <cmath>
+
+CLatencyStats::CLatencyStats(int historySize) :
+    _historySize(qMax(1, historySize))
+{
+    clear();
+}
+
+void CLatencyStats::add(Stage stage, qint64 latencyNs)
+{
+    QVector<qint64> &history = _history[stage];
+    if (history.size() < _historySize) {
+        history.append(latencyNs);
+    } else {
+        history[_next[stage]] = latencyNs;
+        _next[stage] = (_next[stage] + 1) % _historySize;
+    }
+}
+
+void CLatencyStats::clear()
+{
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        _history[i].clear();
+        _history[i].reserve(_historySize);
+        _next[i] = 0;
+    }
+}
+
+qint64 CLatencyStats::percentile(Stage stage, double fraction) const
+{
+    if (_history[stage].isEmpty())
+        return 0;
+
+    QVector<qint64> sorted = _history[stage];
+    const int index = qBound(0, int(std::ceil(fraction * sorted.size())) - 1, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted.at(index);
+}
+
+qint64 CLatencyStats::maximum(Stage stage) const
+{
+    if (_history[stage].isEmpty())
+        return 0;
+    return *std::max_element(_history[stage].constBegin(), _history[stage].constEnd());
+}
+
+QVector<int> CLatencyStats::histogram(Stage stage, qint64 binWidthNs, int binCount) const
+{
+    QVector<int> bins(qMax(0, binCount), 0);
+    if (binCount <= 0 || binWidthNs <= 0)
+        return bins;
+
+    const QVector<qint64> &history = _history[stage];
+    for (int i = 0; i < history.size(); ++i) {
+        // Negative ages can only come from clock misuse, keep them visible in the first bin
+        const qint64 bin = qBound(qint64(0), history.at(i) / binWidthNs, qint64(binCount - 1));
+        ++bins[int(bin)];
+    }
+    return bins;
+}
+
+const char *CLatencyStats::stageName(Stage stage)
+{
+    static const char *names[STAGE_COUNT] = { "published", "drained", "appended", "replotted", "painted" };
+    return names[stage];
+}
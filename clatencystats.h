@@ -0,0 +1,72 @@
+#ifndef CLATENCYSTATS_H
+#define CLATENCYSTATS_H
+
+#include <QtGlobal>
+#include <QVector>
+
+/**
+ * @brief Rolling distribution of the acquisition-to-display latency
+ *
+ * Every sample carries the CLOCK_MONOTONIC time of the EtherCAT cycle that
+ * produced it. At each checkpoint along the display path the GUI records the
+ * age of the oldest sample that passed it, so the value at #Painted bounds the
+ * time any sample took from its cycle to the screen. The last historySize()
+ * values are kept per stage.
+ */
+class CLatencyStats
+{
+public:
+    /**
+     * @brief Checkpoints along the display path, in the order they are passed
+     */
+    enum Stage {
+        Published,  ///< Record pushed into the sample ring by CEthercatThread
+        Drained,    ///< Record popped from the ring by the GUI thread
+        Appended,   ///< QCPGraph::addData() returned
+        Replotted,  ///< Layers drawn into the paint buffers by QCustomPlot::replot()
+        Painted,    ///< QCustomPlot::paintEvent() blitted the buffers to the widget
+        STAGE_COUNT
+    };
+
+    explicit CLatencyStats(int historySize = 1024);
+
+    /**
+     * @brief Adds one latency in nanoseconds to the rolling window of @a stage
+     */
+    void add(Stage stage, qint64 latencyNs);
+    /**
+     * @brief Drops all recorded latencies
+     */
+    void clear();
+
+    int historySize() const { return _historySize; }
+    /**
+     * @brief Number of latencies currently held for @a stage
+     */
+    int count(Stage stage) const { return _history[stage].size(); }
+    /**
+     * @brief Latency below which @a fraction (0 to 1) of the held values lie
+     *
+     * Returns 0 if nothing was recorded yet.
+     */
+    qint64 percentile(Stage stage, double fraction) const;
+    qint64 maximum(Stage stage) const;
+    /**
+     * @brief Counts the held latencies of @a stage in @a binCount bins of @a binWidthNs
+     *
+     * Latencies beyond the covered range are counted in the last bin.
+     */
+    QVector<int> histogram(Stage stage, qint64 binWidthNs, int binCount) const;
+
+    static const char *stageName(Stage stage);
+
+private:
+    int _historySize;
+    QVector<qint64> _history[STAGE_COUNT];
+    /**
+     * @brief Next slot to overwrite per stage once its window is full
+     */
+    int _next[STAGE_COUNT];
+};
+
+#endif // CLATENCYSTATS_H
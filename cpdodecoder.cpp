@@ -0,0 +1,256 @@
+#include "cpdodecoder.h"
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QtEndian>
+#include <string.h>
+#include <algorithm>
+
+int CPdoField::bitLength(Type type)
+{
+    switch (type) {
+    case Bit:
+        return 1;
+    case Int8:
+    case UInt8:
+        return 8;
+    case Int16:
+    case UInt16:
+        return 16;
+    case Int32:
+    case UInt32:
+    case Real32:
+        return 32;
+    case Int64:
+    case UInt64:
+    case Real64:
+        return 64;
+    }
+    return 0;
+}
+
+CPdoDecoder::CPdoDecoder() :
+    _channelCount(0)
+{
+    clear();
+}
+
+void CPdoDecoder::clear()
+{
+    _ops.clear();
+    _domainBegin.fill(0, 1);
+    _channelCount = 0;
+}
+
+bool CPdoDecoder::compile(const QVector<CPdoField> &fields, CEcatBackend *backend)
+{
+    clear();
+
+    QVector<Op> ops;
+    ops.reserve(fields.size());
+    for (int i = 0; i < fields.size(); ++i) {
+        const CPdoField &field = fields.at(i);
+        if (field.domain < 0 || field.domain >= CEcatBackend::MAX_DOMAINS) {
+            _errorString = QString("Field %1 is mapped into the invalid domain %2").arg(field.name).arg(field.domain);
+            return false;
+        }
+        while (backend->domainCount() <= field.domain) {
+            if (backend->createDomain() < 0) {
+                _errorString = backend->errorString();
+                return false;
+            }
+        }
+        uint bitPosition = 0;
+        int byteOffset = backend->registerEntry(field.entry, field.domain, &bitPosition);
+        if (byteOffset < 0) {
+            _errorString = backend->errorString();
+            return false;
+        }
+
+        Op op;
+        op.channel = quint16(i);
+        op.type = quint8(field.type);
+        op.domain = quint8(field.domain);
+        op.enabled = 1;
+        op.scale = field.scale;
+        op.offset = field.offset;
+        if (field.type == CPdoField::Bit) {
+            // Fold the entry's bit position and the bit inside the entry into one absolute bit
+            const uint absoluteBit = bitPosition + field.bitOffset;
+            op.byteOffset = quint32(byteOffset) + absoluteBit / 8;
+            op.bit = quint8(absoluteBit % 8);
+        } else {
+            if (bitPosition != 0) {
+                _errorString = QString("Field %1 is not byte aligned in the process image").arg(field.name);
+                return false;
+            }
+            op.byteOffset = quint32(byteOffset);
+            op.bit = 0;
+        }
+        ops.append(op);
+    }
+
+    // Group the ops by domain and walk each image front to back when decoding
+    std::sort(ops.begin(), ops.end());
+    _ops = ops;
+    _domainBegin.fill(0, backend->domainCount() + 1);
+    for (int i = 0; i < _ops.size(); ++i)
+        ++_domainBegin[_ops.at(i).domain + 1];
+    for (int domain = 0; domain < backend->domainCount(); ++domain)
+        _domainBegin[domain + 1] += _domainBegin.at(domain);
+    _channelCount = fields.size();
+    return true;
+}
+
+bool CPdoDecoder::validate(const CEcatBackend *backend)
+{
+    for (int i = 0; i < _ops.size(); ++i) {
+        const Op &op = _ops.at(i);
+        const int bytes = qMax(CPdoField::bitLength(CPdoField::Type(op.type)) / 8, 1);
+        const quint32 size = backend->processDataSize(op.domain);
+        if (op.byteOffset + quint32(bytes) > size) {
+            _errorString = QString("Channel %1 lies outside of the %2 byte process image of domain %3")
+                    .arg(op.channel).arg(size).arg(op.domain);
+            clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+inline double CPdoDecoder::extract(const Op &op, const quint8 *image)
+{
+    const uchar *src = image + op.byteOffset;
+    switch (op.type) {
+    case CPdoField::Bit:
+        return (src[0] >> op.bit) & 1;
+    case CPdoField::Int8:
+        return qint8(src[0]);
+    case CPdoField::UInt8:
+        return src[0];
+    case CPdoField::Int16:
+        return qFromLittleEndian<qint16>(src);
+    case CPdoField::UInt16:
+        return qFromLittleEndian<quint16>(src);
+    case CPdoField::Int32:
+        return qFromLittleEndian<qint32>(src);
+    case CPdoField::UInt32:
+        return qFromLittleEndian<quint32>(src);
+    case CPdoField::Int64:
+        return double(qFromLittleEndian<qint64>(src));
+    case CPdoField::UInt64:
+        return double(qFromLittleEndian<quint64>(src));
+    case CPdoField::Real32: {
+        const quint32 bits = qFromLittleEndian<quint32>(src);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    case CPdoField::Real64: {
+        const quint64 bits = qFromLittleEndian<quint64>(src);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    }
+    return 0.0;
+}
+
+void CPdoDecoder::decode(int domain, const quint8 *image, double *values) const
+{
+    const Op *op = _ops.constData() + _domainBegin.at(domain);
+    const Op *end = _ops.constData() + _domainBegin.at(domain + 1);
+    for (; op != end; ++op)
+        if (op->enabled)
+            values[op->channel] = extract(*op, image) * op->scale + op->offset;
+}
+
+void CPdoDecoder::decode(int domain, const quint8 *image, float *values) const
+{
+    const Op *op = _ops.constData() + _domainBegin.at(domain);
+    const Op *end = _ops.constData() + _domainBegin.at(domain + 1);
+    for (; op != end; ++op)
+        if (op->enabled)
+            values[op->channel] = float(extract(*op, image) * op->scale + op->offset);
+}
+
+void CPdoDecoder::setChannelEnabled(int channel, bool enabled)
+{
+    Op *op = _ops.data();
+    Op *end = op + _ops.size();
+    for (; op != end; ++op)
+        if (op->channel == channel)
+            op->enabled = enabled;
+}
+
+bool CPdoDecoder::readMapping(const QString &path, QVector<CPdoField> *fields, QVector<int> *divisors, QString *errorString)
+{
+    static const char *const typeNames[] = { "bit", "int8", "uint8", "int16", "uint16", "int32", "uint32", "int64", "uint64", "real32", "real64" };
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        *errorString = QString("%1: %2").arg(path).arg(file.errorString());
+        return false;
+    }
+    fields->clear();
+    divisors->clear();
+
+    QTextStream stream(&file);
+    for (int lineNumber = 1; !stream.atEnd(); ++lineNumber) {
+        const QString line = stream.readLine().section('#', 0, 0).simplified();
+        if (line.isEmpty())
+            continue;
+        const QStringList tokens = line.split(' ');
+        bool ok = true;
+        bool valid = false;
+
+        if (tokens.at(0) == "divisor") {
+            const int domain = tokens.value(1).toInt(&ok, 0);
+            const int divisor = ok ? tokens.value(2).toInt(&ok, 0) : 0;
+            valid = ok && tokens.size() == 3 && domain >= 0 && domain < CEcatBackend::MAX_DOMAINS && divisor > 0;
+            if (valid) {
+                if (divisors->size() <= domain)
+                    divisors->resize(domain + 1);
+                (*divisors)[domain] = divisor;
+            }
+        } else if (tokens.size() >= 6 && tokens.size() <= 9) {
+            CPdoField field;
+            field.name = tokens.at(0);
+            field.entry.position = quint16(tokens.at(1).toUInt(&ok, 0));
+            if (ok)
+                field.entry.vendorId = tokens.at(2).toUInt(&ok, 0);
+            if (ok)
+                field.entry.productCode = tokens.at(3).toUInt(&ok, 0);
+            const QStringList entry = tokens.at(4).split(':');
+            if (ok)
+                field.entry.index = quint16(entry.at(0).toUInt(&ok, 0));
+            if (ok)
+                field.entry.subindex = quint8(entry.value(1).toUInt(&ok, 0));
+            const QStringList type = tokens.at(5).split('.');
+            int typeIndex = 0;
+            while (typeIndex <= CPdoField::Real64 && type.at(0) != typeNames[typeIndex])
+                ++typeIndex;
+            field.type = CPdoField::Type(typeIndex);
+            field.bitOffset = 0;
+            if (ok && field.type == CPdoField::Bit)
+                field.bitOffset = quint8(type.value(1).toUInt(&ok, 0));
+            field.scale = tokens.size() > 6 && ok ? tokens.at(6).toDouble(&ok) : 1.0;
+            field.offset = tokens.size() > 7 && ok ? tokens.at(7).toDouble(&ok) : 0.0;
+            field.domain = tokens.size() > 8 && ok ? tokens.at(8).toInt(&ok, 0) : 0;
+            valid = ok && entry.size() == 2 && typeIndex <= CPdoField::Real64
+                    && (type.size() == 1 || (field.type == CPdoField::Bit && type.size() == 2 && field.bitOffset < 64));
+            if (valid)
+                fields->append(field);
+        }
+
+        if (!valid) {
+            *errorString = QString("%1:%2: invalid mapping \"%3\"").arg(path).arg(lineNumber).arg(line);
+            return false;
+        }
+    }
+    if (fields->isEmpty()) {
+        *errorString = QString("%1 maps no fields").arg(path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,154 @@
+#ifndef CPDODECODER_H
+#define CPDODECODER_H
+
+#include <QString>
+#include <QVector>
+#include "cecatbackend.h"
+
+/**
+ * @brief Description of one decoded channel of the process image
+ *
+ * The physical value is raw * #scale + #offset, where raw is the entry
+ * interpreted as #type.
+ */
+struct CPdoField
+{
+    enum Type {
+        Bit,        ///< single bit at #bitOffset, 0 or 1
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Int64,
+        UInt64,
+        Real32,
+        Real64
+    };
+
+    QString name;
+    CEcatEntry entry;
+    Type type;
+    /**
+     * @brief Bit inside the entry, only used by #Bit (e.g. 10 for "target reached" of a status word)
+     */
+    quint8 bitOffset;
+    double scale;
+    double offset;
+    /**
+     * @brief Process-data domain the entry is mapped into, see CEcatBackend
+     */
+    int domain;
+
+    /**
+     * @brief Size of @a type in the image, in bits
+     */
+    static int bitLength(Type type);
+};
+
+/**
+ * @brief Decodes the process images into channel values through a precompiled op table
+ *
+ * compile() resolves every field to an absolute byte/bit position once and
+ * stores it as a flat op, sorted by domain and image offset. decode() is then
+ * a single pass over the ops of one domain without lookups, allocation or
+ * string handling, cheap enough to run every cycle.
+ */
+class CPdoDecoder
+{
+public:
+    CPdoDecoder();
+
+    /**
+     * @brief Registers all @a fields with @a backend and builds the op table
+     *
+     * Creates the domains the fields refer to. Must be called between
+     * CEcatBackend::open() and CEcatBackend::activate(). On failure the table
+     * is left empty and errorString() says why.
+     */
+    bool compile(const QVector<CPdoField> &fields, CEcatBackend *backend);
+    /**
+     * @brief Checks that all ops lie inside the images of @a backend
+     *
+     * Call after CEcatBackend::activate(), once the domain sizes are known.
+     */
+    bool validate(const CEcatBackend *backend);
+    void clear();
+
+    /**
+     * @brief Number of channels produced by decode()
+     */
+    int channelCount() const { return _channelCount; }
+    /**
+     * @brief Number of domains the fields are mapped into
+     */
+    int domainCount() const { return _domainBegin.size() - 1; }
+    /**
+     * @brief Writes each channel i of @a domain, decoded from its @a image, to @a values[i]
+     *
+     * The values of channels in other domains are left untouched.
+     */
+    void decode(int domain, const quint8 *image, double *values) const;
+    /**
+     * @brief Single precision variant of decode(int, const quint8 *, double *)
+     */
+    void decode(int domain, const quint8 *image, float *values) const;
+    /**
+     * @brief Skips @a channel in decode() while @a enabled is @em false
+     *
+     * Only flips a flag in the compiled ops, safe to call between two decode()
+     * calls of a running cycle loop. compile() enables all channels.
+     */
+    void setChannelEnabled(int channel, bool enabled);
+
+    QString errorString() const { return _errorString; }
+
+    /**
+     * @brief Reads the fields and domain divisors of the mapping file at @p path
+     *
+     * One field or divisor per line, separated by whitespace:
+     * @code
+     * <name> <position> <vendor id> <product code> <index>:<subindex> <type> [<scale> [<offset> [<domain>]]]
+     * divisor <domain> <divisor>
+     * @endcode
+     * Numbers may be written in hex with a 0x prefix. The types are bit,
+     * int8, uint8, int16, uint16, int32, uint32, int64, uint64, real32 and
+     * real64, a bit also names its bit inside the entry, e.g. bit.10. Text
+     * after # is ignored. On failure @p errorString names the offending line.
+     */
+    static bool readMapping(const QString &path, QVector<CPdoField> *fields, QVector<int> *divisors, QString *errorString);
+
+private:
+    /**
+     * @brief One extractor step, resolved to an absolute position in the image
+     */
+    struct Op
+    {
+        quint32 byteOffset;
+        quint16 channel;
+        quint8 type;
+        quint8 bit;
+        quint8 domain;
+        quint8 enabled;
+        double scale;
+        double offset;
+
+        bool operator<(const Op &other) const
+        {
+            return domain != other.domain ? domain < other.domain : byteOffset < other.byteOffset;
+        }
+    };
+
+    QVector<Op> _ops;
+    /**
+     * @brief First op of each domain, followed by the end of the table
+     */
+    QVector<int> _domainBegin;
+    int _channelCount;
+    QString _errorString;
+
+    static inline double extract(const Op &op, const quint8 *image);
+};
+
+#endif // CPDODECODER_H
@@ -0,0 +1,86 @@
+#include "crtplacement.h"
+#include <QStringList>
+#include <alloca.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+CRtPlacement::CRtPlacement() :
+    _cpu(-1),
+    _priority(0),
+    _lockMemory(false),
+    _stackPrefault(0)
+{
+}
+
+bool CRtPlacement::apply()
+{
+    _errorString.clear();
+
+    if (_cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(_cpu, &set);
+        const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result != 0)
+            fail(QString("Cannot pin to CPU %1: %2").arg(_cpu).arg(strerror(result)));
+    }
+
+    if (_priority > 0) {
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = qMin(_priority, sched_get_priority_max(SCHED_FIFO));
+        const int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (result != 0)
+            fail(QString("Cannot set SCHED_FIFO priority %1: %2").arg(param.sched_priority).arg(strerror(result)));
+    }
+
+    if (_lockMemory && mlockall(MCL_CURRENT) != 0)
+        fail(QString("Cannot lock memory: %1").arg(strerror(errno)));
+
+    if (_stackPrefault > 0)
+        prefaultStack(_stackPrefault);
+
+    return _errorString.isEmpty();
+}
+
+void CRtPlacement::prefault(void *data, size_t bytes)
+{
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    volatile char *page = static_cast<volatile char *>(data);
+    for (size_t offset = 0; offset < bytes; offset += pageSize)
+        page[offset] = page[offset];
+    if (bytes > 0)
+        page[bytes - 1] = page[bytes - 1];
+}
+
+QString CRtPlacement::toString() const
+{
+    QStringList settings;
+    settings << (_cpu >= 0 ? QString("CPU %1").arg(_cpu) : QString("any CPU"));
+    settings << (_priority > 0 ? QString("SCHED_FIFO %1").arg(_priority) : QString("SCHED_OTHER"));
+    if (_lockMemory)
+        settings << "memory locked";
+    if (_stackPrefault > 0)
+        settings << QString("%1 KiB stack prefaulted").arg(_stackPrefault / 1024);
+    return settings.join(", ");
+}
+
+void CRtPlacement::fail(const QString &message)
+{
+    if (!_errorString.isEmpty())
+        _errorString += "; ";
+    _errorString += message;
+}
+
+// Not inlined, so the area really lies below the frames the cycle loop will use
+__attribute__((noinline)) void CRtPlacement::prefaultStack(int bytes)
+{
+    volatile char *stack = static_cast<volatile char *>(alloca(size_t(bytes)));
+    const int pageSize = int(sysconf(_SC_PAGESIZE));
+    for (int offset = 0; offset < bytes; offset += pageSize)
+        stack[offset] = 0;
+}
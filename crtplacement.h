@@ -0,0 +1,85 @@
+#ifndef CRTPLACEMENT_H
+#define CRTPLACEMENT_H
+
+#include <QtGlobal>
+#include <QString>
+
+/**
+ * @brief Real-time placement of the calling thread: CPU, scheduling and memory
+ *
+ * Holds the settings and applies them with apply() from the thread to be
+ * placed, usually the acquisition thread right before its cycle loop. The
+ * defaults leave the thread as it is.
+ *
+ * For a production setup the CPU is isolated from the scheduler (e.g. with
+ * isolcpus= and nohz_full= on the kernel command line), so neither the GUI
+ * nor the concurrent replot share it. SCHED_FIFO and mlockall() need
+ * CAP_SYS_NICE and CAP_IPC_LOCK or matching RLIMIT_RTPRIO and RLIMIT_MEMLOCK.
+ */
+class CRtPlacement
+{
+public:
+    /**
+     * @brief Largest stack area touched by apply(), well below the default thread stack
+     */
+    enum { MAX_STACK_PREFAULT = 1024 * 1024 };
+
+    CRtPlacement();
+
+    /**
+     * @brief Pins the thread to @p cpu, -1 lets the kernel migrate it
+     */
+    void setCpu(int cpu) { _cpu = cpu; }
+    int cpu() const { return _cpu; }
+    /**
+     * @brief Runs the thread with SCHED_FIFO at @p priority (1 to 99), 0 keeps the normal policy
+     */
+    void setPriority(int priority) { _priority = qBound(0, priority, 99); }
+    int priority() const { return _priority; }
+    /**
+     * @brief Locks the pages mapped so far into RAM with mlockall(MCL_CURRENT)
+     *
+     * Locking faults them in, which prefaults the sample rings, the decoder
+     * and the backend buffers. Later mappings are deliberately not locked:
+     * capture files are mapped and may be larger than RAM.
+     */
+    void setLockMemory(bool enabled) { _lockMemory = enabled; }
+    bool lockMemory() const { return _lockMemory; }
+    /**
+     * @brief Touches @p bytes of stack below the caller of apply(), so the loop never faults on it
+     *
+     * Clamped to #MAX_STACK_PREFAULT.
+     */
+    void setStackPrefault(int bytes) { _stackPrefault = qBound(0, bytes, int(MAX_STACK_PREFAULT)); }
+    int stackPrefault() const { return _stackPrefault; }
+
+    /**
+     * @brief Applies the settings to the calling thread
+     *
+     * Every setting is attempted even if an earlier one fails. Returns
+     * @em false if any failed, errorString() then lists them.
+     */
+    bool apply();
+    /**
+     * @brief Writes one byte per page of @p data, so later accesses do not fault
+     */
+    static void prefault(void *data, size_t bytes);
+
+    QString errorString() const { return _errorString; }
+    /**
+     * @brief Short description of the settings, for logs and tool tips
+     */
+    QString toString() const;
+
+private:
+    int _cpu;
+    int _priority;
+    bool _lockMemory;
+    int _stackPrefault;
+    QString _errorString;
+
+    void fail(const QString &message);
+    static void prefaultStack(int bytes);
+};
+
+#endif // CRTPLACEMENT_H
@@ -0,0 +1,62 @@
+#ifndef CSAMPLERECORD_H
+#define CSAMPLERECORD_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Binary record of one acquisition cycle
+ *
+ * Plain data, copied by value through CSpscRing from the acquisition thread
+ * to the GUI thread.
+ */
+struct CSampleRecord
+{
+    /**
+     * @brief Maximum number of channels carried per cycle
+     */
+    enum { MAX_CHANNELS = 32 };
+
+    /**
+     * @brief Cycle counter since the start of the run
+     */
+    quint64 cycle;
+    /**
+     * @brief CLOCK_MONOTONIC time of the cycle deadline, in nanoseconds
+     */
+    qint64 timestampNs;
+    /**
+     * @brief CLOCK_MONOTONIC time the record was handed to the ring, in nanoseconds
+     */
+    qint64 publishNs;
+    /**
+     * @brief Distributed-clock system time of the frame the inputs were latched in, in nanoseconds
+     *
+     * 0 if the bus has no DC reference clock, see CEcatBackend::referenceClockTime().
+     */
+    quint64 dcTimeNs;
+    /**
+     * @brief Period from this cycle's deadline to the next one, in nanoseconds
+     *
+     * Changes from one record to the next when the cycle time is changed at runtime.
+     */
+    qint64 cycleTimeNs;
+    /**
+     * @brief Number of valid entries in #values
+     */
+    quint32 channelCount;
+    /**
+     * @brief Process-data domains exchanged in this cycle, bit i for domain i
+     *
+     * Channels of the other domains repeat the value of their last exchange.
+     */
+    quint32 domainMask;
+    /**
+     * @brief Channels decoded in this cycle, bit i for channel i
+     *
+     * Disabled channels repeat their last value.
+     */
+    quint32 channelMask;
+    double values[MAX_CHANNELS];
+};
+
+#endif // CSAMPLERECORD_H
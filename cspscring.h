@@ -0,0 +1,146 @@
+#ifndef CSPSCRING_H
+#define CSPSCRING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <vector>
+
+/**
+ * @brief Fixed-capacity wait-free single-producer/single-consumer ring
+ *
+ * One thread may call push() and one other thread may call pop()/popBulk().
+ * Neither side ever blocks or allocates: push() fails when the ring is full
+ * and pop() fails when it is empty. The producer and consumer indices live on
+ * separate cache lines so the two threads do not false-share. Owners created
+ * with new rely on C++17, which allocates over-aligned types accordingly.
+ *
+ * @tparam T trivially copyable record type
+ */
+template <typename T>
+class CSpscRing
+{
+public:
+    /**
+     * @brief Creates a ring able to hold at least @a capacity records
+     *
+     * The capacity is rounded up to the next power of two.
+     */
+    explicit CSpscRing(quint32 capacity);
+
+    /**
+     * @brief Appends @a item, producer side only
+     * @return @em false if the ring is full and @a item was dropped
+     */
+    bool push(const T &item);
+    /**
+     * @brief Removes the oldest record into @a item, consumer side only
+     * @return @em false if the ring is empty
+     */
+    bool pop(T &item);
+    /**
+     * @brief Removes up to @a maxItems records into @a items, consumer side only
+     * @return number of records copied
+     */
+    quint32 popBulk(T *items, quint32 maxItems);
+
+    quint32 capacity() const { return _mask + 1; }
+    /**
+     * @brief Number of queued records, exact only when called from one of the two sides
+     */
+    quint32 size() const;
+    bool isEmpty() const { return size() == 0; }
+
+private:
+    Q_DISABLE_COPY(CSpscRing)
+
+    enum { CACHE_LINE = 64 };
+
+    /**
+     * @brief Record storage, sized once in the constructor
+     */
+    std::vector<T> _buffer;
+    quint32 _mask;
+
+    /**
+     * @brief Next slot to write, owned by the producer
+     */
+    alignas(CACHE_LINE) std::atomic<quint32> _head;
+    /**
+     * @brief Producer's last seen value of #_tail, saves reloading a remote cache line
+     */
+    quint32 _tailCache;
+
+    /**
+     * @brief Next slot to read, owned by the consumer
+     */
+    alignas(CACHE_LINE) std::atomic<quint32> _tail;
+    /**
+     * @brief Consumer's last seen value of #_head
+     */
+    quint32 _headCache;
+
+    char _pad[CACHE_LINE - sizeof(std::atomic<quint32>) - sizeof(quint32)];
+};
+
+template <typename T>
+CSpscRing<T>::CSpscRing(quint32 capacity) :
+    _mask(0),
+    _head(0),
+    _tailCache(0),
+    _tail(0),
+    _headCache(0)
+{
+    quint32 size = 2;
+    while (size < capacity)
+        size <<= 1;
+    _buffer.resize(size);
+    _mask = size - 1;
+}
+
+template <typename T>
+bool CSpscRing<T>::push(const T &item)
+{
+    const quint32 head = _head.load(std::memory_order_relaxed);
+    if (head - _tailCache > _mask) {
+        _tailCache = _tail.load(std::memory_order_acquire);
+        if (head - _tailCache > _mask)
+            return false;
+    }
+    _buffer[head & _mask] = item;
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool CSpscRing<T>::pop(T &item)
+{
+    const quint32 tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _headCache) {
+        _headCache = _head.load(std::memory_order_acquire);
+        if (tail == _headCache)
+            return false;
+    }
+    item = _buffer[tail & _mask];
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+quint32 CSpscRing<T>::popBulk(T *items, quint32 maxItems)
+{
+    const quint32 tail = _tail.load(std::memory_order_relaxed);
+    _headCache = _head.load(std::memory_order_acquire);
+    const quint32 count = qMin(_headCache - tail, maxItems);
+    for (quint32 i = 0; i < count; ++i)
+        items[i] = _buffer[(tail + i) & _mask];
+    _tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+quint32 CSpscRing<T>::size() const
+{
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+}
+
+#endif // CSPSCRING_H
@@ -0,0 +1,109 @@
+#include "ctrigger.h"
+
+CTriggerConfig::CTriggerConfig() :
+    mode(Edge),
+    slope(Rising),
+    channel(0),
+    bit(-1),
+    level(0),
+    lower(-1),
+    upper(1),
+    hysteresis(0),
+    preCycles(1000),
+    postCycles(1000)
+{
+}
+
+CTrigger::CTrigger(const CTriggerConfig &config) :
+    _config(config)
+{
+    _config.channel = qBound(0, _config.channel, int(CSampleRecord::MAX_CHANNELS) - 1);
+    _config.bit = qBound(-1, _config.bit, 63);
+    _config.hysteresis = qMax(_config.hysteresis, 0.0);
+    _config.preCycles = qBound(0, _config.preCycles, int(CTriggerConfig::MAX_DEPTH));
+    _config.postCycles = qBound(0, _config.postCycles, int(CTriggerConfig::MAX_DEPTH));
+    if (_config.lower > _config.upper)
+        qSwap(_config.lower, _config.upper);
+
+    _window.resize(_config.preCycles + 1 + _config.postCycles);
+    rearm();
+}
+
+void CTrigger::rearm()
+{
+    _head = 0;
+    _filled = 0;
+    _remaining = 0;
+    _state = Armed;
+    _risingReady = false;
+    _fallingReady = false;
+    _triggerCycle = 0;
+}
+
+bool CTrigger::process(const CSampleRecord &record)
+{
+    if (_state == Done)
+        return false;
+
+    const int size = int(_window.size());
+    _window[_head] = record;
+    if (++_head == size)
+        _head = 0;
+    if (_filled < size)
+        ++_filled;
+
+    if (_state == Triggered) {
+        if (--_remaining > 0)
+            return false;
+        _state = Done;
+        return true;
+    }
+
+    // The edge state follows every sample, also while the pre-trigger part is still filling
+    if (!fires(sample(record)) || _filled <= _config.preCycles)
+        return false;
+    _triggerCycle = record.cycle;
+    _remaining = _config.postCycles;
+    _state = _remaining > 0 ? Triggered : Done;
+    return _state == Done;
+}
+
+double CTrigger::sample(const CSampleRecord &record) const
+{
+    const double value = record.values[_config.channel];
+    if (_config.bit < 0 || value != value)
+        return value;
+    return double((quint64(qint64(value)) >> _config.bit) & 1);
+}
+
+bool CTrigger::fires(double sample)
+{
+    // "High" is above the level or outside the window, "far" adds the hysteresis. NaN is neither.
+    const double h = _config.hysteresis;
+    bool high, low, farHigh, farLow;
+    if (_config.mode == CTriggerConfig::Window) {
+        high = sample < _config.lower || sample > _config.upper;
+        low = sample >= _config.lower && sample <= _config.upper;
+        farHigh = sample < _config.lower - h || sample > _config.upper + h;
+        farLow = sample >= _config.lower + h && sample <= _config.upper - h;
+    } else {
+        high = sample >= _config.level;
+        low = sample <= _config.level;
+        farHigh = sample > _config.level + h;
+        farLow = sample < _config.level - h;
+    }
+    if (_config.mode == CTriggerConfig::Level)
+        return _config.slope == CTriggerConfig::Falling ? low : high;
+
+    const bool fired = (_config.slope != CTriggerConfig::Falling && _risingReady && high)
+            || (_config.slope != CTriggerConfig::Rising && _fallingReady && low);
+    if (farLow)
+        _risingReady = true;
+    else if (high)
+        _risingReady = false;
+    if (farHigh)
+        _fallingReady = true;
+    else if (low)
+        _fallingReady = false;
+    return fired;
+}
@@ -0,0 +1,154 @@
+#ifndef CTRIGGER_H
+#define CTRIGGER_H
+
+#include <QtGlobal>
+#include <vector>
+#include "csamplerecord.h"
+
+/**
+ * @brief Condition and capture depth of a CTrigger
+ */
+struct CTriggerConfig
+{
+    enum Mode {
+        Edge,   ///< fires when the sample crosses #level
+        Level,  ///< fires as soon as the sample is at or beyond #level
+        Window  ///< fires when the sample leaves or enters [#lower, #upper]
+    };
+    /**
+     * @brief Direction of the crossing
+     *
+     * For #Edge rising means upwards through #level, for #Window it means
+     * leaving the window and falling means entering it. #Level fires above
+     * #level when rising or either, below it when falling.
+     */
+    enum Slope {
+        Rising,
+        Falling,
+        Either
+    };
+
+    /**
+     * @brief Longest pre- and post-trigger depth accepted, in cycles
+     */
+    enum { MAX_DEPTH = 65536 };
+
+    Mode mode;
+    Slope slope;
+    /**
+     * @brief Channel of CSampleRecord::values the condition is evaluated on
+     */
+    int channel;
+    /**
+     * @brief Bit of the channel the condition is evaluated on, -1 for the value itself
+     *
+     * With a bit the sample is 0 or 1 (e.g. bit 3 "fault" of a status word), a
+     * #level of 0.5 then triggers on its edges.
+     */
+    int bit;
+    double level;
+    double lower;
+    double upper;
+    /**
+     * @brief Distance the sample has to move back before #Edge or #Window can fire again
+     *
+     * Keeps noise around the threshold from firing on every cycle.
+     */
+    double hysteresis;
+    /**
+     * @brief Cycles kept before the trigger cycle
+     */
+    int preCycles;
+    /**
+     * @brief Cycles captured after the trigger cycle
+     */
+    int postCycles;
+
+    CTriggerConfig();
+};
+
+/**
+ * @brief Oscilloscope-style trigger evaluated on every cycle of the acquisition loop
+ *
+ * While armed, process() keeps the last CTriggerConfig::preCycles records in a
+ * ring and tests the condition on each new one. Once it fires, the following
+ * CTriggerConfig::postCycles records are captured and the trigger is done: the
+ * window then holds size() consecutive cycles with the trigger cycle at
+ * triggerIndex(). The condition is only tested once the pre-trigger part is
+ * full, so every window has the same length.
+ *
+ * All storage is allocated in the constructor, process() neither allocates
+ * nor locks and is cheap enough to run every cycle. The trigger is not thread
+ * safe: CEthercatThread hands it between the threads through SPSC rings.
+ */
+class CTrigger
+{
+public:
+    enum State {
+        Armed,      ///< filling the pre-trigger part and waiting for the condition
+        Triggered,  ///< capturing the post-trigger part
+        Done        ///< the window is complete
+    };
+
+    explicit CTrigger(const CTriggerConfig &config);
+
+    const CTriggerConfig &config() const { return _config; }
+    State state() const { return _state; }
+    /**
+     * @brief Discards the captured window and arms the trigger again
+     */
+    void rearm();
+    /**
+     * @brief Feeds the record of the next cycle, the records must be consecutive
+     * @return @em true when this record completed the window
+     */
+    bool process(const CSampleRecord &record);
+
+    /**
+     * @brief Number of cycles in a complete window
+     */
+    int size() const { return int(_window.size()); }
+    /**
+     * @brief Record @p index of the window, oldest first, only valid when Done
+     */
+    const CSampleRecord &at(int index) const { return _window[(_head + index) % _window.size()]; }
+    /**
+     * @brief Position of the trigger cycle in the window
+     */
+    int triggerIndex() const { return _config.preCycles; }
+    quint64 triggerCycle() const { return _triggerCycle; }
+
+private:
+    CTriggerConfig _config;
+    /**
+     * @brief Ring of the last size() records, #_head is the next slot to write
+     */
+    std::vector<CSampleRecord> _window;
+    int _head;
+    /**
+     * @brief Records written since arming, saturates at size()
+     */
+    int _filled;
+    /**
+     * @brief Post-trigger records still to capture
+     */
+    int _remaining;
+    State _state;
+    /**
+     * @brief The sample was on the far side of the hysteresis, a rising or falling crossing may fire
+     */
+    bool _risingReady;
+    bool _fallingReady;
+    quint64 _triggerCycle;
+
+    /**
+     * @brief Value the condition is tested on, the channel or one of its bits
+     */
+    double sample(const CSampleRecord &record) const;
+    /**
+     * @brief Tests the condition on @p sample and advances the edge state
+     */
+    bool fires(double sample);
+};
+
+#endif // CTRIGGER_H
@@ -0,0 +1,68 @@
+#include "ctriggerdialog.h"
+#include "ui_ctriggerdialog.h"
+
+CTriggerDialog::CTriggerDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::CTriggerDialog)
+{
+    ui->setupUi(this);
+    ui->channelBox->setMaximum(CSampleRecord::MAX_CHANNELS - 1);
+    ui->preCyclesBox->setMaximum(CTriggerConfig::MAX_DEPTH);
+    ui->postCyclesBox->setMaximum(CTriggerConfig::MAX_DEPTH);
+    setConfig(CTriggerConfig());
+}
+
+CTriggerDialog::~CTriggerDialog()
+{
+    delete ui;
+}
+
+void CTriggerDialog::setConfig(const CTriggerConfig &config)
+{
+    ui->modeBox->setCurrentIndex(config.mode);
+    ui->slopeBox->setCurrentIndex(config.slope);
+    ui->channelBox->setValue(config.channel);
+    ui->bitBox->setValue(config.bit);
+    ui->levelBox->setValue(config.level);
+    ui->lowerBox->setValue(config.lower);
+    ui->upperBox->setValue(config.upper);
+    ui->hysteresisBox->setValue(config.hysteresis);
+    ui->preCyclesBox->setValue(config.preCycles);
+    ui->postCyclesBox->setValue(config.postCycles);
+    on_modeBox_currentIndexChanged(ui->modeBox->currentIndex());
+}
+
+CTriggerConfig CTriggerDialog::config() const
+{
+    CTriggerConfig config;
+    config.mode = CTriggerConfig::Mode(ui->modeBox->currentIndex());
+    config.slope = CTriggerConfig::Slope(ui->slopeBox->currentIndex());
+    config.channel = ui->channelBox->value();
+    config.bit = ui->bitBox->value();
+    config.level = ui->levelBox->value();
+    config.lower = ui->lowerBox->value();
+    config.upper = ui->upperBox->value();
+    config.hysteresis = ui->hysteresisBox->value();
+    config.preCycles = ui->preCyclesBox->value();
+    config.postCycles = ui->postCyclesBox->value();
+    return config;
+}
+
+void CTriggerDialog::setSingleShot(bool singleShot)
+{
+    ui->singleShotBox->setChecked(singleShot);
+}
+
+bool CTriggerDialog::isSingleShot() const
+{
+    return ui->singleShotBox->isChecked();
+}
+
+void CTriggerDialog::on_modeBox_currentIndexChanged(int index)
+{
+    const bool window = index == CTriggerConfig::Window;
+    ui->levelBox->setEnabled(!window);
+    ui->lowerBox->setEnabled(window);
+    ui->upperBox->setEnabled(window);
+    ui->hysteresisBox->setEnabled(index != CTriggerConfig::Level);
+}
@@ -0,0 +1,40 @@
+#ifndef CTRIGGERDIALOG_H
+#define CTRIGGERDIALOG_H
+
+#include <QDialog>
+#include "ctrigger.h"
+
+namespace Ui {
+class CTriggerDialog;
+}
+
+/**
+ * @brief Edits a CTriggerConfig and the rearm mode of the oscilloscope trigger
+ */
+class CTriggerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CTriggerDialog(QWidget *parent = 0);
+    ~CTriggerDialog();
+
+    void setConfig(const CTriggerConfig &config);
+    CTriggerConfig config() const;
+    /**
+     * @brief Stop after the first window instead of rearming after each one
+     */
+    void setSingleShot(bool singleShot);
+    bool isSingleShot() const;
+
+private:
+    Ui::CTriggerDialog *ui;
+
+private slots:
+    /**
+     * @brief Enables the fields that apply to the selected mode
+     */
+    void on_modeBox_currentIndexChanged(int index);
+};
+
+#endif // CTRIGGERDIALOG_H
@@ -1,10 +1,44 @@
 #include "mainwindow.h"
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // Placement of the acquisition thread, e.g. "--rt-cpu 3 --rt-priority 80 --rt-lock-memory"
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption cpuOption("rt-cpu", "Pin the acquisition thread to <cpu>.", "cpu", "-1");
+    QCommandLineOption priorityOption("rt-priority", "Run the acquisition thread with SCHED_FIFO at <priority> (1-99).", "priority", "0");
+    QCommandLineOption lockOption("rt-lock-memory", "Lock the memory of the process with mlockall().");
+    QCommandLineOption stackOption("rt-stack-prefault", "Prefault <kib> KiB of the acquisition thread stack.", "kib", "0");
+    QCommandLineOption mappingOption("mapping", "Decode the PDO fields listed in <file>, see CPdoDecoder::readMapping().", "file");
+    parser.addOption(cpuOption);
+    parser.addOption(priorityOption);
+    parser.addOption(lockOption);
+    parser.addOption(stackOption);
+    parser.addOption(mappingOption);
+    parser.process(a);
+
+    CRtPlacement placement;
+    placement.setCpu(parser.value(cpuOption).toInt());
+    placement.setPriority(parser.value(priorityOption).toInt());
+    placement.setLockMemory(parser.isSet(lockOption));
+    placement.setStackPrefault(parser.value(stackOption).toInt() * 1024);
+
     MainWindow w;
+    w.setRtPlacement(placement);
+    if (parser.isSet(mappingOption)) {
+        QVector<CPdoField> mapping;
+        QVector<int> divisors;
+        QString errorString;
+        if (!CPdoDecoder::readMapping(parser.value(mappingOption), &mapping, &divisors, &errorString)) {
+            qCritical("%s", qPrintable(errorString));
+            return 1;
+        }
+        w.setMapping(mapping, divisors);
+    }
     w.show();
 
     return a.exec();
@@ -1,6 +1,13 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QDebug>
+#include <QFileDialog>
+#include "ccyclictimer.h"
+#include "cecatsimbackend.h"
+#include "ctriggerdialog.h"
+#ifdef HAVE_ECRT
+#include "cecatmasterbackend.h"
+#endif
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -12,30 +19,184 @@ MainWindow::MainWindow(QWidget *parent) :
     thread = new QThread();
     o_ecat_thread = new CEthercatThread();
 
+#ifdef HAVE_ECRT
+    // The real master has no default mapping, it is set with setMapping() from the --mapping file
+    o_ecat_thread->setBackend(new CEcatMasterBackend());
+#else
+    // Without the IgH master the tool runs against a simulated drive line
+    CEcatSimBackend *sim = new CEcatSimBackend();
+    sim->addDemoLine(4);
+    o_ecat_thread->setMapping(sim->mapping());
+    // The slow ramp of the demo line sits in domain 1, exchanged every eighth cycle
+    o_ecat_thread->setDomainDivisors(QVector<int>() << 1 << 8);
+    o_ecat_thread->setBackend(sim);
+#endif
+
     o_ecat_thread->moveToThread(thread);
-    connect(o_ecat_thread, SIGNAL(valueChanged(QString)), ui->label, SLOT(setText(QString)));
+    connect(o_ecat_thread, SIGNAL(error(QString)), ui->statusBar, SLOT(showMessage(QString)));
     connect(o_ecat_thread, SIGNAL(workRequested()), thread, SLOT(start()));
     connect(thread, SIGNAL(started()), o_ecat_thread, SLOT(doWork()));
     connect(o_ecat_thread, SIGNAL(finished()), thread, SLOT(quit()), Qt::DirectConnection);
+
+    // The recorder gets a thread of its own, so disk stalls only fill its ring and never reach the cycle loop
+    recorderThread = new QThread();
+    recorder = new CCaptureRecorder(o_ecat_thread->recordRing());
+    recorder->moveToThread(recorderThread);
+    connect(recorder, SIGNAL(error(QString)), ui->statusBar, SLOT(showMessage(QString)));
+    connect(recorder, SIGNAL(workRequested()), recorderThread, SLOT(start()));
+    connect(recorderThread, SIGNAL(started()), recorder, SLOT(doWork()));
+    connect(recorder, SIGNAL(finished()), recorderThread, SLOT(quit()), Qt::DirectConnection);
+    connect(recorder, SIGNAL(finished()), this, SLOT(recordingFinished()));
+
+    // Replays take the place of the bus, their records are drained like the live ones
+    replayThread = new QThread();
+    replayer = new CCaptureReplayer();
+    replayer->moveToThread(replayThread);
+    connect(replayer, SIGNAL(workRequested()), replayThread, SLOT(start()));
+    connect(replayThread, SIGNAL(started()), replayer, SLOT(doWork()));
+    connect(replayer, SIGNAL(finished()), replayThread, SLOT(quit()), Qt::DirectConnection);
+
+    // Samples are pulled in batches on the GUI side instead of being signalled one by one.
+    sampleSource = o_ecat_thread->sampleRing();
+    drainBuffer.resize(qMax(o_ecat_thread->sampleRing()->capacity(), replayer->sampleRing()->capacity()));
+    plotTimeOrigin = -1;
+    plotChannelMask = ~0u;
+    plotWindow = 10.0;
+    drainTimer = new QTimer(this);
+    drainTimer->setTimerType(Qt::PreciseTimer);
+    connect(drainTimer, SIGNAL(timeout()), this, SLOT(drainSamples()));
+    connect(drainTimer, SIGNAL(timeout()), this, SLOT(drainTriggers()));
+    triggerSingleShot = false;
+    triggerMode = false;
+    on_frameRateBox_currentIndexChanged(ui->frameRateBox->currentIndex());
+    on_cycleTimeBox_currentIndexChanged(ui->cycleTimeBox->currentIndex());
+
+    updateChannelMenu();
+    connect(ui->menuChannels, SIGNAL(triggered(QAction*)), this, SLOT(setChannelEnabled(QAction*)));
+
+    // Measure the replot pipeline, keeping the last 10 s at 60 Hz for percentiles
+    ui->widget->setReplotTiming(true, 600);
+    replotStatsLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(replotStatsLabel);
+    statsTimer = new QTimer(this);
+    connect(statsTimer, SIGNAL(timeout()), this, SLOT(showReplotStats()));
+    connect(statsTimer, SIGNAL(timeout()), this, SLOT(followCapture()));
+    connect(statsTimer, SIGNAL(timeout()), this, SLOT(showReplayPosition()));
+    statsTimer->start(1000);
+
+    // The paint event has to run inside replot() for afterReplot() to mark the samples as displayed
+    undisplayedCycleNs = -1;
+    ui->widget->setPlottingHint(QCP::phImmediateRefresh, true);
+    // Reduce the channels to pixels on all cores, only the painting stays on the GUI thread
+    ui->widget->setPlottingHint(QCP::phConcurrentLines, true);
+    // Only redraw the paint buffers of layers that changed since the last frame
+    ui->widget->setPlottingHint(QCP::phDirtyLayersOnly, true);
+    // Without a GPU the channels are rasterized on all cores, one horizontal tile of the plot each
+    ui->widget->setTiledRendering(true);
+    connect(ui->widget, SIGNAL(afterReplot()), this, SLOT(markDisplayed()));
+    latencyLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(latencyLabel);
+    connect(statsTimer, SIGNAL(timeout()), this, SLOT(showLatency()));
+    recordLabel = new QLabel(this);
+    ui->statusBar->addPermanentWidget(recordLabel);
+    connect(statsTimer, SIGNAL(timeout()), this, SLOT(showRecording()));
+
+    // The cycle timing is shown as two histograms over the same microsecond axis, counts on a log scale to keep the tail visible
+    QCustomPlot *jitterPlot = ui->jitterPlot;
+    cycleStatsTitle = new QCPTextElement(jitterPlot, "Cycle timing");
+    jitterPlot->plotLayout()->insertRow(0);
+    jitterPlot->plotLayout()->addElement(0, 0, cycleStatsTitle);
+    jitterPlot->xAxis->setLabel(QString::fromUtf8("\u00b5s"));
+    jitterPlot->yAxis->setScaleType(QCPAxis::stLogarithmic);
+    jitterPlot->yAxis->setTicker(QSharedPointer<QCPAxisTicker>(new QCPAxisTickerLog));
+    wakeLatencyBars = new QCPBars(jitterPlot->xAxis, jitterPlot->yAxis);
+    wakeLatencyBars->setName("wake-up latency");
+    wakeLatencyBars->setPen(QPen(Qt::blue));
+    wakeLatencyBars->setBrush(QColor(0, 0, 255, 80));
+    executionTimeBars = new QCPBars(jitterPlot->xAxis, jitterPlot->yAxis);
+    executionTimeBars->setName("execution time");
+    executionTimeBars->setPen(QPen(Qt::red));
+    executionTimeBars->setBrush(QColor(255, 0, 0, 80));
+    // Empty bins are left out, so the bars can start below one count on the log axis
+    wakeLatencyBars->setBaseValue(0.5);
+    executionTimeBars->setBaseValue(0.5);
+    jitterPlot->legend->setVisible(true);
+    connect(statsTimer, SIGNAL(timeout()), this, SLOT(showCycleStats()));
+    recordStartNs = 0;
+    lastRecordStatsNs = 0;
+    lastRecordedBytes = 0;
+    droppedRecordsAtStart = 0;
+
+    // The channels get a layer of their own, which the axis rect scrolls along with the time axis so
+    // each frame only draws the newly arrived samples
+    ui->widget->addLayer("strip", ui->widget->layer("main"), QCustomPlot::limAbove);
+    ui->widget->axisRect()->setScrollLayer(ui->widget->layer("strip"));
 }
 
 MainWindow::~MainWindow()
 {
+    o_ecat_thread->setRecording(false);
+    recorder->stop();
+    recorderThread->wait();
+    replayer->abort();
+    replayThread->wait();
     o_ecat_thread->abort();
     thread->wait();
     qDebug()<<"Deleting thread and o_ecat_thread in Thread "<<this->QObject::thread()->currentThreadId();
+    delete recorderThread;
+    delete recorder;
+    delete replayThread;
+    delete replayer;
     delete thread;
     delete o_ecat_thread;
 
     delete ui;
 }
 
+void MainWindow::setMapping(const QVector<CPdoField> &mapping, const QVector<int> &divisors)
+{
+    // Like the placement, the mapping is compiled when the worker starts
+    o_ecat_thread->abort();
+    thread->wait();
+    o_ecat_thread->setMapping(mapping);
+    o_ecat_thread->setDomainDivisors(divisors);
+    updateChannelMenu();
+}
+
+void MainWindow::updateChannelMenu()
+{
+    // One checkable action per mapped field, the running loop starts and stops decoding it
+    ui->menuChannels->clear();
+    const QVector<CPdoField> &mapping = o_ecat_thread->mapping();
+    const quint32 enabled = o_ecat_thread->enabledChannels();
+    for (int ch = 0; ch < mapping.size() && ch < CSampleRecord::MAX_CHANNELS; ++ch) {
+        QAction *action = ui->menuChannels->addAction(mapping.at(ch).name);
+        action->setCheckable(true);
+        action->setChecked(enabled & (1u << ch));
+        action->setData(ch);
+    }
+}
+
+void MainWindow::setRtPlacement(const CRtPlacement &placement)
+{
+    // The worker reads the placement when it starts, stop it so the next start applies the new one
+    o_ecat_thread->abort();
+    thread->wait();
+    o_ecat_thread->setRtPlacement(placement);
+    ui->startButton->setToolTip(QString("Acquisition thread: %1").arg(placement.toString()));
+}
+
 void MainWindow::on_startButton_clicked()
 {
     // To avoid having two threads running simultaneously, the previous thread is aborted.
     o_ecat_thread->abort();
     thread->wait(); // If the thread is not running, this will immediately return.
 
+    // Start the new run on an empty plot
+    stopReplay();
+    closeCapture();
+    resetPlot();
+
     o_ecat_thread->requestWork();
 }
 
@@ -45,5 +206,638 @@ void MainWindow::on_stopButton_clicked()
     // To avoid having two threads running simultaneously, the previous thread is aborted.
     o_ecat_thread->abort();
     thread->wait(); // If the thread is not running, this will immediately return.
+    stopReplay();
+}
+
+void MainWindow::on_frameRateBox_currentIndexChanged(int index)
+{
+    static const int rates[] = { 30, 60, 120 };
+    setFrameRate(rates[qBound(0, index, 2)]);
+}
+
+void MainWindow::on_cycleTimeBox_currentIndexChanged(int index)
+{
+    static const qint64 cycleTimes[] = { 250000, 500000, 1000000, 2000000, 4000000 };
+    const qint64 cycleTimeNs = cycleTimes[qBound(0, index, 4)];
+    if (cycleTimeNs == o_ecat_thread->cycleTime())
+        return;
+
+    // A capture file has a single cycle time, so it is kept until the recording ends
+    if (ui->recordBox->isChecked())
+        ui->statusBar->showMessage("The cycle time cannot change while recording");
+    else if (o_ecat_thread->setCycleTime(cycleTimeNs))
+        return;
+    else
+        ui->statusBar->showMessage("Too many changes pending, the cycle time was not changed");
+
+    // Show the cycle time that stays in effect again
+    const bool blocked = ui->cycleTimeBox->blockSignals(true);
+    for (int i = 0; i < 5; ++i) {
+        if (cycleTimes[i] == o_ecat_thread->cycleTime())
+            ui->cycleTimeBox->setCurrentIndex(i);
+    }
+    ui->cycleTimeBox->blockSignals(blocked);
+}
+
+void MainWindow::setChannelEnabled(QAction *action)
+{
+    if (o_ecat_thread->setChannelEnabled(action->data().toInt(), action->isChecked()))
+        return;
+    ui->statusBar->showMessage("Too many changes pending, the channel was not switched");
+    const bool blocked = action->blockSignals(true);
+    action->setChecked(!action->isChecked());
+    action->blockSignals(blocked);
+}
+
+void MainWindow::on_recordBox_toggled(bool checked)
+{
+    if (!checked) {
+        // Stop feeding the ring first, the recorder then writes what is left and closes the file
+        o_ecat_thread->setRecording(false);
+        recorder->stop();
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, tr("Record capture"), QString(), tr("Captures (*.ecap)"));
+    if (path.isEmpty()) {
+        ui->recordBox->setChecked(false);
+        return;
+    }
+    recorderThread->wait(); // The previous recording may still be writing its backlog
+
+    recordStartNs = CCyclicTimer::nowNs();
+    lastRecordStatsNs = recordStartNs;
+    lastRecordedBytes = 0;
+    droppedRecordsAtStart = o_ecat_thread->droppedRecords();
+    recorder->requestRecording(path);
+    o_ecat_thread->setRecording(true);
+}
+
+void MainWindow::recordingFinished()
+{
+    o_ecat_thread->setRecording(false);
+    ui->recordBox->setChecked(false);
+    // Show the final numbers once and keep them until the next recording
+    showRecording();
+    recordStartNs = 0;
+}
+
+void MainWindow::showRecording()
+{
+    if (recordStartNs == 0)
+        return;
+
+    const qint64 nowNs = CCyclicTimer::nowNs();
+    const quint64 bytes = recorder->bytesWritten();
+    const double rate = double(bytes - lastRecordedBytes) * 1e3 / qMax(nowNs - lastRecordStatsNs, qint64(1));
+    const double average = double(bytes) * 1e3 / qMax(nowNs - recordStartNs, qint64(1));
+    lastRecordStatsNs = nowNs;
+    lastRecordedBytes = bytes;
+
+    // Dropped cycles did not fit into the ring, lost cycles are the NaN rows they left in the file
+    const quint64 dropped = o_ecat_thread->droppedRecords() - droppedRecordsAtStart;
+    recordLabel->setText(QString("%1 %2 MB/s (avg %3), dropped %4, lost %5")
+                         .arg(recorder->isRecording() ? "rec" : "recorded")
+                         .arg(recorder->isRecording() ? rate : 0.0, 0, 'f', 1)
+                         .arg(average, 0, 'f', 1)
+                         .arg(dropped)
+                         .arg(recorder->lostCycles()));
+    recordLabel->setToolTip(QString("%1 cycles written to %2 file(s)\npeak backlog %3 of %4 records")
+                            .arg(recorder->cyclesWritten())
+                            .arg(recorder->fileCount())
+                            .arg(recorder->peakBacklog())
+                            .arg(o_ecat_thread->recordRing()->capacity()));
+}
+
+void MainWindow::on_actionOpenCapture_triggered()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Open capture"), QString(), tr("Captures (*.ecap);;All files (*)"));
+    if (!path.isEmpty())
+        openCapture(path);
+}
+
+void MainWindow::openCapture(const QString &path)
+{
+    o_ecat_thread->abort();
+    thread->wait();
+    stopReplay();
+    disarmTrigger();
+    closeCapture();
+    if (!capture.open(path)) {
+        ui->statusBar->showMessage(capture.errorString());
+        return;
+    }
+
+    // The column containers index their values with int
+    if (capture.cycleCount() > quint64(std::numeric_limits<int>::max())) {
+        ui->statusBar->showMessage(QString("%1 has %2 cycles, at most %3 can be plotted")
+                                   .arg(path).arg(capture.cycleCount()).arg(std::numeric_limits<int>::max()));
+        capture.close();
+        return;
+    }
+
+    // The graphs read the mapped rows in place, every channel is a strided column of the file
+    const int channelCount = capture.channelCount();
+    const int cycles = int(capture.cycleCount());
+    ensureGraphs(channelCount);
+    for (int ch = 0; ch < ui->widget->graphCount(); ++ch) {
+        QCPGraphColumnContainer *column = ui->widget->graph(ch)->columnData().data();
+        column->clear();
+        if (ch >= channelCount)
+            continue;
+        column->setRingCapacity(0);
+        column->setKeys(0, capture.cycleTime() * 1e-9);
+        ui->widget->graph(ch)->setVisible(true);
+        column->setExternalValues(capture.channelValues(ch), cycles, capture.rowSize());
+    }
+    // Start with the first window, so opening only reads what it shows, zooming out reads the rest block by block
+    ui->widget->xAxis->setRange(0, plotWindow);
+    for (int ch = 0; ch < channelCount; ++ch)
+        ui->widget->graph(ch)->rescaleValueAxis(ch > 0, true);
+    ui->widget->replot();
+    ui->statusBar->showMessage(QString("%1: %2 cycles").arg(path).arg(capture.cycleCount()));
+}
+
+void MainWindow::on_actionReplayCapture_triggered()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Replay capture"), QString(), tr("Captures (*.ecap);;All files (*)"));
+    if (!path.isEmpty())
+        openReplay(path);
+}
+
+void MainWindow::openReplay(const QString &path)
+{
+    o_ecat_thread->abort();
+    thread->wait();
+    stopReplay();
+    disarmTrigger();
+    closeCapture();
+    if (!replayer->open(path)) {
+        ui->statusBar->showMessage(replayer->errorString());
+        return;
+    }
+
+    // Records of an earlier replay that were not drained yet belong to the old run
+    while (replayer->sampleRing()->popBulk(drainBuffer.data(), quint32(drainBuffer.size())) > 0)
+        ;
+    resetPlot();
+    sampleSource = replayer->sampleRing();
+    on_replaySpeedBox_currentIndexChanged(ui->replaySpeedBox->currentIndex());
+    ui->replaySlider->setValue(0);
+    ui->replaySlider->setEnabled(true);
+    replayer->requestReplay();
+    ui->statusBar->showMessage(QString("Replaying %1").arg(path));
+}
+
+void MainWindow::stopReplay()
+{
+    replayer->abort();
+    replayThread->wait(); // If the replay is not running, this will immediately return.
+    replayer->close();
+    ui->replaySlider->setEnabled(false);
+    sampleSource = o_ecat_thread->sampleRing();
+}
+
+void MainWindow::on_replaySpeedBox_currentIndexChanged(int index)
+{
+    static const double speeds[] = { 1.0, 10.0, 100.0, 0.0 };
+    replayer->setSpeed(speeds[qBound(0, index, 3)]);
+}
+
+void MainWindow::on_replaySlider_sliderReleased()
+{
+    const QSlider *slider = ui->replaySlider;
+    replayer->seek(qint64(double(replayer->duration()) * slider->value() / qMax(slider->maximum(), 1)));
+    // The replay was over, start it again from the new position
+    if (!replayer->isReplaying() && slider->isEnabled()) {
+        replayThread->wait(); // The thread may still be quitting after the end
+        replayer->requestReplay();
+    }
+}
+
+void MainWindow::showReplayPosition()
+{
+    QSlider *slider = ui->replaySlider;
+    if (!slider->isEnabled() || slider->isSliderDown())
+        return;
+    const qint64 duration = replayer->duration();
+    if (duration > 0)
+        slider->setValue(int(double(replayer->position()) * slider->maximum() / duration));
+}
+
+void MainWindow::on_actionArmTrigger_triggered()
+{
+    CTriggerDialog dialog(this);
+    dialog.setConfig(triggerConfig);
+    dialog.setSingleShot(triggerSingleShot);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    triggerConfig = dialog.config();
+    triggerSingleShot = dialog.isSingleShot();
+
+    // The window buffers are allocated here, the cycle loop only swaps the pointer
+    CTrigger *trigger = new CTrigger(triggerConfig);
+    if (!o_ecat_thread->armTrigger(trigger)) {
+        delete trigger;
+        ui->statusBar->showMessage("Too many trigger requests pending");
+        return;
+    }
+    if (!triggerMode) {
+        stopReplay();
+        closeCapture();
+        triggerMode = true;
+    }
+    ui->statusBar->showMessage(QString("Trigger armed on channel %1").arg(triggerConfig.channel));
+}
+
+void MainWindow::on_actionDisarmTrigger_triggered()
+{
+    disarmTrigger();
+}
+
+void MainWindow::disarmTrigger()
+{
+    if (!triggerMode)
+        return;
+    o_ecat_thread->armTrigger(0);
+    triggerMode = false;
+    // The strip restarts with the next drained samples
+    resetPlot();
+}
+
+void MainWindow::drainTriggers()
+{
+    // Only the newest window is worth plotting, older ones were already outdated on arrival
+    CTrigger *newest = 0;
+    CTrigger *trigger;
+    while (o_ecat_thread->triggerResults()->pop(trigger)) {
+        if (trigger->state() == CTrigger::Done && triggerMode) {
+            delete newest;
+            newest = trigger;
+        } else {
+            delete trigger;
+        }
+    }
+    if (!newest)
+        return;
+
+    showTriggerWindow(newest);
+    // A single shot window stays on screen until the trigger is armed again or disarmed
+    if (triggerSingleShot) {
+        delete newest;
+        return;
+    }
+    newest->rearm();
+    if (!o_ecat_thread->armTrigger(newest))
+        delete newest;
+}
+
+void MainWindow::showTriggerWindow(const CTrigger *trigger)
+{
+    const int channelCount = int(trigger->at(0).channelCount);
+    ensureGraphs(channelCount);
+
+    // Transpose the window like a drained batch, the keys are cycles relative to the trigger
+    for (int ch = 0; ch < channelCount; ++ch)
+        frameValues[ch].clear();
+    for (int i = 0; i < trigger->size(); ++i) {
+        const CSampleRecord &record = trigger->at(i);
+        for (int ch = 0; ch < channelCount; ++ch)
+            frameValues[ch].append(float(record.values[ch]));
+    }
+    double step = o_ecat_thread->cycleTime() * 1e-9;
+    // With distributed clocks the cycles of the window are spaced by their DC period
+    if (dcMapping.isSettled())
+        step *= dcMapping.rate();
+    for (int ch = 0; ch < ui->widget->graphCount(); ++ch) {
+        QCPGraphColumnContainer *column = ui->widget->graph(ch)->columnData().data();
+        column->clear();
+        column->setRingCapacity(0);
+        column->setKeys(-trigger->triggerIndex() * step, step);
+    }
+    appendFrame(channelCount);
+
+    ui->widget->xAxis->setRange(-trigger->triggerIndex() * step, (trigger->size() - 1 - trigger->triggerIndex()) * step);
+    for (int ch = 0; ch < channelCount; ++ch)
+        ui->widget->graph(ch)->rescaleValueAxis(ch > 0, true);
+    ui->widget->replot(QCustomPlot::rpQueuedReplot);
+    ui->statusBar->showMessage(QString("Triggered at cycle %1").arg(trigger->triggerCycle()));
+}
+
+void MainWindow::closeCapture()
+{
+    if (!capture.isMapped())
+        return;
+    for (int i = 0; i < ui->widget->graphCount(); ++i) {
+        if (ui->widget->graph(i)->columnData()->isExternal())
+            ui->widget->graph(i)->columnData()->clear();
+    }
+    capture.close();
+}
+
+void MainWindow::followCapture()
+{
+    if (!capture.isMapped() || !capture.refresh())
+        return;
+
+    // refresh() released the old mapping, so the graphs are moved to the new one before the next replot
+    const int cycles = int(qMin(capture.cycleCount(), quint64(std::numeric_limits<int>::max())));
+    if (quint64(cycles) < capture.cycleCount())
+        ui->statusBar->showMessage(QString("Only the first %1 cycles of the capture are plotted").arg(cycles));
+    for (int ch = 0; ch < capture.channelCount(); ++ch)
+        ui->widget->graph(ch)->columnData()->extendExternalValues(capture.channelValues(ch), cycles);
+    ui->widget->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void MainWindow::resetPlot()
+{
+    for (int i = 0; i < ui->widget->graphCount(); ++i)
+        ui->widget->graph(i)->columnData()->clear();
+    plotTimeOrigin = -1;
+    plotChannelMask = ~0u;
+    dcMapping.reset();
+    latency.clear();
+    undisplayedCycleNs = -1;
+}
+
+void MainWindow::restartPlot(const CSampleRecord &record, int channelCount)
+{
+    plotTimeOrigin = record.timestampNs;
+    plotCycleOrigin = record.cycle;
+    plotDcOrigin = dcMapping.isSettled() ? dcMapping.map(record.timestampNs) : 0;
+    plotCycleTimeNs = record.cycleTimeNs;
+    cycleStep = record.cycleTimeNs * 1e-9;
+    // Every channel runs on the time base of its domain, replayed captures hold all channels in every cycle
+    const bool live = sampleSource == o_ecat_thread->sampleRing();
+    for (int ch = 0; ch < channelCount; ++ch) {
+        const int domain = live ? o_ecat_thread->channelDomain(ch) : 0;
+        const quint64 divisor = quint64(live ? o_ecat_thread->domainDivisor(domain) : 1);
+        channelDivisors[ch] = int(divisor);
+        channelDomainMasks[ch] = live ? 1u << domain : ~0u;
+        // A slow domain is due in the cycles that are multiples of its divisor
+        nextCycles[ch] = (plotCycleOrigin + divisor - 1) / divisor * divisor;
+
+        // Keep only the visible window, evicting old samples in O(1) as new ones arrive
+        QCPGraphColumnContainer *column = ui->widget->graph(ch)->columnData().data();
+        column->clear();
+        column->setKeys(cycleKey(nextCycles.at(ch)), channelKeyStep(ch));
+        column->setRingCapacity(qCeil(plotWindow / channelKeyStep(ch)) + 1);
+    }
+}
+
+void MainWindow::setFrameRate(int hz)
+{
+    drainTimer->start(1000 / qMax(hz, 1));
+}
+
+void MainWindow::ensureGraphs(int channelCount)
+{
+    static const QColor colors[] = { Qt::blue, Qt::red, Qt::darkGreen, Qt::magenta, Qt::darkCyan, Qt::darkYellow, Qt::black, Qt::gray };
+
+    while (ui->widget->graphCount() < channelCount) {
+        QCPGraph *graph = ui->widget->addGraph();
+        graph->setPen(QPen(colors[(ui->widget->graphCount() - 1) % 8]));
+        graph->setLayer("strip");
+        // Samples arrive on the cycle grid, so the keys are implicit and each sample takes 4 bytes
+        graph->setColumnData(QSharedPointer<QCPGraphColumnContainer>(new QCPGraphColumnContainer(QCPGraphColumnContainer::vtFloat32)));
+    }
+    if (frameValues.size() < channelCount) {
+        frameValues.resize(channelCount);
+        nextCycles.resize(channelCount);
+        channelDivisors.resize(channelCount);
+        channelDomainMasks.resize(channelCount);
+    }
+}
+
+void MainWindow::appendFrame(int channelCount)
+{
+    for (int ch = 0; ch < channelCount; ++ch) {
+        ui->widget->graph(ch)->columnData()->add(frameValues.at(ch).constData(), frameValues.at(ch).size());
+        frameValues[ch].clear();
+    }
+}
+
+void MainWindow::skipCycles(int channel, quint64 cycle)
+{
+    QCPGraphColumnContainer *column = ui->widget->graph(channel)->columnData().data();
+    QVector<float> &values = frameValues[channel];
+    const quint64 divisor = quint64(channelDivisors.at(channel));
+    if (cycle > nextCycles.at(channel)) {
+        const quint64 missing = (cycle - nextCycles.at(channel)) / divisor;
+        if (missing < quint64(column->ringCapacity())) {
+            // Lost samples become NaN gaps, which keeps the following ones on the grid of the channel
+            values.insert(values.end(), int(missing), std::numeric_limits<float>::quiet_NaN());
+            return;
+        }
+    }
+
+    // More than the whole window was lost or a replay jumped back, restart the column at the cycle
+    values.clear();
+    column->clear();
+    column->setKeys(cycleKey(cycle), channelKeyStep(channel));
+}
+
+double MainWindow::cycleKey(quint64 cycle) const
+{
+    if (plotDcOrigin == 0)
+        return double(qint64(cycle - plotCycleOrigin)) * cycleStep;
+    const qint64 deadlineNs = plotTimeOrigin + qint64(cycle - plotCycleOrigin) * plotCycleTimeNs;
+    return double(dcMapping.map(deadlineNs) - plotDcOrigin) * 1e-9;
+}
+
+double MainWindow::channelKeyStep(int channel) const
+{
+    const double step = plotDcOrigin != 0 ? dcMapping.rate() * cycleStep : cycleStep;
+    return channelDivisors.at(channel) * step;
+}
+
+void MainWindow::drainSamples()
+{
+    // Keep the newest DC mapping, the ring refills with the following cycles
+    while (o_ecat_thread->dcMappings()->pop(dcMapping))
+        ;
+
+    const quint32 count = sampleSource->popBulk(drainBuffer.data(), quint32(drainBuffer.size()));
+    if (count == 0)
+        return;
+    if (triggerMode) {
+        // The plot shows the trigger windows, which the cycle loop captures from every cycle, and
+        // the recorder has a ring of its own. The drained samples are only dropped here so the
+        // sample ring doesn't overflow and count them as lost. The strip starts over on disarm.
+        ui->label->setText(QString::number(drainBuffer.at(int(count) - 1).cycle));
+        return;
+    }
+    const qint64 drainedNs = CCyclicTimer::nowNs();
+
+    const bool firstFrame = plotTimeOrigin < 0;
+    const int channelCount = int(drainBuffer.at(0).channelCount);
+    ensureGraphs(channelCount);
+    if (firstFrame)
+        restartPlot(drainBuffer.at(0), channelCount);
+
+    // Transpose the batch of cycle records into one value column per channel, taking only the
+    // cycles in which the domain of the channel was exchanged
+    for (int ch = 0; ch < channelCount; ++ch)
+        frameValues[ch].clear();
+    qint64 publishLatency = 0;
+    for (quint32 i = 0; i < count; ++i) {
+        const CSampleRecord &record = drainBuffer.at(int(i));
+        // The keys of a new cycle time do not continue the old grid, the plot starts over with this cycle
+        if (record.cycleTimeNs != plotCycleTimeNs) {
+            for (int ch = 0; ch < channelCount; ++ch)
+                frameValues[ch].clear();
+            restartPlot(record, channelCount);
+        }
+        for (int ch = 0; ch < channelCount; ++ch) {
+            if (!(record.domainMask & channelDomainMasks.at(ch)) || !(record.channelMask & (1u << ch)))
+                continue;
+            if (record.cycle != nextCycles.at(ch))
+                skipCycles(ch, record.cycle);
+            frameValues[ch].append(float(record.values[ch]));
+            nextCycles[ch] = record.cycle + quint64(channelDivisors.at(ch));
+        }
+        publishLatency = qMax(publishLatency, record.publishNs - record.timestampNs);
+    }
+
+    // One bulk append per channel, the keys follow from the grid of each channel
+    appendFrame(channelCount);
+    // Disabled channels stop growing and are hidden, enabling them again continues after a gap
+    const quint32 channelMask = drainBuffer.at(int(count) - 1).channelMask;
+    if (channelMask != plotChannelMask) {
+        for (int ch = 0; ch < channelCount; ++ch)
+            ui->widget->graph(ch)->setVisible(channelMask & (1u << ch));
+        plotChannelMask = channelMask;
+    }
+    // Once the mapping of the acquisition thread has settled the keys are DC times, the first sample of the run stays at 0
+    if (plotDcOrigin == 0 && dcMapping.isSettled())
+        plotDcOrigin = dcMapping.map(plotTimeOrigin);
+    // Columns are only re-keyed if the fit moved their newest sample by more than half a pixel
+    const double keyTolerance = 0.5 * plotWindow / qMax(ui->widget->axisRect()->width(), 1);
+    double lastKey = -std::numeric_limits<double>::max();
+    for (int ch = 0; ch < channelCount; ++ch) {
+        QCPGraphColumnContainer *column = ui->widget->graph(ch)->columnData().data();
+        if (column->isEmpty())
+            continue;
+        const double key = cycleKey(nextCycles.at(ch) - quint64(channelDivisors.at(ch)));
+        if (plotDcOrigin != 0 && qAbs(key - column->key(column->size() - 1)) > keyTolerance) {
+            // New keys change the revision of the column, which discards the scrolled image of the strip layer
+            const double step = channelKeyStep(ch);
+            column->setKeys(key - (double(column->removedFrontCount()) + column->size() - 1) * step, step);
+        }
+        lastKey = qMax(lastKey, column->key(column->size() - 1));
+    }
+    if (lastKey > -std::numeric_limits<double>::max())
+        ui->widget->xAxis->setRange(lastKey - plotWindow, lastKey);
+    for (int ch = 0; ch < channelCount; ++ch) {
+        // Only growing the value range keeps the scrolled image of the strip layer reusable
+        ui->widget->graph(ch)->rescaleValueAxis(ch > 0 || !firstFrame, true);
+    }
+
+    // The batch is ordered by cycle, so its first record is the one that has waited longest
+    const qint64 oldestCycleNs = drainBuffer.at(0).timestampNs;
+    latency.add(CLatencyStats::Published, publishLatency);
+    latency.add(CLatencyStats::Drained, drainedNs - oldestCycleNs);
+    latency.add(CLatencyStats::Appended, CCyclicTimer::nowNs() - oldestCycleNs);
+    if (undisplayedCycleNs < 0)
+        undisplayedCycleNs = oldestCycleNs;
+    ui->widget->replot(QCustomPlot::rpQueuedReplot);
+
+    ui->label->setText(QString::number(drainBuffer.at(int(count) - 1).cycle));
+}
+
+void MainWindow::showCycleStats()
+{
+    const CHdrHistogram &wake = o_ecat_thread->wakeLatency();
+    const CHdrHistogram &execution = o_ecat_thread->executionTime();
+    if (wake.count() == 0 && execution.count() == 0)
+        return;
+
+    // Cover the p99.9 of both with uniform bins, the rare outliers beyond pile up in the last one
+    static const int binCount = 64;
+    const qint64 range = qMax(qMax(wake.percentile(0.999), execution.percentile(0.999)) * 5 / 4, qint64(10000));
+    const qint64 binWidth = (range + binCount - 1) / binCount;
+    QCPBars *bars[] = { wakeLatencyBars, executionTimeBars };
+    const CHdrHistogram *histograms[] = { &wake, &execution };
+    double maxCount = 1;
+    for (int i = 0; i < 2; ++i) {
+        const QVector<double> bins = histograms[i]->histogram(binWidth, binCount);
+        QVector<double> keys, values;
+        for (int bin = 0; bin < bins.size(); ++bin) {
+            if (bins.at(bin) == 0)
+                continue;
+            keys.append((bin + 0.5) * binWidth * 1e-3);
+            values.append(bins.at(bin));
+            maxCount = qMax(maxCount, bins.at(bin));
+        }
+        bars[i]->setWidth(binWidth * 1e-3);
+        bars[i]->setData(keys, values, true);
+    }
+    ui->jitterPlot->xAxis->setRange(0, binCount * binWidth * 1e-3);
+    ui->jitterPlot->yAxis->setRange(0.5, maxCount * 2);
+
+    cycleStatsTitle->setText(QString::fromUtf8("wake-up p50/p99/max %1/%2/%3 \u00b5s, execution p99/max %4/%5 \u00b5s, missed %6 of %7 cycles")
+                             .arg(wake.percentile(0.5) * 1e-3, 0, 'f', 1)
+                             .arg(wake.percentile(0.99) * 1e-3, 0, 'f', 1)
+                             .arg(wake.maximum() * 1e-3, 0, 'f', 1)
+                             .arg(execution.percentile(0.99) * 1e-3, 0, 'f', 1)
+                             .arg(execution.maximum() * 1e-3, 0, 'f', 1)
+                             .arg(o_ecat_thread->missedDeadlines())
+                             .arg(execution.count())
+                             + (dcMapping.isValid() ? QString(", DC drift %1 ppm").arg((dcMapping.rate() - 1.0) * 1e6, 0, 'f', 2)
+                                                    : QString()));
+    ui->jitterPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+void MainWindow::showReplotStats()
+{
+    const QCPReplotStats &stats = ui->widget->replotStats();
+    if (stats.replotCount == 0)
+        return;
+
+    // Name the most expensive layer, that is where tuning the channel count or styles pays off
+    QCPReplotStats::Timing slowest;
+    foreach (const QCPReplotStats::Timing &layer, stats.layerTimes) {
+        if (layer.nanoseconds > slowest.nanoseconds)
+            slowest = layer;
+    }
+    replotStatsLabel->setText(QString("replot %1 ms (p99 %2 ms, layout %3, %4 %5, paint %6)")
+                              .arg(stats.replotTime * 1e-6, 0, 'f', 2)
+                              .arg(stats.percentile(0.99) * 1e-6, 0, 'f', 2)
+                              .arg(stats.updateLayoutTime * 1e-6, 0, 'f', 2)
+                              .arg(slowest.name)
+                              .arg(slowest.nanoseconds * 1e-6, 0, 'f', 2)
+                              .arg(stats.paintEventTime * 1e-6, 0, 'f', 2));
+}
+
+void MainWindow::markDisplayed()
+{
+    if (undisplayedCycleNs < 0)
+        return;
+
+    // replot() has repainted the widget before emitting afterReplot(), the paint event was the last step
+    const qint64 paintedNs = CCyclicTimer::nowNs();
+    const qint64 replottedNs = paintedNs - ui->widget->replotStats().paintEventTime;
+    latency.add(CLatencyStats::Replotted, replottedNs - undisplayedCycleNs);
+    latency.add(CLatencyStats::Painted, paintedNs - undisplayedCycleNs);
+    undisplayedCycleNs = -1;
+}
+
+void MainWindow::showLatency()
+{
+    if (latency.count(CLatencyStats::Painted) == 0)
+        return;
+
+    latencyLabel->setText(QString("latency p50 %1 ms, p99 %2 ms, max %3 ms")
+                          .arg(latency.percentile(CLatencyStats::Painted, 0.5) * 1e-6, 0, 'f', 2)
+                          .arg(latency.percentile(CLatencyStats::Painted, 0.99) * 1e-6, 0, 'f', 2)
+                          .arg(latency.maximum(CLatencyStats::Painted) * 1e-6, 0, 'f', 2));
 
+    // Break the p99 down along the path so the dominating stage is visible
+    QStringList stages;
+    for (int i = 0; i < CLatencyStats::STAGE_COUNT; ++i) {
+        const CLatencyStats::Stage stage = CLatencyStats::Stage(i);
+        stages << QString("%1: p99 %2 ms").arg(CLatencyStats::stageName(stage))
+                                          .arg(latency.percentile(stage, 0.99) * 1e-6, 0, 'f', 2);
+    }
+    latencyLabel->setToolTip(stages.join("\n"));
 }
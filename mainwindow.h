@@ -1,13 +1,24 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#include <QLabel>
 #include <QMainWindow>
 #include <QThread>
+#include <QTimer>
+#include <QVector>
+#include "ccapturefile.h"
+#include "ccapturerecorder.h"
+#include "ccapturereplayer.h"
+#include "cclockmapping.h"
 #include "cethercatthread.h"
+#include "clatencystats.h"
+#include "ctrigger.h"
 
 namespace Ui {
 class MainWindow;
 }
+class QCPBars;
+class QCPTextElement;
 
 class MainWindow : public QMainWindow
 {
@@ -17,6 +28,15 @@ public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
+    /**
+     * @brief Stops the acquisition and sets the placement its thread applies at the next start
+     */
+    void setRtPlacement(const CRtPlacement &placement);
+    /**
+     * @brief Stops the acquisition and sets the PDO mapping and domain divisors of the next start
+     */
+    void setMapping(const QVector<CPdoField> &mapping, const QVector<int> &divisors);
+
 private:
     Ui::MainWindow *ui;
     /**
@@ -27,10 +47,286 @@ private:
      * @brief Object which contains methods that should be runned in another thread
      */
     CEthercatThread *o_ecat_thread;
+    /**
+     * @brief Thread the recorder writes the capture file on
+     */
+    QThread *recorderThread;
+    /**
+     * @brief Drains the record ring of #o_ecat_thread to disk
+     */
+    CCaptureRecorder *recorder;
+    /**
+     * @brief Thread the replayer reads the capture file on
+     */
+    QThread *replayThread;
+    /**
+     * @brief Plays a capture file back through the same display path as the bus
+     */
+    CCaptureReplayer *replayer;
+    /**
+     * @brief Ring drainSamples() pulls from, the one of #o_ecat_thread or of #replayer
+     */
+    CSpscRing<CSampleRecord> *sampleSource;
+    /**
+     * @brief Periodically drains #sampleSource
+     */
+    QTimer *drainTimer;
+    /**
+     * @brief Refreshes #replotStatsLabel once per second
+     */
+    QTimer *statsTimer;
+    /**
+     * @brief Permanent status bar field showing where the replot time goes
+     */
+    QLabel *replotStatsLabel;
+    /**
+     * @brief Permanent status bar field showing the cycle-to-screen latency
+     */
+    QLabel *latencyLabel;
+    /**
+     * @brief Permanent status bar field showing the write rate and losses of the recording
+     */
+    QLabel *recordLabel;
+    /**
+     * @brief Histograms of the wake-up latency and execution time of the acquisition cycles
+     */
+    QCPBars *wakeLatencyBars;
+    QCPBars *executionTimeBars;
+    /**
+     * @brief Summary counters of the cycle timing above #wakeLatencyBars
+     */
+    QCPTextElement *cycleStatsTitle;
+    /**
+     * @brief Monotonic time the current recording was started
+     */
+    qint64 recordStartNs;
+    /**
+     * @brief Monotonic time and byte count of the last showRecording() call
+     */
+    qint64 lastRecordStatsNs;
+    quint64 lastRecordedBytes;
+    /**
+     * @brief CEthercatThread::droppedRecords() when the current recording was started
+     */
+    quint64 droppedRecordsAtStart;
+    /**
+     * @brief Age of the samples at each checkpoint of the display path
+     */
+    CLatencyStats latency;
+    /**
+     * @brief Cycle time of the oldest sample appended but not painted yet, -1 if none
+     */
+    qint64 undisplayedCycleNs;
+    /**
+     * @brief Preallocated destination for CSpscRing::popBulk()
+     */
+    QVector<CSampleRecord> drainBuffer;
+    /**
+     * @brief Per-frame value columns, one per channel, reused between frames
+     */
+    QVector<QVector<float> > frameValues;
+    /**
+     * @brief Monotonic time of the first sample of the run, keys are seconds since then
+     */
+    qint64 plotTimeOrigin;
+    /**
+     * @brief Cycle counter of the first sample of the run, it has the key 0
+     */
+    quint64 plotCycleOrigin;
+    /**
+     * @brief Distributed-clock time of the first sample of the run, 0 while the keys are on the host cycle grid
+     */
+    qint64 plotDcOrigin;
+    /**
+     * @brief Latest mapping from CLOCK_MONOTONIC to DC time of the acquisition thread, it places the samples on the key axis
+     */
+    CClockMapping dcMapping;
+    /**
+     * @brief Cycle counter the next drained sample of each channel is expected to have
+     */
+    QVector<quint64> nextCycles;
+    /**
+     * @brief Cycles between two samples of each channel, the divisor of its domain
+     */
+    QVector<int> channelDivisors;
+    /**
+     * @brief Bit of the domain of each channel in CSampleRecord::domainMask
+     */
+    QVector<quint32> channelDomainMasks;
+    /**
+     * @brief Key distance of two consecutive cycles, in seconds
+     */
+    double cycleStep;
+    /**
+     * @brief CSampleRecord::cycleTimeNs the keys were laid out for, a record with another one restarts the plot
+     */
+    qint64 plotCycleTimeNs;
+    /**
+     * @brief Channels whose graphs are shown, the CSampleRecord::channelMask of the newest drained record
+     */
+    quint32 plotChannelMask;
+    /**
+     * @brief Width of the scrolling time window shown on the key axis, in seconds
+     */
+    double plotWindow;
+    /**
+     * @brief Recording shown instead of the live bus, mapped rather than loaded
+     */
+    CCaptureFile capture;
+    /**
+     * @brief Condition of the oscilloscope trigger, kept for the next time the dialog opens
+     */
+    CTriggerConfig triggerConfig;
+    /**
+     * @brief Stop after the first captured window instead of rearming
+     */
+    bool triggerSingleShot;
+    /**
+     * @brief The plot shows the windows captured by the trigger instead of the scrolling strip
+     *
+     * The strip is not fed meanwhile, drainSamples() discards the drained
+     * records and disarmTrigger() restarts the strip.
+     */
+    bool triggerMode;
+
+    /**
+     * @brief Sets the display frame rate the drain and replot are paced at
+     */
+    void setFrameRate(int hz);
+    /**
+     * @brief Fills the channel menu with one checkable action per field of the mapping
+     */
+    void updateChannelMenu();
+    /**
+     * @brief Creates graphs until the plot has one per channel
+     */
+    void ensureGraphs(int channelCount);
+    /**
+     * @brief Appends #frameValues to the column data of the graphs and empties it
+     */
+    void appendFrame(int channelCount);
+    /**
+     * @brief Bridges a jump of the cycle counter to @p cycle in the column data of @p channel
+     *
+     * Short gaps are padded with NaN, after longer ones or a jump back the column restarts at @p cycle.
+     */
+    void skipCycles(int channel, quint64 cycle);
+    /**
+     * @brief Key of the samples of @p cycle, in seconds
+     *
+     * On a bus with distributed clocks this is the DC time #dcMapping gives
+     * the deadline of the cycle, relative to #plotDcOrigin. Otherwise it is
+     * the cycle relative to #plotCycleOrigin on the nominal grid.
+     */
+    double cycleKey(quint64 cycle) const;
+    /**
+     * @brief Key distance of two consecutive samples of @p channel, in seconds
+     */
+    double channelKeyStep(int channel) const;
+    /**
+     * @brief Stops the acquisition and plots the capture file at @p path
+     */
+    void openCapture(const QString &path);
+    /**
+     * @brief Detaches the graphs from #capture and closes it
+     */
+    void closeCapture();
+    /**
+     * @brief Stops the acquisition and replays the capture file at @p path through drainSamples()
+     */
+    void openReplay(const QString &path);
+    /**
+     * @brief Stops a running replay and switches drainSamples() back to #o_ecat_thread
+     */
+    void stopReplay();
+    /**
+     * @brief Empties the plot for a new run of samples
+     */
+    void resetPlot();
+    /**
+     * @brief Lays out empty columns for @p channelCount channels, starting with the cycle of @p record
+     *
+     * Called with the first drained record of a run and whenever the cycle time changes.
+     */
+    void restartPlot(const CSampleRecord &record, int channelCount);
+    /**
+     * @brief Plots the window captured by @p trigger with the trigger cycle at key 0
+     */
+    void showTriggerWindow(const CTrigger *trigger);
+    /**
+     * @brief Disarms the trigger and returns the plot to the scrolling strip
+     */
+    void disarmTrigger();
 
 private slots:
     void on_startButton_clicked();
     void on_stopButton_clicked();
+    void on_frameRateBox_currentIndexChanged(int index);
+    void on_actionOpenCapture_triggered();
+    void on_actionReplayCapture_triggered();
+    void on_replaySpeedBox_currentIndexChanged(int index);
+    /**
+     * @brief Switches the running bus to the chosen cycle time, refused while recording
+     */
+    void on_cycleTimeBox_currentIndexChanged(int index);
+    /**
+     * @brief Starts or stops decoding the channel of a checkable action of the Channels menu
+     */
+    void setChannelEnabled(QAction *action);
+    /**
+     * @brief Continues the replay at the position the slider was dropped at
+     */
+    void on_replaySlider_sliderReleased();
+    /**
+     * @brief Moves the replay slider along with the replay, unless the user holds it
+     */
+    void showReplayPosition();
+    void on_actionArmTrigger_triggered();
+    void on_actionDisarmTrigger_triggered();
+    /**
+     * @brief Collects the triggers handed back by the acquisition thread once per display frame
+     *
+     * Plots the newest completed window and rearms the trigger unless it is single shot.
+     */
+    void drainTriggers();
+    /**
+     * @brief Starts recording into a file chosen by the user, or stops the recording
+     */
+    void on_recordBox_toggled(bool checked);
+    /**
+     * @brief Unchecks the record box once the recorder has stopped, also after a write error
+     */
+    void recordingFinished();
+    /**
+     * @brief Shows the sustained write rate and the dropped cycles of the recording
+     */
+    void showRecording();
+    /**
+     * @brief Extends the plotted capture by the rows a recorder appended since the last call
+     */
+    void followCapture();
+    /**
+     * @brief Pulls all pending samples from #sampleSource once per display frame
+     *
+     * Appends them with one QCPGraphColumnContainer::add() call per channel and queues a single replot.
+     */
+    void drainSamples();
+    /**
+     * @brief Shows the replot timing of the plot collected by QCustomPlot::setReplotTiming()
+     */
+    void showReplotStats();
+    /**
+     * @brief Shows the wake-up latency, execution time and missed deadlines of the acquisition cycles
+     */
+    void showCycleStats();
+    /**
+     * @brief Shows the distribution of the cycle-to-screen latency
+     */
+    void showLatency();
+    /**
+     * @brief Records the latency of the samples that the last replot put on screen
+     */
+    void markDisplayed();
 };
 
 #endif // MAINWINDOW_H
@@ -25,6 +25,15 @@
 
 #include "qcustomplot.h"
 
+#include <QtCore/QThread>
+#ifdef QCUSTOMPLOT_USE_CONCURRENT
+#  include <QtConcurrent/QtConcurrentMap>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define QCP_SIMD_X86
+#  include <immintrin.h>
+#endif
+
 
 /* including file 'src/vector2d.cpp', size 7340                              */
 /* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
@@ -499,9 +508,11 @@ void QCPPainter::makeNonCosmetic()
   previous frame.
 
   The simplest paint buffer implementation is \ref QCPPaintBufferPixmap which allows regular
-  software rendering via the raster engine. Hardware accelerated rendering via pixel buffers and
-  frame buffer objects is provided by \ref QCPPaintBufferGlPbuffer and \ref QCPPaintBufferGlFbo.
-  They are used automatically if \ref QCustomPlot::setOpenGl is enabled.
+  software rendering via the raster engine. \ref QCPPaintBufferImage splits the buffer into tiles
+  which are rendered concurrently, it is used if \ref QCustomPlot::setTiledRendering is enabled.
+  Hardware accelerated rendering via pixel buffers and frame buffer objects is provided by \ref
+  QCPPaintBufferGlPbuffer and \ref QCPPaintBufferGlFbo. They are used automatically if \ref
+  QCustomPlot::setOpenGl is enabled.
 */
 
 /* start documentation of pure virtual functions */
@@ -582,7 +593,8 @@ QCPAbstractPaintBuffer::~QCPAbstractPaintBuffer()
   Sets the paint buffer size.
 
   The buffer is reallocated (by calling \ref reallocateBuffer), so any painters that were obtained
-  by \ref startPainting are invalidated and must not be used after calling this method.
+  by \ref startPainting are invalidated and must not be used after calling this method. Since the
+  buffer contents are lost, the buffer is also marked invalidated (\ref setInvalidated).
 
   If \a size is already the current buffer size, this method does nothing.
 */
@@ -592,6 +604,7 @@ void QCPAbstractPaintBuffer::setSize(const QSize &size)
   {
     mSize = size;
     reallocateBuffer();
+    setInvalidated();
   }
 }
 
@@ -605,8 +618,10 @@ void QCPAbstractPaintBuffer::setSize(const QSize &size)
   replots them, instead of only the layer on which the replot was called.
 
   The invalidated flag is set to true when \ref QCPLayer association has changed, i.e. if layers
-  were added or removed from this buffer, or if they were reordered. It is set to false as soon as
-  all associated \ref QCPLayer instances are drawn onto the buffer.
+  were added or removed from this buffer, or if they were reordered, and when the buffer was
+  reallocated. It is set to false as soon as all associated \ref QCPLayer instances are drawn onto
+  the buffer. With the plotting hint \ref QCP::phDirtyLayersOnly, \ref QCustomPlot::replot only
+  redraws invalidated buffers.
 
   Under normal circumstances, it is not necessary to manually call this method.
 */
@@ -631,6 +646,7 @@ void QCPAbstractPaintBuffer::setDevicePixelRatio(double ratio)
 #ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
     mDevicePixelRatio = ratio;
     reallocateBuffer();
+    setInvalidated();
 #else
     qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
     mDevicePixelRatio = 1.0;
@@ -638,6 +654,69 @@ void QCPAbstractPaintBuffer::setDevicePixelRatio(double ratio)
   }
 }
 
+/*!
+  Moves the contents of the buffer inside \a rect by \a dx pixels horizontally and \a dy pixels
+  vertically, both given in logical (device independent) pixels. The area of \a rect that is
+  exposed by the move keeps undefined contents, it must be redrawn by the caller.
+
+  Returns false if the buffer doesn't support scrolling, in which case the contents are unchanged
+  and the caller must redraw all of \a rect. The base implementation always returns false.
+
+  This is used by \ref QCPAxisRect::setScrollLayer to reuse the image of a scrolling plot.
+*/
+bool QCPAbstractPaintBuffer::scroll(int dx, int dy, const QRect &rect)
+{
+  Q_UNUSED(dx)
+  Q_UNUSED(dy)
+  Q_UNUSED(rect)
+  return false;
+}
+
+/*!
+  Returns the number of tiles this buffer is split into. Each tile can be painted with a painter of
+  its own (see \ref startTilePainting), so the tiles can be rendered concurrently on different
+  threads.
+
+  The base implementation returns 1, meaning the buffer is only painted as a whole via \ref
+  startPainting.
+
+  \see tileRect
+*/
+int QCPAbstractPaintBuffer::tileCount() const
+{
+  return 1;
+}
+
+/*!
+  Returns the area of the tile with the given \a index, in logical (device independent) pixels.
+
+  The base implementation returns the entire buffer.
+
+  \see tileCount, startTilePainting
+*/
+QRect QCPAbstractPaintBuffer::tileRect(int index) const
+{
+  Q_UNUSED(index)
+  return QRect(QPoint(0, 0), mSize);
+}
+
+/*!
+  Returns a \ref QCPPainter which draws onto the tile with the given \a index. Its coordinates are
+  those of the entire buffer, drawing outside of \ref tileRect has no effect as long as the
+  painter's clip rect is set within the tile. The ownership of the painter is given to the caller.
+
+  Painters of different tiles may be used concurrently on different threads, also while a painter
+  acquired with \ref startPainting is active but not in use. The base implementation doesn't
+  support tiles and returns 0.
+
+  \see tileCount
+*/
+QCPPainter *QCPAbstractPaintBuffer::startTilePainting(int index)
+{
+  Q_UNUSED(index)
+  return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferPixmap
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -686,6 +765,17 @@ void QCPPaintBufferPixmap::clear(const QColor &color)
   mBuffer.fill(color);
 }
 
+/* inherits documentation from base class */
+bool QCPPaintBufferPixmap::scroll(int dx, int dy, const QRect &rect)
+{
+  // QPixmap::scroll works on device pixels, a fractional ratio would smear the contents:
+  const int ratio = qRound(mDevicePixelRatio);
+  if (!qFuzzyCompare(mDevicePixelRatio, (double)ratio))
+    return false;
+  mBuffer.scroll(dx*ratio, dy*ratio, QRect(rect.topLeft()*ratio, rect.size()*ratio));
+  return true;
+}
+
 /* inherits documentation from base class */
 void QCPPaintBufferPixmap::reallocateBuffer()
 {
@@ -707,6 +797,151 @@ void QCPPaintBufferPixmap::reallocateBuffer()
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering on multiple threads
+
+  This paint buffer renders into a QImage of format \c QImage::Format_ARGB32_Premultiplied. The
+  image is split into horizontal tiles (see \ref tileCount), and each tile can be painted by its
+  own thread with its own \ref QCPPainter (see \ref startTilePainting). \ref QCPLayer uses this to
+  rasterize plottables on all CPU cores, which speeds up large plots on machines without a GPU.
+
+  Horizontal tiles are contiguous ranges of scan lines, so the tile images share the memory of the
+  buffer image and don't need to be joined after painting.
+
+  It is used if \ref QCustomPlot::setTiledRendering is enabled.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable. The buffer is split into \a tiles tiles, or into as many tiles as there are CPU
+  cores if \a tiles is 0.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio, int tiles) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio),
+  mTiles(tiles > 0 ? tiles : qMax(1, QThread::idealThreadCount()))
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  QCPPainter *result = new QCPPainter(&mBuffer);
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+bool QCPPaintBufferImage::scroll(int dx, int dy, const QRect &rect)
+{
+  const int ratio = qRound(mDevicePixelRatio);
+  if (!qFuzzyCompare(mDevicePixelRatio, (double)ratio))
+    return false;
+  // QImage can't scroll, so move the scan line segments in place, in an order that doesn't overwrite rows which still have to be moved:
+  const QRect target = QRect(rect.topLeft()*ratio, rect.size()*ratio) & mBuffer.rect();
+  const QRect source = target.translated(-dx*ratio, -dy*ratio) & target;
+  if (source.isEmpty())
+    return true;
+  const QRect dest = source.translated(dx*ratio, dy*ratio);
+  const int bytesPerPixel = mBuffer.depth()/8;
+  for (int i=0; i<source.height(); ++i)
+  {
+    const int row = dy > 0 ? source.height()-1-i : i;
+    memmove(mBuffer.scanLine(dest.top()+row)+dest.left()*bytesPerPixel, mBuffer.constScanLine(source.top()+row)+source.left()*bytesPerPixel, source.width()*bytesPerPixel);
+  }
+  return true;
+}
+
+/* inherits documentation from base class */
+int QCPPaintBufferImage::tileCount() const
+{
+  return qMax(1, mTileImages.size());
+}
+
+/* inherits documentation from base class */
+QRect QCPPaintBufferImage::tileRect(int index) const
+{
+  return mTileRects.value(index, QRect(QPoint(0, 0), mSize));
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startTilePainting(int index)
+{
+  if (index < 0 || index >= mTileImages.size())
+    return 0;
+  // mTileImages is never shared, so the non-const access doesn't detach and is safe from several threads:
+  QCPPainter *result = new QCPPainter(&mTileImages[index]);
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+  result->translate(0, -mTileRects.at(index).top());
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  mTileImages.clear();
+  mTileRects.clear();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+  
+  // the tile images point into the scan lines of mBuffer, which stays valid since mBuffer is never shared. Tiles must start on whole
+  // device pixel rows, so fractional device pixel ratios only get a single tile:
+  const int ratio = qRound(mDevicePixelRatio);
+  if (mBuffer.isNull() || !qFuzzyCompare(mDevicePixelRatio, (double)ratio))
+    return;
+  const int tiles = qMin(mTiles, mSize.height());
+  if (tiles < 2)
+    return;
+  for (int i=0; i<tiles; ++i)
+  {
+    const int top = mSize.height()*i/tiles;
+    const int bottom = mSize.height()*(i+1)/tiles;
+    QImage tileImage(mBuffer.scanLine(top*ratio), mBuffer.width(), (bottom-top)*ratio, mBuffer.bytesPerLine(), mBuffer.format());
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    tileImage.setDevicePixelRatio(mDevicePixelRatio);
+#endif
+    mTileImages.append(tileImage);
+    mTileRects.append(QRect(0, top, mSize.width(), bottom-top));
+  }
+}
+
+
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPaintBufferGlPbuffer
@@ -1045,7 +1280,8 @@ QCPLayer::QCPLayer(QCustomPlot *parentPlot, const QString &layerName) :
   mName(layerName),
   mIndex(-1), // will be set to a proper value by the QCustomPlot layer creation function
   mVisible(true),
-  mMode(lmLogical)
+  mMode(lmLogical),
+  mDirty(true)
 {
   // Note: no need to make sure layerName is unique, because layer
   // management is done with QCustomPlot functions.
@@ -1076,6 +1312,7 @@ QCPLayer::~QCPLayer()
 void QCPLayer::setVisible(bool visible)
 {
   mVisible = visible;
+  markDirty();
 }
 
 /*!
@@ -1111,23 +1348,138 @@ void QCPLayer::setMode(QCPLayer::LayerMode mode)
 
 /*! \internal
 
-  Draws the contents of this layer with the provided \a painter.
+  Draws the contents of this layer with the provided \a painter. If \a clipRect is valid, the
+  drawing of each layerable is additionally clipped to it.
 
   \see replot, drawToPaintBuffer
 */
-void QCPLayer::draw(QCPPainter *painter)
+void QCPLayer::draw(QCPPainter *painter, const QRect &clipRect)
 {
+  // only collect plottable timings during a full replot, not for exports or single layer replots:
+  const bool timing = mParentPlot->mReplotTiming && mParentPlot->mReplotting;
+  QElapsedTimer timer;
   foreach (QCPLayerable *child, mChildren)
   {
     if (child->realVisibility())
     {
-      painter->save();
-      painter->setClipRect(child->clipRect().translated(0, -1));
-      child->applyDefaultAntialiasingHint(painter);
-      child->draw(painter);
-      painter->restore();
+      if (timing)
+        timer.start();
+      drawLayerable(painter, child, clipRect);
+      if (timing)
+      {
+        if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(child))
+          mParentPlot->mReplotStats.plottableTimes.append(QCPReplotStats::Timing(plottable->name(), timer.nsecsElapsed()));
+      }
+    }
+  }
+}
+
+/*! \internal
+
+  Draws the contents of this layer like \ref draw, into a \a buffer that is split into tiles (see
+  \ref QCPAbstractPaintBuffer::tileCount). Consecutive layerables which support concurrent drawing
+  (see \ref QCPLayerable::reentrantDraw) are drawn tile by tile with \ref drawTiles, all others are
+  drawn with \a painter, which paints the entire buffer.
+
+  Per plottable timings of the replot statistics aren't collected for tiled buffers.
+*/
+void QCPLayer::drawTiled(QCPPainter *painter, QCPAbstractPaintBuffer *buffer, const QRect &clipRect)
+{
+  QList<QCPLayerable*> run; // consecutive layerables which are drawn on all tiles concurrently
+  foreach (QCPLayerable *child, mChildren)
+  {
+    if (!child->realVisibility())
+      continue;
+    if (child->reentrantDraw())
+    {
+      run.append(child);
+    } else
+    {
+      drawTiles(buffer, run, clipRect);
+      run.clear();
+      drawLayerable(painter, child, clipRect);
+    }
+  }
+  drawTiles(buffer, run, clipRect);
+}
+
+/*! \internal
+
+  Draws the \a layerables onto every tile of \a buffer, each tile with its own painter. If
+  QCustomPlot is compiled with \c QCUSTOMPLOT_USE_CONCURRENT, the tiles are drawn concurrently on
+  the global thread pool, and this method blocks until all are done.
+
+  The plottables among the \a layerables are prepared (see \ref QCPAbstractPlottable::prepareDraw)
+  on the calling thread first, so the data is reduced once and not once per tile.
+*/
+void QCPLayer::drawTiles(QCPAbstractPaintBuffer *buffer, const QList<QCPLayerable*> &layerables, const QRect &clipRect)
+{
+  if (layerables.isEmpty())
+    return;
+  if (mParentPlot->mReplotting) // prepared results are only used during a replot
+  {
+    foreach (QCPLayerable *layerable, layerables)
+    {
+      if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(layerable))
+        QCustomPlot::preparePlottable(plottable);
     }
   }
+  
+  QVector<TileJob> jobs(buffer->tileCount());
+  for (int i=0; i<jobs.size(); ++i)
+  {
+    jobs[i].buffer = buffer;
+    jobs[i].index = i;
+    jobs[i].layerables = &layerables;
+    jobs[i].clipRect = clipRect;
+  }
+#ifdef QCUSTOMPLOT_USE_CONCURRENT
+  QtConcurrent::blockingMap(jobs, &QCPLayer::drawTile);
+#else
+  for (int i=0; i<jobs.size(); ++i)
+    drawTile(jobs[i]);
+#endif
+}
+
+/*! \internal
+
+  Worker function of \ref drawTiles, draws the layerables of \a job onto one tile of its buffer.
+  It may be executed on a thread of the global thread pool.
+*/
+void QCPLayer::drawTile(TileJob &job)
+{
+  const QRect tileRect = job.buffer->tileRect(job.index);
+  const QRect clipRect = job.clipRect.isValid() ? job.clipRect & tileRect : tileRect;
+  if (clipRect.isEmpty())
+    return;
+  if (QCPPainter *painter = job.buffer->startTilePainting(job.index))
+  {
+    if (painter->isActive())
+    {
+      foreach (QCPLayerable *layerable, *job.layerables)
+        drawLayerable(painter, layerable, clipRect);
+    } else
+      qDebug() << Q_FUNC_INFO << "paint buffer returned inactive tile painter";
+    delete painter;
+  } else
+    qDebug() << Q_FUNC_INFO << "paint buffer returned zero tile painter";
+}
+
+/*! \internal
+
+  Draws the single \a layerable with \a painter, clipped to the layerable's clip rect and, if it is
+  valid, to \a clipRect.
+*/
+void QCPLayer::drawLayerable(QCPPainter *painter, QCPLayerable *layerable, const QRect &clipRect)
+{
+  painter->save();
+  if (clipRect.isValid())
+    painter->setClipRect(layerable->clipRect().translated(0, -1) & clipRect);
+  else
+    painter->setClipRect(layerable->clipRect().translated(0, -1));
+  layerable->applyDefaultAntialiasingHint(painter);
+  layerable->draw(painter);
+  painter->restore();
 }
 
 /*! \internal
@@ -1136,6 +1488,11 @@ void QCPLayer::draw(QCPPainter *painter)
   association is established by the parent QCustomPlot, which manages all paint buffers (see \ref
   QCustomPlot::setupPaintBuffers).
 
+  If this layer is scrolled by an axis rect (see \ref QCPAxisRect::setScrollLayer) and the axis rect
+  could reuse the previous contents, only the strip exposed by scrolling is cleared and redrawn.
+
+  If the paint buffer is split into tiles, the layer is drawn with \ref drawTiled.
+
   \see draw
 */
 void QCPLayer::drawToPaintBuffer()
@@ -1145,8 +1502,20 @@ void QCPLayer::drawToPaintBuffer()
     if (QCPPainter *painter = mPaintBuffer.data()->startPainting())
     {
       if (painter->isActive())
-        draw(painter);
-      else
+      {
+        const QRect strip = mScrollAxisRect && mScrollAxisRect.data()->mScrollStripActive ? mScrollAxisRect.data()->mScrollStripRect : QRect();
+        if (strip.isValid())
+        {
+          painter->save();
+          painter->setCompositionMode(QPainter::CompositionMode_Source);
+          painter->fillRect(strip, Qt::transparent);
+          painter->restore();
+        }
+        if (mPaintBuffer.data()->tileCount() > 1)
+          drawTiled(painter, mPaintBuffer.data(), strip);
+        else
+          draw(painter, strip);
+      } else
         qDebug() << Q_FUNC_INFO << "paint buffer returned inactive painter";
       delete painter;
       mPaintBuffer.data()->donePainting();
@@ -1171,20 +1540,35 @@ void QCPLayer::drawToPaintBuffer()
 */
 void QCPLayer::replot()
 {
-  if (mMode == lmBuffered && !mParentPlot->hasInvalidatedPaintBuffers())
+  if (mMode == lmBuffered && !mScrollAxisRect && !mParentPlot->hasInvalidatedPaintBuffers())
   {
     if (!mPaintBuffer.isNull())
     {
       mPaintBuffer.data()->clear(Qt::transparent);
       drawToPaintBuffer();
       mPaintBuffer.data()->setInvalidated(false);
+      mDirty = false;
       mParentPlot->update();
     } else
       qDebug() << Q_FUNC_INFO << "no valid paint buffer associated with this layer";
-  } else if (mMode == lmLogical)
+  } else if (mMode == lmLogical || mScrollAxisRect) // scrolled layers depend on the axis rect state of the full replot
     mParentPlot->replot();
 }
 
+/*!
+  Marks this layer as dirty, so the next \ref QCustomPlot::replot redraws the paint buffer of this
+  layer, if the plotting hint \ref QCP::phDirtyLayersOnly is set. Without that hint, all layers are
+  redrawn in every replot anyway.
+
+  Layerables call this via \ref QCPLayerable::markDirty when their appearance changes, so it is
+  only necessary to call it directly after changes QCustomPlot can't detect, e.g. modifications of
+  plottable data through non-const iterators.
+*/
+void QCPLayer::markDirty()
+{
+  mDirty = true;
+}
+
 /*! \internal
   
   Adds the \a layerable to the list of this layer. If \a prepend is set to true, the layerable will
@@ -1203,6 +1587,7 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
       mChildren.prepend(layerable);
     else
       mChildren.append(layerable);
+    mDirty = true;
     if (!mPaintBuffer.isNull())
       mPaintBuffer.data()->setInvalidated();
   } else
@@ -1222,6 +1607,7 @@ void QCPLayer::removeChild(QCPLayerable *layerable)
 {
   if (mChildren.removeOne(layerable))
   {
+    mDirty = true;
     if (!mPaintBuffer.isNull())
       mPaintBuffer.data()->setInvalidated();
   } else
@@ -1342,7 +1728,8 @@ QCPLayerable::QCPLayerable(QCustomPlot *plot, QString targetLayer, QCPLayerable
   mParentPlot(plot),
   mParentLayerable(parentLayerable),
   mLayer(0),
-  mAntialiased(true)
+  mAntialiased(true),
+  mDrawnSignature(0)
 {
   if (mParentPlot)
   {
@@ -1370,6 +1757,7 @@ QCPLayerable::~QCPLayerable()
 void QCPLayerable::setVisible(bool on)
 {
   mVisible = on;
+  markDirty();
 }
 
 /*!
@@ -1417,6 +1805,7 @@ bool QCPLayerable::setLayer(const QString &layerName)
 void QCPLayerable::setAntialiased(bool enabled)
 {
   mAntialiased = enabled;
+  markDirty();
 }
 
 /*!
@@ -1476,6 +1865,44 @@ double QCPLayerable::selectTest(const QPointF &pos, bool onlySelectable, QVarian
   return -1.0;
 }
 
+/*!
+  Returns a hash over the state this layerable's drawing depends on, that may change without one of
+  its setters being called. This covers geometry and the axes, data or positions the layerable
+  follows. If the plotting hint \ref QCP::phDirtyLayersOnly is set, \ref QCustomPlot::replot
+  compares it with the value of the previous replot, and redraws the layer if it differs.
+
+  A return value of 0 means the state can't be determined, in which case the layer is redrawn in
+  every replot.
+
+  The base implementation covers the \ref realVisibility and the \ref clipRect. Subclasses
+  reimplement it to add their own dependencies, see e.g. \ref QCPAxis::drawSignature or \ref
+  QCPAbstractPlottable::drawSignature.
+
+  \see markDirty
+*/
+quint64 QCPLayerable::drawSignature() const
+{
+  const quint64 result = QCP::hashCombine(quint64(1), quint64(realVisibility()));
+  return QCP::hashCombine(result, clipRect());
+}
+
+/*!
+  Marks the layer of this layerable dirty, so it is redrawn in the next \ref QCustomPlot::replot
+  when the plotting hint \ref QCP::phDirtyLayersOnly is set.
+
+  The setters of layerables that change their appearance call this method. Changes of axis ranges,
+  geometry or data are detected by \ref drawSignature instead. Call this method after changing
+  the appearance of a layerable in a way neither of the two can see, e.g. modifying a shared axis
+  ticker or data points through non-const iterators.
+
+  \see QCPLayer::markDirty
+*/
+void QCPLayerable::markDirty()
+{
+  if (mLayer)
+    mLayer->markDirty();
+}
+
 /*! \internal
   
   Sets the parent plot of this layerable. Use this function once to set the parent plot if you have
@@ -1627,6 +2054,21 @@ QRect QCPLayerable::clipRect() const
     return QRect();
 }
 
+/*! \internal
+
+  Returns whether \ref draw may be called concurrently from several threads, each time with a
+  different painter. This is used by \ref QCPLayer to draw onto the tiles of a \ref
+  QCPPaintBufferImage in parallel.
+
+  A reimplementation returning true must make sure \ref draw only reads the state of the
+  layerable and the objects it depends on. The base implementation returns false, so the layerable
+  is drawn once on the GUI thread.
+*/
+bool QCPLayerable::reentrantDraw() const
+{
+  return false;
+}
+
 /*! \internal
   
   This event is called when the layerable shall be selected, as a consequence of a click by the
@@ -2850,6 +3292,7 @@ QCPRange QCPSelectionRect::range(const QCPAxis *axis) const
 void QCPSelectionRect::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -2861,6 +3304,7 @@ void QCPSelectionRect::setPen(const QPen &pen)
 void QCPSelectionRect::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -2876,6 +3320,13 @@ void QCPSelectionRect::cancel()
   }
 }
 
+/* inherits documentation from base class */
+quint64 QCPSelectionRect::drawSignature() const
+{
+  const quint64 result = QCP::hashCombine(QCPLayerable::drawSignature(), quint64(mActive));
+  return QCP::hashCombine(result, mRect);
+}
+
 /*! \internal
   
   This method is called by QCustomPlot to indicate that a selection rect interaction was initiated.
@@ -3454,6 +3905,18 @@ double QCPLayoutElement::selectTest(const QPointF &pos, bool onlySelectable, QVa
     return -1;
 }
 
+/*!
+  Adds the inner and outer rect of this layout element to the signature, so a layout change
+  redraws the element.
+
+  \seebaseclassmethod
+*/
+quint64 QCPLayoutElement::drawSignature() const
+{
+  const quint64 result = QCP::hashCombine(QCPLayerable::drawSignature(), mRect);
+  return QCP::hashCombine(result, mOuterRect);
+}
+
 /*! \internal
   
   propagates the parent plot initialization to all child elements, by calling \ref
@@ -7064,6 +7527,7 @@ QCPGrid::QCPGrid(QCPAxis *parentAxis) :
 void QCPGrid::setSubGridVisible(bool visible)
 {
   mSubGridVisible = visible;
+  markDirty();
 }
 
 /*!
@@ -7072,6 +7536,7 @@ void QCPGrid::setSubGridVisible(bool visible)
 void QCPGrid::setAntialiasedSubGrid(bool enabled)
 {
   mAntialiasedSubGrid = enabled;
+  markDirty();
 }
 
 /*!
@@ -7080,6 +7545,7 @@ void QCPGrid::setAntialiasedSubGrid(bool enabled)
 void QCPGrid::setAntialiasedZeroLine(bool enabled)
 {
   mAntialiasedZeroLine = enabled;
+  markDirty();
 }
 
 /*!
@@ -7088,6 +7554,7 @@ void QCPGrid::setAntialiasedZeroLine(bool enabled)
 void QCPGrid::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -7096,6 +7563,7 @@ void QCPGrid::setPen(const QPen &pen)
 void QCPGrid::setSubGridPen(const QPen &pen)
 {
   mSubGridPen = pen;
+  markDirty();
 }
 
 /*!
@@ -7107,6 +7575,18 @@ void QCPGrid::setSubGridPen(const QPen &pen)
 void QCPGrid::setZeroLinePen(const QPen &pen)
 {
   mZeroLinePen = pen;
+  markDirty();
+}
+
+/*!
+  The grid lines follow the ticks of the parent axis, so the signature of the parent axis is
+  included.
+
+  \seebaseclassmethod
+*/
+quint64 QCPGrid::drawSignature() const
+{
+  return QCP::hashCombine(QCPLayerable::drawSignature(), mParentAxis ? mParentAxis->drawSignature() : quint64(0));
 }
 
 /*! \internal
@@ -7622,6 +8102,7 @@ void QCPAxis::setSelectedParts(const SelectableParts &selected)
     mSelectedParts = selected;
     emit selectionChanged(mSelectedParts);
   }
+  markDirty();
 }
 
 /*!
@@ -7752,6 +8233,7 @@ void QCPAxis::setTicker(QSharedPointer<QCPAxisTicker> ticker)
   else
     qDebug() << Q_FUNC_INFO << "can not set 0 as axis ticker";
   // no need to invalidate margin cache here because produced tick labels are checked for changes in setupTickVector
+  markDirty();
 }
 
 /*!
@@ -7769,6 +8251,7 @@ void QCPAxis::setTicks(bool show)
     mTicks = show;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -7783,6 +8266,7 @@ void QCPAxis::setTickLabels(bool show)
     if (!mTickLabels)
       mTickVectorLabels.clear();
   }
+  markDirty();
 }
 
 /*!
@@ -7796,6 +8280,7 @@ void QCPAxis::setTickLabelPadding(int padding)
     mAxisPainter->tickLabelPadding = padding;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -7810,6 +8295,7 @@ void QCPAxis::setTickLabelFont(const QFont &font)
     mTickLabelFont = font;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -7820,6 +8306,7 @@ void QCPAxis::setTickLabelFont(const QFont &font)
 void QCPAxis::setTickLabelColor(const QColor &color)
 {
   mTickLabelColor = color;
+  markDirty();
 }
 
 /*!
@@ -7838,6 +8325,7 @@ void QCPAxis::setTickLabelRotation(double degrees)
     mAxisPainter->tickLabelRotation = qBound(-90.0, degrees, 90.0);
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -7851,6 +8339,7 @@ void QCPAxis::setTickLabelSide(LabelSide side)
 {
   mAxisPainter->tickLabelSide = side;
   mCachedMarginValid = false;
+  markDirty();
 }
 
 /*!
@@ -7885,6 +8374,7 @@ void QCPAxis::setTickLabelSide(LabelSide side)
 */
 void QCPAxis::setNumberFormat(const QString &formatCode)
 {
+  markDirty();
   if (formatCode.isEmpty())
   {
     qDebug() << Q_FUNC_INFO << "Passed formatCode is empty";
@@ -7950,6 +8440,7 @@ void QCPAxis::setNumberPrecision(int precision)
     mNumberPrecision = precision;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -7964,6 +8455,7 @@ void QCPAxis::setTickLength(int inside, int outside)
 {
   setTickLengthIn(inside);
   setTickLengthOut(outside);
+  markDirty();
 }
 
 /*!
@@ -7978,6 +8470,7 @@ void QCPAxis::setTickLengthIn(int inside)
   {
     mAxisPainter->tickLengthIn = inside;
   }
+  markDirty();
 }
 
 /*!
@@ -7994,6 +8487,7 @@ void QCPAxis::setTickLengthOut(int outside)
     mAxisPainter->tickLengthOut = outside;
     mCachedMarginValid = false; // only outside tick length can change margin
   }
+  markDirty();
 }
 
 /*!
@@ -8010,6 +8504,7 @@ void QCPAxis::setSubTicks(bool show)
     mSubTicks = show;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -8024,6 +8519,7 @@ void QCPAxis::setSubTickLength(int inside, int outside)
 {
   setSubTickLengthIn(inside);
   setSubTickLengthOut(outside);
+  markDirty();
 }
 
 /*!
@@ -8038,6 +8534,7 @@ void QCPAxis::setSubTickLengthIn(int inside)
   {
     mAxisPainter->subTickLengthIn = inside;
   }
+  markDirty();
 }
 
 /*!
@@ -8054,6 +8551,7 @@ void QCPAxis::setSubTickLengthOut(int outside)
     mAxisPainter->subTickLengthOut = outside;
     mCachedMarginValid = false; // only outside tick length can change margin
   }
+  markDirty();
 }
 
 /*!
@@ -8064,6 +8562,7 @@ void QCPAxis::setSubTickLengthOut(int outside)
 void QCPAxis::setBasePen(const QPen &pen)
 {
   mBasePen = pen;
+  markDirty();
 }
 
 /*!
@@ -8074,6 +8573,7 @@ void QCPAxis::setBasePen(const QPen &pen)
 void QCPAxis::setTickPen(const QPen &pen)
 {
   mTickPen = pen;
+  markDirty();
 }
 
 /*!
@@ -8084,6 +8584,7 @@ void QCPAxis::setTickPen(const QPen &pen)
 void QCPAxis::setSubTickPen(const QPen &pen)
 {
   mSubTickPen = pen;
+  markDirty();
 }
 
 /*!
@@ -8098,6 +8599,7 @@ void QCPAxis::setLabelFont(const QFont &font)
     mLabelFont = font;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -8108,6 +8610,7 @@ void QCPAxis::setLabelFont(const QFont &font)
 void QCPAxis::setLabelColor(const QColor &color)
 {
   mLabelColor = color;
+  markDirty();
 }
 
 /*!
@@ -8121,6 +8624,7 @@ void QCPAxis::setLabel(const QString &str)
     mLabel = str;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -8135,6 +8639,7 @@ void QCPAxis::setLabelPadding(int padding)
     mAxisPainter->labelPadding = padding;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -8154,6 +8659,7 @@ void QCPAxis::setPadding(int padding)
     mPadding = padding;
     mCachedMarginValid = false;
   }
+  markDirty();
 }
 
 /*!
@@ -8181,6 +8687,7 @@ void QCPAxis::setSelectedTickLabelFont(const QFont &font)
     mSelectedTickLabelFont = font;
     // don't set mCachedMarginValid to false here because margin calculation is always done with non-selected fonts
   }
+  markDirty();
 }
 
 /*!
@@ -8192,6 +8699,7 @@ void QCPAxis::setSelectedLabelFont(const QFont &font)
 {
   mSelectedLabelFont = font;
   // don't set mCachedMarginValid to false here because margin calculation is always done with non-selected fonts
+  markDirty();
 }
 
 /*!
@@ -8205,6 +8713,7 @@ void QCPAxis::setSelectedTickLabelColor(const QColor &color)
   {
     mSelectedTickLabelColor = color;
   }
+  markDirty();
 }
 
 /*!
@@ -8215,6 +8724,7 @@ void QCPAxis::setSelectedTickLabelColor(const QColor &color)
 void QCPAxis::setSelectedLabelColor(const QColor &color)
 {
   mSelectedLabelColor = color;
+  markDirty();
 }
 
 /*!
@@ -8225,6 +8735,7 @@ void QCPAxis::setSelectedLabelColor(const QColor &color)
 void QCPAxis::setSelectedBasePen(const QPen &pen)
 {
   mSelectedBasePen = pen;
+  markDirty();
 }
 
 /*!
@@ -8235,6 +8746,7 @@ void QCPAxis::setSelectedBasePen(const QPen &pen)
 void QCPAxis::setSelectedTickPen(const QPen &pen)
 {
   mSelectedTickPen = pen;
+  markDirty();
 }
 
 /*!
@@ -8245,6 +8757,7 @@ void QCPAxis::setSelectedTickPen(const QPen &pen)
 void QCPAxis::setSelectedSubTickPen(const QPen &pen)
 {
   mSelectedSubTickPen = pen;
+  markDirty();
 }
 
 /*!
@@ -8260,6 +8773,7 @@ void QCPAxis::setSelectedSubTickPen(const QPen &pen)
 void QCPAxis::setLowerEnding(const QCPLineEnding &ending)
 {
   mAxisPainter->lowerEnding = ending;
+  markDirty();
 }
 
 /*!
@@ -8275,6 +8789,7 @@ void QCPAxis::setLowerEnding(const QCPLineEnding &ending)
 void QCPAxis::setUpperEnding(const QCPLineEnding &ending)
 {
   mAxisPainter->upperEnding = ending;
+  markDirty();
 }
 
 /*!
@@ -8559,6 +9074,31 @@ double QCPAxis::selectTest(const QPointF &pos, bool onlySelectable, QVariant *de
   return mParentPlot->selectionTolerance()*0.99;
 }
 
+/*!
+  Adds the range, scale type, the geometry of the axis rect and the ticks with their labels to the
+  signature. Ticks are covered because the axis ticker may produce different ticks for the same
+  range after it was reconfigured.
+
+  \seebaseclassmethod
+*/
+quint64 QCPAxis::drawSignature() const
+{
+  quint64 result = QCPLayerable::drawSignature();
+  result = QCP::hashCombine(result, mAxisRect->rect());
+  result = QCP::hashCombine(result, mRange.lower);
+  result = QCP::hashCombine(result, mRange.upper);
+  result = QCP::hashCombine(result, quint64(mScaleType));
+  result = QCP::hashCombine(result, quint64(mRangeReversed));
+  result = QCP::hashCombine(result, quint64(qint64(mOffset)));
+  for (int i=0; i<mTickVector.size(); ++i)
+    result = QCP::hashCombine(result, mTickVector.at(i));
+  for (int i=0; i<mSubTickVector.size(); ++i)
+    result = QCP::hashCombine(result, mSubTickVector.at(i));
+  for (int i=0; i<mTickVectorLabels.size(); ++i)
+    result = QCP::hashCombine(result, quint64(qHash(mTickVectorLabels.at(i))));
+  return result;
+}
+
 /*!
   Returns a list of all the plottables that have this axis as key or value axis.
   
@@ -10038,27 +10578,225 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
 
 //amalgamation: add datacontainer.cpp
 
-/* including file 'src/plottable.cpp', size 38861                            */
-/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
-
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-//////////////////// QCPSelectionDecorator
+//////////////////// QCPValuePyramid
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-/*! \class QCPSelectionDecorator
-  \brief Controls how a plottable's data selection is drawn
+/*! \class QCPValuePyramid
+  \brief Keeps the value extrema of a sliding window of data blocks in a multi-level pyramid
   
-  Each \ref QCPAbstractPlottable instance has one \ref QCPSelectionDecorator (accessible via \ref
-  QCPAbstractPlottable::selectionDecorator) and uses it when drawing selected segments of its data.
+  The data of a container is divided into blocks of a fixed number of data points, counted from the
+  first data point ever added, so block indices stay the same when data is removed from the front.
+  Level 0 of the pyramid holds the value extrema of each block, every node on the level above holds
+  the extrema of two nodes below it. The extrema of any range of complete blocks are then combined
+  from at most two nodes per level with \ref expand, i.e. in O(log N).
   
-  The selection decorator controls both pen (\ref setPen) and brush (\ref setBrush), as well as the
-  scatter style (\ref setScatterStyle) if the plottable draws scatters. Since a \ref
-  QCPScatterStyle is itself composed of different properties such as color shape and size, the
-  decorator allows specifying exactly which of those properties shall be used for the selected data
-  point, via \ref setUsedScatterProperties.
+  Blocks are added at the end with \ref appendBlock, which updates the nodes above the new block,
+  and are dropped with \ref removeBefore and \ref removeAfter. Each level is stored as a ring, so a
+  sliding window of blocks takes constant memory and no node is ever moved while the window slides.
   
-  A \ref QCPSelectionDecorator subclass instance can be passed to a plottable via \ref
-  QCPAbstractPlottable::setSelectionDecorator, allowing greater customizability of the appearance
+  Blocks whose extrema are not known yet, e.g. because they would have to be read from external
+  memory first, are added with \ref appendUnknownBlocks. Their extrema are then computed on demand
+  by the template overload of \ref expand.
+  
+  This class is used by \ref QCPDataContainer and \ref QCPGraphColumnContainer. Nodes that cover
+  blocks that were already removed are left stale, which is fine since queries only ever use nodes
+  that lie completely within the blocks still held.
+*/
+
+/*!
+  Creates an empty pyramid starting at block 0.
+*/
+QCPValuePyramid::QCPValuePyramid() :
+  mBeginBlock(0)
+{
+}
+
+/*!
+  Removes all blocks. The next block appended will have the index \a beginBlock.
+*/
+void QCPValuePyramid::clear(qint64 beginBlock)
+{
+  mBeginBlock = beginBlock;
+  mLevels.clear();
+}
+
+/*!
+  Appends a block with the value extrema \a extrema at \ref endBlock, and updates the nodes above it.
+*/
+void QCPValuePyramid::appendBlock(const QCPValueExtrema &extrema)
+{
+  const qint64 block = endBlock();
+  setNode(0, block, extrema);
+  // a node that also covers the first block held is never used by a query, so nodes above it needn't be updated:
+  for (int level=1; (block >> (level-1)) != (mBeginBlock >> (level-1)); ++level)
+    setNode(level, block >> level, childExtrema(level, block >> level));
+}
+
+/*!
+  Appends \a count blocks with unknown value extrema at \ref endBlock. Their extrema, and the ones of
+  the nodes above them, are computed on demand by the template overload of \ref expand.
+*/
+void QCPValuePyramid::appendUnknownBlocks(qint64 count)
+{
+  if (count <= 0)
+    return;
+  const QCPValueExtrema unknown = {qQNaN(), qQNaN()};
+  const qint64 begin = endBlock();
+  const qint64 last = begin+count-1;
+  for (int level=0; level == 0 || (last >> (level-1)) != (mBeginBlock >> (level-1)); ++level)
+  {
+    for (qint64 index = begin >> level; index <= (last >> level); ++index)
+      setNode(level, index, unknown);
+  }
+}
+
+/*!
+  Removes all blocks with an index smaller than \a block. Blocks that were never appended are
+  skipped, so \ref endBlock is at least \a block afterwards.
+*/
+void QCPValuePyramid::removeBefore(qint64 block)
+{
+  if (block <= mBeginBlock)
+    return;
+  mBeginBlock = block;
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    Level &l = mLevels[level];
+    l.begin = qMax(l.begin, block >> level);
+    l.end = qMax(l.end, l.begin);
+  }
+}
+
+/*!
+  Removes all blocks with an index greater than or equal to \a block.
+*/
+void QCPValuePyramid::removeAfter(qint64 block)
+{
+  for (int level=0; level<mLevels.size(); ++level)
+  {
+    Level &l = mLevels[level];
+    const qint64 nodeEnd = (block+(Q_INT64_C(1) << level)-1) >> level; // nodes that still cover a remaining block are kept
+    l.end = qMax(l.begin, qMin(l.end, nodeEnd));
+  }
+}
+
+/*!
+  Widens \a result by the value extrema of the blocks with indices from \a begin up to (excluding)
+  \a end. The range must lie within \ref beginBlock and \ref endBlock, and must not contain blocks
+  added with \ref appendUnknownBlocks, see the template overload of this method for those.
+*/
+void QCPValuePyramid::expand(QCPValueExtrema &result, qint64 begin, qint64 end) const
+{
+  for (int level=0; begin < end; ++level)
+  {
+    if (begin & 1)
+      expand(result, node(level, begin++));
+    if (end & 1)
+      expand(result, node(level, --end));
+    begin >>= 1;
+    end >>= 1;
+  }
+}
+
+/*!
+  Returns extrema that don't contain any value, i.e. a minimum of positive and a maximum of
+  negative infinity. Use this as the start value for \ref expand.
+*/
+QCPValueExtrema QCPValuePyramid::emptyExtrema()
+{
+  const QCPValueExtrema result = {std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+  return result;
+}
+
+/*! \overload
+  
+  Widens \a result by the value extrema \a other. NaN extrema leave \a result unchanged.
+*/
+void QCPValuePyramid::expand(QCPValueExtrema &result, const QCPValueExtrema &other)
+{
+  if (other.minValue < result.minValue)
+    result.minValue = other.minValue;
+  if (other.maxValue > result.maxValue)
+    result.maxValue = other.maxValue;
+}
+
+/*! \internal
+  
+  Sets the node \a index on \a level to \a extrema. Creates the level if it doesn't exist yet, and
+  grows the ring of the level if it is full. Nodes between the last one held and \a index are
+  filled with \ref emptyExtrema.
+*/
+void QCPValuePyramid::setNode(int level, qint64 index, const QCPValueExtrema &extrema)
+{
+  if (level == mLevels.size())
+  {
+    Level newLevel;
+    newLevel.begin = mBeginBlock >> level;
+    newLevel.end = newLevel.begin;
+    mLevels.append(newLevel);
+  }
+  Level &l = mLevels[level];
+  if (index >= l.end)
+  {
+    if (index-l.begin >= l.nodes.size())
+    {
+      int size = 16;
+      while (size <= index-l.begin)
+        size *= 2;
+      QVector<QCPValueExtrema> nodes(size);
+      for (qint64 i=l.begin; i<l.end; ++i)
+        nodes[int(i & (size-1))] = l.nodes.at(int(i & (l.nodes.size()-1)));
+      l.nodes.swap(nodes);
+    }
+    for (qint64 i=l.end; i<index; ++i)
+      node(level, i) = emptyExtrema();
+    l.end = index+1;
+  }
+  node(level, index) = extrema;
+}
+
+/*! \internal
+  
+  Returns the extrema of the child nodes of the node \a index on \a level, considering only the
+  children that are still held. If one of them is unknown, the returned extrema are unknown (NaN)
+  too.
+*/
+QCPValueExtrema QCPValuePyramid::childExtrema(int level, qint64 index) const
+{
+  const Level &l = mLevels.at(level-1);
+  QCPValueExtrema result = emptyExtrema();
+  for (qint64 child=qMax(2*index, l.begin); child<qMin(2*index+2, l.end); ++child)
+  {
+    const QCPValueExtrema &extrema = node(level-1, child);
+    if (qIsNaN(extrema.minValue))
+      return extrema;
+    expand(result, extrema);
+  }
+  return result;
+}
+
+/* including file 'src/plottable.cpp', size 38861                            */
+/* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPSelectionDecorator
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPSelectionDecorator
+  \brief Controls how a plottable's data selection is drawn
+  
+  Each \ref QCPAbstractPlottable instance has one \ref QCPSelectionDecorator (accessible via \ref
+  QCPAbstractPlottable::selectionDecorator) and uses it when drawing selected segments of its data.
+  
+  The selection decorator controls both pen (\ref setPen) and brush (\ref setBrush), as well as the
+  scatter style (\ref setScatterStyle) if the plottable draws scatters. Since a \ref
+  QCPScatterStyle is itself composed of different properties such as color shape and size, the
+  decorator allows specifying exactly which of those properties shall be used for the selected data
+  point, via \ref setUsedScatterProperties.
+  
+  A \ref QCPSelectionDecorator subclass instance can be passed to a plottable via \ref
+  QCPAbstractPlottable::setSelectionDecorator, allowing greater customizability of the appearance
   of selected segments.
   
   Use \ref copyFrom to easily transfer the settings of one decorator to another one. This is
@@ -10093,6 +10831,8 @@ QCPSelectionDecorator::~QCPSelectionDecorator()
 void QCPSelectionDecorator::setPen(const QPen &pen)
 {
   mPen = pen;
+  if (mPlottable)
+    mPlottable->markDirty();
 }
 
 /*!
@@ -10101,6 +10841,8 @@ void QCPSelectionDecorator::setPen(const QPen &pen)
 void QCPSelectionDecorator::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  if (mPlottable)
+    mPlottable->markDirty();
 }
 
 /*!
@@ -10114,6 +10856,8 @@ void QCPSelectionDecorator::setScatterStyle(const QCPScatterStyle &scatterStyle,
 {
   mScatterStyle = scatterStyle;
   setUsedScatterProperties(usedProperties);
+  if (mPlottable)
+    mPlottable->markDirty();
 }
 
 /*!
@@ -10124,6 +10868,8 @@ void QCPSelectionDecorator::setScatterStyle(const QCPScatterStyle &scatterStyle,
 void QCPSelectionDecorator::setUsedScatterProperties(const QCPScatterStyle::ScatterProperties &properties)
 {
   mUsedScatterProperties = properties;
+  if (mPlottable)
+    mPlottable->markDirty();
 }
 
 /*!
@@ -10468,6 +11214,7 @@ QCPAbstractPlottable::~QCPAbstractPlottable()
 void QCPAbstractPlottable::setName(const QString &name)
 {
   mName = name;
+  markDirty();
 }
 
 /*!
@@ -10479,6 +11226,7 @@ void QCPAbstractPlottable::setName(const QString &name)
 void QCPAbstractPlottable::setAntialiasedFill(bool enabled)
 {
   mAntialiasedFill = enabled;
+  markDirty();
 }
 
 /*!
@@ -10490,6 +11238,7 @@ void QCPAbstractPlottable::setAntialiasedFill(bool enabled)
 void QCPAbstractPlottable::setAntialiasedScatters(bool enabled)
 {
   mAntialiasedScatters = enabled;
+  markDirty();
 }
 
 /*!
@@ -10503,6 +11252,7 @@ void QCPAbstractPlottable::setAntialiasedScatters(bool enabled)
 void QCPAbstractPlottable::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -10517,6 +11267,7 @@ void QCPAbstractPlottable::setPen(const QPen &pen)
 void QCPAbstractPlottable::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -10533,6 +11284,7 @@ void QCPAbstractPlottable::setBrush(const QBrush &brush)
 void QCPAbstractPlottable::setKeyAxis(QCPAxis *axis)
 {
   mKeyAxis = axis;
+  markDirty();
 }
 
 /*!
@@ -10549,6 +11301,7 @@ void QCPAbstractPlottable::setKeyAxis(QCPAxis *axis)
 void QCPAbstractPlottable::setValueAxis(QCPAxis *axis)
 {
   mValueAxis = axis;
+  markDirty();
 }
 
 
@@ -10579,6 +11332,7 @@ void QCPAbstractPlottable::setSelection(QCPDataSelection selection)
     emit selectionChanged(selected());
     emit selectionChanged(mSelection);
   }
+  markDirty();
 }
 
 /*!
@@ -10631,6 +11385,49 @@ void QCPAbstractPlottable::setSelectable(QCP::SelectionType selectable)
       emit selectionChanged(mSelection);
     }
   }
+  markDirty();
+}
+
+/*!
+  Adds the ranges and scale types of the key and value axes and the \ref dataSignature to the
+  signature. If the data signature can't be determined, returns 0, so the plottable's layer is
+  redrawn in every replot.
+
+  \seebaseclassmethod
+*/
+quint64 QCPAbstractPlottable::drawSignature() const
+{
+  const quint64 data = dataSignature();
+  if (data == 0)
+    return 0;
+  quint64 result = QCP::hashCombine(QCPLayerable::drawSignature(), data);
+  QList<QCPAxis*> axes = QList<QCPAxis*>() << mKeyAxis.data() << mValueAxis.data();
+  foreach (QCPAxis *axis, axes)
+  {
+    if (!axis)
+      continue;
+    result = QCP::hashCombine(result, axis->range().lower);
+    result = QCP::hashCombine(result, axis->range().upper);
+    result = QCP::hashCombine(result, quint64(axis->scaleType()));
+    result = QCP::hashCombine(result, quint64(axis->rangeReversed()));
+  }
+  return result;
+}
+
+/*!
+  Also marks the item of this plottable in the main legend dirty, since it shows the plottable's
+  name and style.
+
+  \seebaseclassmethod
+*/
+void QCPAbstractPlottable::markDirty()
+{
+  QCPLayerable::markDirty();
+  if (mParentPlot && mParentPlot->legend)
+  {
+    if (QCPPlottableLegendItem *item = mParentPlot->legend->itemWithPlottable(this))
+      item->markDirty();
+  }
 }
 
 
@@ -10932,6 +11729,34 @@ void QCPAbstractPlottable::applyDefaultAntialiasingHint(QCPPainter *painter) con
   applyAntialiasingHint(painter, mAntialiased, QCP::aePlottables);
 }
 
+/*! \internal
+
+  Called by \ref QCustomPlot::replot before the layers are drawn, if the plotting hint \ref
+  QCP::phConcurrentLines is set. Subclasses may reimplement it to do the expensive data-to-pixel
+  reduction in advance and keep the result for the next call of \ref draw, leaving only the painter
+  calls for the GUI thread.
+
+  The calls of different plottables run concurrently on worker threads, so a reimplementation may
+  only read the plottable's own state, its data and its axes. The base implementation does nothing,
+  so the plottable does all work in \ref draw.
+*/
+void QCPAbstractPlottable::prepareDraw()
+{
+}
+
+/*! \internal
+
+  Returns a hash identifying the state of this plottable's data, see \ref drawSignature. It must
+  change whenever the data changes in a way that affects drawing.
+
+  The base implementation can't tell and returns 0, so plottables that don't reimplement it are
+  redrawn in every replot when the plotting hint \ref QCP::phDirtyLayersOnly is set.
+*/
+quint64 QCPAbstractPlottable::dataSignature() const
+{
+  return 0;
+}
+
 /*! \internal
 
   A convenience function to easily set the QPainter::Antialiased hint on the provided \a painter
@@ -11983,6 +12808,7 @@ void QCPAbstractItem::setClipToAxisRect(bool clip)
   mClipToAxisRect = clip;
   if (mClipToAxisRect)
     setParentLayerable(mClipAxisRect.data());
+  markDirty();
 }
 
 /*!
@@ -11996,6 +12822,7 @@ void QCPAbstractItem::setClipAxisRect(QCPAxisRect *rect)
   mClipAxisRect = rect;
   if (mClipToAxisRect)
     setParentLayerable(mClipAxisRect.data());
+  markDirty();
 }
 
 /*!
@@ -12014,6 +12841,7 @@ void QCPAbstractItem::setSelectable(bool selectable)
     mSelectable = selectable;
     emit selectableChanged(mSelectable);
   }
+  markDirty();
 }
 
 /*!
@@ -12037,6 +12865,7 @@ void QCPAbstractItem::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markDirty();
 }
 
 /*!
@@ -12099,6 +12928,24 @@ bool QCPAbstractItem::hasAnchor(const QString &name) const
   return false;
 }
 
+/*!
+  Adds the pixel positions of all positions of this item to the signature. This covers changes of
+  the coordinates, of the axes or axis rects the positions refer to, and of parent anchors.
+
+  \seebaseclassmethod
+*/
+quint64 QCPAbstractItem::drawSignature() const
+{
+  quint64 result = QCPLayerable::drawSignature();
+  for (int i=0; i<mPositions.size(); ++i)
+  {
+    const QPointF pixel = mPositions.at(i)->pixelPosition();
+    result = QCP::hashCombine(result, pixel.x());
+    result = QCP::hashCombine(result, pixel.y());
+  }
+  return result;
+}
+
 /*! \internal
   
   Returns the rect the visual representation of this item is clipped to. This depends on the
@@ -12283,6 +13130,147 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
 /* including file 'src/core.cpp', size 124243                                */
 /* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPReplotStats
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPReplotStats
+  \brief Timing breakdown of the replots of a QCustomPlot
+  
+  QCustomPlot fills an instance of this class during every \ref QCustomPlot::replot once timing
+  was enabled with \ref QCustomPlot::setReplotTiming. It is accessed via \ref
+  QCustomPlot::replotStats, typically from a slot connected to \ref QCustomPlot::afterReplot.
+  
+  All times are wall clock times in nanoseconds, measured with QElapsedTimer. The public members
+  describe the most recent replot: \ref replotTime spans from the start of the replot until all
+  layers were drawn into their paint buffers and is made up of \ref updateLayoutTime, \ref
+  setupPaintBuffersTime, \ref prepareTime (only nonzero with \ref QCP::phConcurrentLines) and \ref
+  layerDrawTime. The latter is broken down per layer in \ref
+  layerTimes and per plottable in \ref plottableTimes. \ref paintEventTime is the time the last
+  widget paint event took to blit the paint buffers to the screen. Note that with a queued refresh
+  (see \ref QCustomPlot::RefreshPriority) the paint event happens after \ref
+  QCustomPlot::afterReplot, so it then refers to the previous replot.
+  
+  If a history size greater than zero is set (\ref setHistorySize), the \ref replotTime of the
+  most recent replots is kept in a rolling window that can be evaluated with \ref histogram and
+  \ref percentile.
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn int QCPReplotStats::historySize() const
+  
+  Returns the number of replots kept in the rolling history, see \ref setHistorySize.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Creates an empty statistics object without rolling history.
+*/
+QCPReplotStats::QCPReplotStats() :
+  replotCount(0),
+  replotTime(0),
+  updateLayoutTime(0),
+  setupPaintBuffersTime(0),
+  prepareTime(0),
+  layerDrawTime(0),
+  paintEventTime(0),
+  mHistorySize(0),
+  mHistoryIndex(0)
+{
+}
+
+/*!
+  Sets the number of most recent replot times kept for \ref histogram and \ref percentile. A \a
+  size of zero disables the history. Changing the size discards the current history.
+*/
+void QCPReplotStats::setHistorySize(int size)
+{
+  mHistorySize = qMax(0, size);
+  mHistory.clear();
+  mHistory.reserve(mHistorySize);
+  mHistoryIndex = 0;
+}
+
+/*!
+  Resets all timings, the replot count and the rolling history. The history size is kept.
+*/
+void QCPReplotStats::clear()
+{
+  replotCount = 0;
+  replotTime = 0;
+  updateLayoutTime = 0;
+  setupPaintBuffersTime = 0;
+  prepareTime = 0;
+  layerDrawTime = 0;
+  paintEventTime = 0;
+  layerTimes.clear();
+  plottableTimes.clear();
+  mHistory.clear();
+  mHistoryIndex = 0;
+}
+
+/*!
+  Appends \a replotTime to the rolling history, overwriting the oldest entry once the history is
+  full. Does nothing if the history size is zero.
+*/
+void QCPReplotStats::addToHistory(qint64 replotTime)
+{
+  if (mHistorySize <= 0)
+    return;
+  if (mHistory.size() < mHistorySize)
+  {
+    mHistory.append(replotTime);
+  } else
+  {
+    mHistory[mHistoryIndex] = replotTime;
+    mHistoryIndex = (mHistoryIndex+1) % mHistorySize;
+  }
+}
+
+/*!
+  Returns the replot times in the rolling history, oldest first.
+*/
+QVector<qint64> QCPReplotStats::history() const
+{
+  QVector<qint64> result;
+  result.reserve(mHistory.size());
+  for (int i=0; i<mHistory.size(); ++i)
+    result.append(mHistory.at((mHistoryIndex+i) % mHistory.size()));
+  return result;
+}
+
+/*!
+  Sorts the replot times in the rolling history into \a binCount bins of \a binWidth nanoseconds
+  each, starting at zero, and returns the number of replots per bin. Replots slower than the
+  covered range are counted in the last bin.
+*/
+QVector<int> QCPReplotStats::histogram(qint64 binWidth, int binCount) const
+{
+  QVector<int> result(qMax(0, binCount), 0);
+  if (binCount <= 0 || binWidth <= 0)
+    return result;
+  for (int i=0; i<mHistory.size(); ++i)
+    ++result[int(qMin(mHistory.at(i)/binWidth, qint64(binCount-1)))];
+  return result;
+}
+
+/*!
+  Returns the replot time below which the given \a fraction (0 to 1) of the replots in the rolling
+  history lie, e.g. 0.99 for the 99th percentile. Returns 0 if the history is empty.
+*/
+qint64 QCPReplotStats::percentile(double fraction) const
+{
+  if (mHistory.isEmpty())
+    return 0;
+  QVector<qint64> sorted = mHistory;
+  const int index = qBound(0, qCeil(fraction*sorted.size())-1, sorted.size()-1);
+  std::nth_element(sorted.begin(), sorted.begin()+index, sorted.end());
+  return sorted.at(index);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCustomPlot
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -12312,6 +13300,14 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   one cell with the main QCPAxisRect inside.
 */
 
+/*! \fn const QCPReplotStats &QCustomPlot::replotStats() const
+  
+  Returns the timings collected during the last replots. The statistics are only updated while
+  replot timing is enabled with \ref setReplotTiming.
+  
+  \see QCPReplotStats
+*/
+
 /* end of documentation of inline functions */
 /* start of documentation of signals */
 
@@ -12613,10 +13609,14 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mSelectionRectMode(QCP::srmNone),
   mSelectionRect(0),
   mOpenGl(false),
+  mTiledRendering(false),
+  mRenderTiles(0),
+  mReplotTiming(false),
   mMouseHasMoved(false),
   mMouseEventLayerable(0),
   mReplotting(false),
   mReplotQueued(false),
+  mReplotSerial(0),
   mOpenGlMultisamples(16),
   mOpenGlAntialiasedElementsBackup(QCP::aeNone),
   mOpenGlCacheLabelsBackup(true)
@@ -13087,6 +14087,50 @@ void QCustomPlot::setOpenGl(bool enabled, int multisampling)
 #endif
 }
 
+/*!
+  Enables or disables tiled software rendering. This increases the painting throughput of large
+  plots on machines without usable graphics hardware.
+
+  If \a enabled is set to true, the paint buffers are QImages (see \ref QCPPaintBufferImage) split
+  into \a tiles horizontal tiles, or as many as there are CPU cores if \a tiles is 0. Plottables
+  which support it (see \ref QCPLayerable::reentrantDraw) are then drawn onto all tiles
+  concurrently, each tile with its own painter. All other layerables, e.g. axes, text and items,
+  are still drawn on the GUI thread.
+
+  If \ref setOpenGl is enabled as well, OpenGL takes precedence.
+
+  \note The tiles are only drawn concurrently if QCustomPlot is compiled with the macro \c
+  QCUSTOMPLOT_USE_CONCURRENT defined, otherwise they are drawn one after another.
+*/
+void QCustomPlot::setTiledRendering(bool enabled, int tiles)
+{
+  mTiledRendering = enabled;
+  mRenderTiles = qMax(0, tiles);
+  // recreate all paint buffers:
+  mPaintBuffers.clear();
+  setupPaintBuffers();
+}
+
+/*!
+  Enables or disables the collection of replot timings. If \a enabled is true, every \ref replot
+  and every widget paint event measure how long their phases took and store the result in the
+  \ref QCPReplotStats object returned by \ref replotStats. \a historySize sets how many of the most
+  recent replot times are kept for histograms and percentiles, see \ref
+  QCPReplotStats::setHistorySize.
+
+  Enabling the timing clears previously collected statistics. The overhead of the measurement is a
+  few clock reads per layer and plottable, it is not incurred while timing is disabled.
+
+  \see replotStats
+*/
+void QCustomPlot::setReplotTiming(bool enabled, int historySize)
+{
+  if (enabled && !mReplotTiming)
+    mReplotStats.clear();
+  mReplotTiming = enabled;
+  mReplotStats.setHistorySize(historySize);
+}
+
 /*!
   Sets the viewport of this QCustomPlot. Usually users of QCustomPlot don't need to change the
   viewport manually.
@@ -14144,15 +15188,65 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     return;
   mReplotting = true;
   mReplotQueued = false;
+  ++mReplotSerial;
   emit beforeReplot();
   
+  QElapsedTimer timer;
+  if (mReplotTiming)
+  {
+    mReplotStats.layerTimes.clear();
+    mReplotStats.plottableTimes.clear();
+    timer.start();
+  }
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mScrollAxisRect)
+      layer->mScrollAxisRect.data()->alignScrollRange();
+  }
   updateLayout();
-  // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers:
+  const qint64 layoutDone = mReplotTiming ? timer.nsecsElapsed() : 0;
+  // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers, with phDirtyLayersOnly only the invalidated buffers:
+  if (mPlottingHints.testFlag(QCP::phDirtyLayersOnly))
+    updateDirtyLayers();
   setupPaintBuffers();
   foreach (QCPLayer *layer, mLayers)
-    layer->drawToPaintBuffer();
+  {
+    if (layer->mScrollAxisRect && layer->mPaintBuffer.data()->invalidated())
+      layer->mScrollAxisRect.data()->setupScrollBuffer();
+  }
+  const qint64 buffersDone = mReplotTiming ? timer.nsecsElapsed() : 0;
+  if (mPlottingHints.testFlag(QCP::phConcurrentLines))
+    preparePlottables();
+  const qint64 prepareDone = mReplotTiming ? timer.nsecsElapsed() : 0;
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (!layer->mPaintBuffer.data()->invalidated())
+      continue;
+    if (mReplotTiming)
+    {
+      const qint64 layerStart = timer.nsecsElapsed();
+      layer->drawToPaintBuffer();
+      mReplotStats.layerTimes.append(QCPReplotStats::Timing(layer->name(), timer.nsecsElapsed()-layerStart));
+    } else
+      layer->drawToPaintBuffer();
+    if (layer->mScrollAxisRect)
+      layer->mScrollAxisRect.data()->finishScrollFrame();
+  }
   for (int i=0; i<mPaintBuffers.size(); ++i)
     mPaintBuffers.at(i)->setInvalidated(false);
+  foreach (QCPLayer *layer, mLayers)
+    layer->mDirty = false;
+  if (mReplotTiming)
+  {
+    const qint64 replotDone = timer.nsecsElapsed();
+    ++mReplotStats.replotCount;
+    mReplotStats.updateLayoutTime = layoutDone;
+    mReplotStats.setupPaintBuffersTime = buffersDone-layoutDone;
+    mReplotStats.prepareTime = prepareDone-buffersDone;
+    mReplotStats.layerDrawTime = replotDone-prepareDone;
+    mReplotStats.replotTime = replotDone;
+    mReplotStats.addToHistory(replotDone);
+  }
   
   if ((refreshPriority == rpRefreshHint && mPlottingHints.testFlag(QCP::phImmediateRefresh)) || refreshPriority==rpImmediateRefresh)
     repaint();
@@ -14453,6 +15547,9 @@ QSize QCustomPlot::sizeHint() const
 void QCustomPlot::paintEvent(QPaintEvent *event)
 {
   Q_UNUSED(event);
+  QElapsedTimer timer;
+  if (mReplotTiming)
+    timer.start();
   QCPPainter painter(this);
   if (painter.isActive())
   {
@@ -14463,6 +15560,8 @@ void QCustomPlot::paintEvent(QPaintEvent *event)
     for (int bufferIndex = 0; bufferIndex < mPaintBuffers.size(); ++bufferIndex)
       mPaintBuffers.at(bufferIndex)->draw(&painter);
   }
+  if (mReplotTiming)
+    mReplotStats.paintEventTime = timer.nsecsElapsed();
 }
 
 /*! \internal
@@ -14781,7 +15880,11 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
   This method uses \ref createPaintBuffer to create new paint buffers.
 
   After this method, the paint buffers are empty (filled with \c Qt::transparent) and invalidated
-  (so an attempt to replot only a single buffered layer causes a full replot).
+  (so an attempt to replot only a single buffered layer causes a full replot). If the plotting
+  hint \ref QCP::phDirtyLayersOnly is set, this only applies to the buffers that must be redrawn:
+  those that were invalidated already, e.g. by reallocation or changed layer association, and
+  those associated with a dirty layer (see \ref QCPLayer::markDirty). The other buffers keep their
+  contents and are not invalidated.
 
   This method is called in every \ref replot call, prior to actually drawing the layers (into their
   associated paint buffer). If the paint buffers don't need changing/reallocating, this method
@@ -14796,6 +15899,7 @@ void QCustomPlot::setupPaintBuffers()
   for (int layerIndex = 0; layerIndex < mLayers.size(); ++layerIndex)
   {
     QCPLayer *layer = mLayers.at(layerIndex);
+    QCPAbstractPaintBuffer *previousBuffer = layer->mPaintBuffer.data();
     if (layer->mode() == QCPLayer::lmLogical)
     {
       layer->mPaintBuffer = mPaintBuffers.at(bufferIndex).toWeakRef();
@@ -14812,26 +15916,104 @@ void QCustomPlot::setupPaintBuffers()
           mPaintBuffers.append(QSharedPointer<QCPAbstractPaintBuffer>(createPaintBuffer()));
       }
     }
+    if (layer->mPaintBuffer.data() != previousBuffer) // both the buffer the layer left and the one it joined have outdated contents
+    {
+      if (previousBuffer)
+        previousBuffer->setInvalidated();
+      layer->mPaintBuffer.data()->setInvalidated();
+    }
   }
   // remove unneeded buffers:
   while (mPaintBuffers.size()-1 > bufferIndex)
     mPaintBuffers.removeLast();
-  // resize buffers to viewport size and clear contents:
+  // the buffers of scrolled layers keep their contents, the axis rect decides what to redraw (see QCPAxisRect::setupScrollBuffer):
+  QSet<QCPAbstractPaintBuffer*> retainedBuffers, dirtyBuffers;
+  foreach (QCPLayer *layer, mLayers)
+  {
+    if (layer->mScrollAxisRect && layer->mode() == QCPLayer::lmBuffered)
+      retainedBuffers.insert(layer->mPaintBuffer.data());
+    if (layer->mDirty)
+      dirtyBuffers.insert(layer->mPaintBuffer.data());
+  }
+  // resize buffers to viewport size and clear contents of the ones that are redrawn:
+  const bool dirtyOnly = mPlottingHints.testFlag(QCP::phDirtyLayersOnly);
   for (int i=0; i<mPaintBuffers.size(); ++i)
   {
-    mPaintBuffers.at(i)->setSize(viewport().size()); // won't do anything if already correct size
-    mPaintBuffers.at(i)->clear(Qt::transparent);
-    mPaintBuffers.at(i)->setInvalidated();
+    QCPAbstractPaintBuffer *buffer = mPaintBuffers.at(i).data();
+    buffer->setSize(viewport().size()); // won't do anything if already correct size, otherwise invalidates the buffer
+    if (!dirtyOnly || buffer->invalidated() || dirtyBuffers.contains(buffer))
+    {
+      if (!retainedBuffers.contains(buffer))
+        buffer->clear(Qt::transparent);
+      buffer->setInvalidated();
+    }
   }
 }
 
 /*! \internal
 
-  This method is used by \ref setupPaintBuffers when it needs to create new paint buffers.
+  Marks those layers dirty (\ref QCPLayer::markDirty), which contain a layerable whose \ref
+  QCPLayerable::drawSignature has changed since the last replot, or can't be determined.
 
-  Depending on the current setting of \ref setOpenGl, and the current Qt version, different
-  backends (subclasses of \ref QCPAbstractPaintBuffer) are created, initialized with the proper
-  size and device pixel ratio, and returned.
+  This is called by \ref replot after the layout was updated, if the plotting hint \ref
+  QCP::phDirtyLayersOnly is set.
+*/
+void QCustomPlot::updateDirtyLayers()
+{
+  foreach (QCPLayer *layer, mLayers)
+  {
+    foreach (QCPLayerable *child, layer->mChildren)
+    {
+      const quint64 signature = child->drawSignature();
+      if (signature == 0 || signature != child->mDrawnSignature)
+      {
+        layer->mDirty = true;
+        child->mDrawnSignature = signature;
+      }
+    }
+  }
+}
+
+/*! \internal
+
+  Lets all visible plottables do their data-to-pixel reduction concurrently on the global thread
+  pool, by calling \ref QCPAbstractPlottable::prepareDraw for each of them. Blocks until all are
+  done, so the subsequent drawing of the layers on the GUI thread only issues the painter calls.
+
+  This is called by \ref replot if the plotting hint \ref QCP::phConcurrentLines is set. Without
+  \c QCUSTOMPLOT_USE_CONCURRENT defined at compile time, it does nothing.
+*/
+void QCustomPlot::preparePlottables()
+{
+#ifdef QCUSTOMPLOT_USE_CONCURRENT
+  QList<QCPAbstractPlottable*> visiblePlottables;
+  foreach (QCPAbstractPlottable *plottable, mPlottables)
+  {
+    if (!plottable->realVisibility() || !plottable->layer() || !plottable->layer()->mPaintBuffer.data()->invalidated()) // only plottables that are drawn in this replot
+      continue;
+    visiblePlottables.append(plottable);
+  }
+  if (visiblePlottables.size() > 1) // a single plottable is prepared fastest by drawing it directly
+    QtConcurrent::blockingMap(visiblePlottables, &QCustomPlot::preparePlottable);
+#endif
+}
+
+/*! \internal
+
+  Worker function of \ref preparePlottables, executed on a thread of the global thread pool.
+*/
+void QCustomPlot::preparePlottable(QCPAbstractPlottable *plottable)
+{
+  plottable->prepareDraw();
+}
+
+/*! \internal
+
+  This method is used by \ref setupPaintBuffers when it needs to create new paint buffers.
+
+  Depending on the current setting of \ref setOpenGl and \ref setTiledRendering, and the current
+  Qt version, different backends (subclasses of \ref QCPAbstractPaintBuffer) are created,
+  initialized with the proper size and device pixel ratio, and returned.
 */
 QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
 {
@@ -14845,7 +16027,9 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 #endif
-  } else
+  } else if (mTiledRendering)
+    return new QCPPaintBufferImage(viewport().size(), mBufferDevicePixelRatio, mRenderTiles);
+  else
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 }
 
@@ -16515,7 +17699,14 @@ QCPAxisRect::QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes) :
   mRangeZoom(Qt::Horizontal|Qt::Vertical),
   mRangeZoomFactorHorz(0.85),
   mRangeZoomFactorVert(0.85),
-  mDragging(false)
+  mDragging(false),
+  mScrollValid(false),
+  mScrollBufferRatio(1.0),
+  mScrollKeySpan(0),
+  mScrollAnchorKey(0),
+  mScrollAnchorPixel(0),
+  mScrollSignature(0),
+  mScrollStripActive(false)
 {
   mInsetLayout->initializeParentPlot(mParentPlot);
   mInsetLayout->setParentLayerable(this);
@@ -17010,6 +18201,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm)
 {
   mBackgroundPixmap = pm;
   mScaledBackgroundPixmap = QPixmap();
+  markDirty();
 }
 
 /*! \overload
@@ -17028,6 +18220,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm)
 void QCPAxisRect::setBackground(const QBrush &brush)
 {
   mBackgroundBrush = brush;
+  markDirty();
 }
 
 /*! \overload
@@ -17043,6 +18236,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioM
   mScaledBackgroundPixmap = QPixmap();
   mBackgroundScaled = scaled;
   mBackgroundScaledMode = mode;
+  markDirty();
 }
 
 /*!
@@ -17058,6 +18252,7 @@ void QCPAxisRect::setBackground(const QPixmap &pm, bool scaled, Qt::AspectRatioM
 void QCPAxisRect::setBackgroundScaled(bool scaled)
 {
   mBackgroundScaled = scaled;
+  markDirty();
 }
 
 /*!
@@ -17068,6 +18263,7 @@ void QCPAxisRect::setBackgroundScaled(bool scaled)
 void QCPAxisRect::setBackgroundScaledMode(Qt::AspectRatioMode mode)
 {
   mBackgroundScaledMode = mode;
+  markDirty();
 }
 
 /*!
@@ -17369,6 +18565,65 @@ void QCPAxisRect::setRangeZoomFactor(double factor)
   mRangeZoomFactorVert = factor;
 }
 
+/*!
+  Turns this axis rect into a scrolling strip chart for the plottables on \a layer. Pass 0 to turn
+  scrolling off again.
+
+  Normally every replot rasterizes all plottables from scratch. With a scroll layer, the image of
+  the layer is kept between replots. When only the range of \a keyAxis has moved, the image is
+  shifted by the according number of pixels and just the newly exposed strip (plus a few pixels of
+  the previous leading edge) is cleared and redrawn. QCPGraph additionally restricts its data to
+  the keys of that strip, so a frame costs O(new points) instead of O(visible points). If \a
+  keyAxis is 0, the bottom axis is used.
+
+  To keep the shifted image and the axis ticks pixel exact, the range of \a keyAxis is snapped to
+  whole pixel steps relative to the previous replot when a replot starts.
+
+  Anything else invalidates the image and causes a full redraw of the layer, e.g. a change of the
+  key range size, of a value axis range, of the axis rect geometry, the visibility or selection of
+  the layer's plottables, or a non-appending change to a graph's data (see \ref
+  QCPDataContainer::revision). Other changes that affect the appearance of the plottables, like a
+  new pen, must be announced with \ref invalidateScrollBuffer.
+
+  \a layer is switched to \ref QCPLayer::lmBuffered, since it needs its own paint buffer. It should
+  only contain plottables of this axis rect. The key axis must have a linear scale.
+
+  Scrolling requires a paint buffer that supports \ref QCPAbstractPaintBuffer::scroll, like the
+  default pixmap buffer. With other buffers, the layer is fully redrawn every replot.
+*/
+void QCPAxisRect::setScrollLayer(QCPLayer *layer, QCPAxis *keyAxis)
+{
+  if (layer && layer->parentPlot() != mParentPlot)
+  {
+    qDebug() << Q_FUNC_INFO << "layer belongs to a different QCustomPlot";
+    return;
+  }
+  if (mScrollLayer && mScrollLayer.data()->mScrollAxisRect.data() == this)
+    mScrollLayer.data()->mScrollAxisRect = 0;
+  mScrollLayer = layer;
+  mScrollKeyAxis = keyAxis ? keyAxis : axis(QCPAxis::atBottom);
+  mScrollValid = false;
+  if (layer)
+  {
+    if (layer->mScrollAxisRect && layer->mScrollAxisRect.data() != this)
+      layer->mScrollAxisRect.data()->setScrollLayer(0);
+    layer->mScrollAxisRect = this;
+    layer->setMode(QCPLayer::lmBuffered);
+  }
+}
+
+/*!
+  Discards the image of the scroll layer kept from the previous replot, so the next replot redraws
+  the layer completely.
+
+  Call this after changing the appearance of the plottables on the scroll layer in a way this axis
+  rect can't detect by itself, see \ref setScrollLayer.
+*/
+void QCPAxisRect::invalidateScrollBuffer()
+{
+  mScrollValid = false;
+}
+
 /*! \internal
   
   Draws the background of this axis rect. It may consist of a background fill (a QBrush) and a
@@ -17411,6 +18666,177 @@ void QCPAxisRect::drawBackground(QCPPainter *painter)
   }
 }
 
+/*! \internal
+
+  Called by \ref QCustomPlot::replot before the layout is updated. If the key axis range has moved
+  by a fractional number of pixels since the last replot, it is snapped to the nearest whole pixel
+  step, so the scrolled image of the scroll layer lines up exactly with the freshly drawn strip and
+  the axis ticks.
+
+  \see setScrollLayer
+*/
+void QCPAxisRect::alignScrollRange()
+{
+  if (!mScrollValid || !scrollKeyAxisUsable() || mRect != mScrollRect)
+    return;
+  QCPAxis *keyAxis = mScrollKeyAxis.data();
+  const QCPRange range = keyAxis->range();
+  if (qAbs(range.size()-mScrollKeySpan) > mScrollKeySpan*1e-9) // zoomed, the layer is redrawn completely anyway
+    return;
+  const double shift = keyAxis->coordToPixel(mScrollAnchorKey)-mScrollAnchorPixel;
+  const double offset = mScrollAnchorKey-keyAxis->pixelToCoord(mScrollAnchorPixel+qRound(shift));
+  if (offset != 0)
+    keyAxis->setRange(range.lower+offset, range.upper+offset);
+}
+
+/*! \internal
+
+  Called by \ref QCustomPlot::replot after the paint buffers were set up. Decides whether the
+  contents of the scroll layer's paint buffer can be reused. If so, shifts them by the number of
+  pixels the key range has moved, and marks the exposed strip for redrawing (\ref
+  mScrollStripRect, \ref mScrollStripKeyRange). Otherwise clears the buffer, so the layer is drawn
+  completely.
+
+  \see setScrollLayer, finishScrollFrame
+*/
+void QCPAxisRect::setupScrollBuffer()
+{
+  mScrollStripActive = false;
+  if (!mScrollLayer || mScrollLayer.data()->mode() != QCPLayer::lmBuffered)
+    return;
+  QCPAbstractPaintBuffer *buffer = mScrollLayer.data()->mPaintBuffer.data();
+  if (!buffer)
+    return;
+  
+  const QRect scrollRect = mRect.translated(0, -1); // plottables are clipped to this rect, see QCPLayer::draw
+  bool reuse = mScrollValid && scrollKeyAxisUsable() &&
+      mScrollBuffer.data() == buffer && buffer->size() == mScrollBufferSize && qFuzzyCompare(buffer->devicePixelRatio(), mScrollBufferRatio) &&
+      mRect == mScrollRect && qAbs(mScrollKeyAxis.data()->range().size()-mScrollKeySpan) <= mScrollKeySpan*1e-9 &&
+      scrollValueRanges() == mScrollValueRanges && scrollSignature() == mScrollSignature;
+  QCPAxis *keyAxis = mScrollKeyAxis.data();
+  const bool horizontal = keyAxis && keyAxis->orientation() == Qt::Horizontal;
+  const int length = horizontal ? scrollRect.width() : scrollRect.height();
+  int shift = 0;
+  if (reuse)
+  {
+    shift = qRound(keyAxis->coordToPixel(mScrollAnchorKey)-mScrollAnchorPixel);
+    reuse = qAbs(shift) < length && buffer->scroll(horizontal ? shift : 0, horizontal ? 0 : shift, scrollRect);
+  }
+  if (!reuse)
+  {
+    buffer->clear(Qt::transparent);
+    return;
+  }
+  
+  // the strip exposed by the shift, plus a few pixels of the previous leading edge, where the last pixel columns may not have had all their data yet:
+  const int overlap = 2;
+  const QCPRange range = keyAxis->range();
+  const bool stripAtMax = shift < 0 || (shift == 0 && keyAxis->coordToPixel(range.upper) > keyAxis->coordToPixel(range.lower));
+  const int stripLength = qMin(length, qAbs(shift)+overlap);
+  const int minEdge = horizontal ? mRect.left() : mRect.top();
+  const int stripStart = stripAtMax ? minEdge+length-stripLength : minEdge;
+  if (horizontal)
+    mScrollStripRect = QRect(stripStart, scrollRect.top(), stripLength, scrollRect.height());
+  else
+    mScrollStripRect = QRect(scrollRect.left(), stripStart-1, scrollRect.width(), stripLength);
+  mScrollStripKeyRange = QCPRange(keyAxis->pixelToCoord(stripStart), keyAxis->pixelToCoord(stripStart+stripLength));
+  mScrollStripKeyRange.normalize();
+  mScrollStripActive = true;
+}
+
+/*! \internal
+
+  Called by \ref QCustomPlot::replot after all layers were drawn. Remembers the state the scroll
+  layer's paint buffer was drawn with, for the decisions of the next replot.
+
+  \see setupScrollBuffer
+*/
+void QCPAxisRect::finishScrollFrame()
+{
+  mScrollStripActive = false;
+  QCPAbstractPaintBuffer *buffer = mScrollLayer ? mScrollLayer.data()->mPaintBuffer.data() : 0;
+  mScrollValid = buffer && mScrollLayer.data()->mode() == QCPLayer::lmBuffered && scrollKeyAxisUsable();
+  if (!mScrollValid)
+    return;
+  
+  const QCPRange range = mScrollKeyAxis.data()->range();
+  mScrollBuffer = mScrollLayer.data()->mPaintBuffer;
+  mScrollBufferSize = buffer->size();
+  mScrollBufferRatio = buffer->devicePixelRatio();
+  mScrollRect = mRect;
+  mScrollKeySpan = range.size();
+  mScrollAnchorKey = range.lower;
+  mScrollAnchorPixel = mScrollKeyAxis.data()->coordToPixel(range.lower);
+  mScrollValueRanges = scrollValueRanges();
+  mScrollSignature = scrollSignature();
+}
+
+/*! \internal
+
+  Returns whether the scroll key axis allows reusing the scrolled image, i.e. it exists, belongs to
+  this axis rect and has a linear scale.
+*/
+bool QCPAxisRect::scrollKeyAxisUsable() const
+{
+  return mScrollKeyAxis && mScrollKeyAxis.data()->axisRect() == this && mScrollKeyAxis.data()->scaleType() == QCPAxis::stLinear;
+}
+
+/*! \internal
+
+  Returns the ranges of all axes of this axis rect that are perpendicular to the scroll key axis.
+  The scrolled image is only valid as long as they don't change.
+*/
+QList<QCPRange> QCPAxisRect::scrollValueRanges() const
+{
+  QList<QCPRange> result;
+  if (!mScrollKeyAxis)
+    return result;
+  foreach (QCPAxis *axis, axes())
+  {
+    if (axis->orientation() != mScrollKeyAxis.data()->orientation())
+      result.append(axis->range());
+  }
+  return result;
+}
+
+/*! \internal
+
+  Returns a hash over the state of the scroll layer's layerables that the scrolled image depends on
+  and that can change without a range or geometry change: which layerables are on the layer, their
+  visibility and selection, and the identity and revision of the data container a graph plots,
+  its column container (\ref QCPGraph::setColumnData) if it has one. Appending data and evicting
+  it from the front don't change the revision, so a growing graph doesn't invalidate the image.
+  Only if a column container evicted data points that were still inside the key range, its \ref
+  QCPGraphColumnContainer::removedFrontCount is included as well, since the image still shows them.
+*/
+uint QCPAxisRect::scrollSignature() const
+{
+  uint result = mScrollLayer.data()->visible() ? 1 : 0;
+  foreach (QCPLayerable *child, mScrollLayer.data()->children())
+  {
+    result = result*31 + qHash(quintptr(child));
+    result = result*31 + (child->realVisibility() ? 1 : 0);
+    if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(child))
+      result = result*31 + (plottable->selected() ? 1 : 0);
+    if (QCPGraph *graph = qobject_cast<QCPGraph*>(child))
+    {
+      if (const QCPGraphColumnContainer *column = graph->columnData().data())
+      {
+        result = result*31 + qHash(quintptr(column));
+        result = result*31 + qHash(column->revision());
+        if (column->removedFrontCount() > 0 && !column->isEmpty() && graph->keyAxis() &&
+            graph->keyAxis()->range().contains(column->key(0)-column->keyStep()))
+          result = result*31 + qHash(column->removedFrontCount());
+      } else
+      {
+        result = result*31 + qHash(quintptr(graph->data().data()));
+        result = result*31 + qHash(graph->data()->revision());
+      }
+    }
+  }
+  return result;
+}
+
 /*! \internal
   
   This function makes sure multiple axes on the side specified with \a type don't collide, but are
@@ -17713,6 +19139,7 @@ QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
 void QCPAbstractLegendItem::setFont(const QFont &font)
 {
   mFont = font;
+  markDirty();
 }
 
 /*!
@@ -17723,6 +19150,7 @@ void QCPAbstractLegendItem::setFont(const QFont &font)
 void QCPAbstractLegendItem::setTextColor(const QColor &color)
 {
   mTextColor = color;
+  markDirty();
 }
 
 /*!
@@ -17734,6 +19162,7 @@ void QCPAbstractLegendItem::setTextColor(const QColor &color)
 void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markDirty();
 }
 
 /*!
@@ -17745,6 +19174,7 @@ void QCPAbstractLegendItem::setSelectedFont(const QFont &font)
 void QCPAbstractLegendItem::setSelectedTextColor(const QColor &color)
 {
   mSelectedTextColor = color;
+  markDirty();
 }
 
 /*!
@@ -17759,6 +19189,7 @@ void QCPAbstractLegendItem::setSelectable(bool selectable)
     mSelectable = selectable;
     emit selectableChanged(mSelectable);
   }
+  markDirty();
 }
 
 /*!
@@ -17776,6 +19207,7 @@ void QCPAbstractLegendItem::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -18066,6 +19498,7 @@ QCPLegend::SelectableParts QCPLegend::selectedParts() const
 void QCPLegend::setBorderPen(const QPen &pen)
 {
   mBorderPen = pen;
+  markDirty();
 }
 
 /*!
@@ -18074,6 +19507,7 @@ void QCPLegend::setBorderPen(const QPen &pen)
 void QCPLegend::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -18093,6 +19527,7 @@ void QCPLegend::setFont(const QFont &font)
     if (item(i))
       item(i)->setFont(mFont);
   }
+  markDirty();
 }
 
 /*!
@@ -18112,6 +19547,7 @@ void QCPLegend::setTextColor(const QColor &color)
     if (item(i))
       item(i)->setTextColor(color);
   }
+  markDirty();
 }
 
 /*!
@@ -18121,6 +19557,7 @@ void QCPLegend::setTextColor(const QColor &color)
 void QCPLegend::setIconSize(const QSize &size)
 {
   mIconSize = size;
+  markDirty();
 }
 
 /*! \overload
@@ -18129,6 +19566,7 @@ void QCPLegend::setIconSize(int width, int height)
 {
   mIconSize.setWidth(width);
   mIconSize.setHeight(height);
+  markDirty();
 }
 
 /*!
@@ -18139,6 +19577,7 @@ void QCPLegend::setIconSize(int width, int height)
 void QCPLegend::setIconTextPadding(int padding)
 {
   mIconTextPadding = padding;
+  markDirty();
 }
 
 /*!
@@ -18150,6 +19589,7 @@ void QCPLegend::setIconTextPadding(int padding)
 void QCPLegend::setIconBorderPen(const QPen &pen)
 {
   mIconBorderPen = pen;
+  markDirty();
 }
 
 /*!
@@ -18215,6 +19655,7 @@ void QCPLegend::setSelectedParts(const SelectableParts &selected)
     mSelectedParts = newSelected;
     emit selectionChanged(mSelectedParts);
   }
+  markDirty();
 }
 
 /*!
@@ -18226,6 +19667,7 @@ void QCPLegend::setSelectedParts(const SelectableParts &selected)
 void QCPLegend::setSelectedBorderPen(const QPen &pen)
 {
   mSelectedBorderPen = pen;
+  markDirty();
 }
 
 /*!
@@ -18236,6 +19678,7 @@ void QCPLegend::setSelectedBorderPen(const QPen &pen)
 void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 {
   mSelectedIconBorderPen = pen;
+  markDirty();
 }
 
 /*!
@@ -18247,6 +19690,7 @@ void QCPLegend::setSelectedIconBorderPen(const QPen &pen)
 void QCPLegend::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -18264,6 +19708,7 @@ void QCPLegend::setSelectedFont(const QFont &font)
     if (item(i))
       item(i)->setSelectedFont(font);
   }
+  markDirty();
 }
 
 /*!
@@ -18281,6 +19726,7 @@ void QCPLegend::setSelectedTextColor(const QColor &color)
     if (item(i))
       item(i)->setSelectedTextColor(color);
   }
+  markDirty();
 }
 
 /*!
@@ -18725,6 +20171,7 @@ QCPTextElement::QCPTextElement(QCustomPlot *parentPlot, const QString &text, con
 void QCPTextElement::setText(const QString &text)
 {
   mText = text;
+  markDirty();
 }
 
 /*!
@@ -18750,6 +20197,7 @@ void QCPTextElement::setText(const QString &text)
 void QCPTextElement::setTextFlags(int flags)
 {
   mTextFlags = flags;
+  markDirty();
 }
 
 /*!
@@ -18760,6 +20208,7 @@ void QCPTextElement::setTextFlags(int flags)
 void QCPTextElement::setFont(const QFont &font)
 {
   mFont = font;
+  markDirty();
 }
 
 /*!
@@ -18770,6 +20219,7 @@ void QCPTextElement::setFont(const QFont &font)
 void QCPTextElement::setTextColor(const QColor &color)
 {
   mTextColor = color;
+  markDirty();
 }
 
 /*!
@@ -18780,6 +20230,7 @@ void QCPTextElement::setTextColor(const QColor &color)
 void QCPTextElement::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markDirty();
 }
 
 /*!
@@ -18790,6 +20241,7 @@ void QCPTextElement::setSelectedFont(const QFont &font)
 void QCPTextElement::setSelectedTextColor(const QColor &color)
 {
   mSelectedTextColor = color;
+  markDirty();
 }
 
 /*!
@@ -18805,6 +20257,7 @@ void QCPTextElement::setSelectable(bool selectable)
     mSelectable = selectable;
     emit selectableChanged(mSelectable);
   }
+  markDirty();
 }
 
 /*!
@@ -18821,6 +20274,7 @@ void QCPTextElement::setSelected(bool selected)
     mSelected = selected;
     emit selectionChanged(mSelected);
   }
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -19118,6 +20572,7 @@ bool QCPColorScale::rangeZoom() const
 */
 void QCPColorScale::setType(QCPAxis::AxisType type)
 {
+  markDirty();
   if (!mAxisRect)
   {
     qDebug() << Q_FUNC_INFO << "internal axis rect was deleted";
@@ -19179,6 +20634,7 @@ void QCPColorScale::setDataRange(const QCPRange &dataRange)
       mColorAxis.data()->setRange(mDataRange);
     emit dataRangeChanged(mDataRange);
   }
+  markDirty();
 }
 
 /*!
@@ -19202,6 +20658,7 @@ void QCPColorScale::setDataScaleType(QCPAxis::ScaleType scaleType)
       setDataRange(mDataRange.sanitizedForLogScale());
     emit dataScaleTypeChanged(mDataScaleType);
   }
+  markDirty();
 }
 
 /*!
@@ -19220,6 +20677,7 @@ void QCPColorScale::setGradient(const QCPColorGradient &gradient)
       mAxisRect.data()->mGradientImageInvalidated = true;
     emit gradientChanged(mGradient);
   }
+  markDirty();
 }
 
 /*!
@@ -19228,6 +20686,7 @@ void QCPColorScale::setGradient(const QCPColorGradient &gradient)
 */
 void QCPColorScale::setLabel(const QString &str)
 {
+  markDirty();
   if (!mColorAxis)
   {
     qDebug() << Q_FUNC_INFO << "internal color axis undefined";
@@ -19244,6 +20703,7 @@ void QCPColorScale::setLabel(const QString &str)
 void QCPColorScale::setBarWidth(int width)
 {
   mBarWidth = width;
+  markDirty();
 }
 
 /*!
@@ -19402,6 +20862,18 @@ void QCPColorScale::update(UpdatePhase phase)
   }
 }
 
+/*!
+  Also marks the internal axis rect dirty, which draws the color gradient.
+
+  \seebaseclassmethod
+*/
+void QCPColorScale::markDirty()
+{
+  QCPLayoutElement::markDirty();
+  if (mAxisRect)
+    mAxisRect.data()->markDirty();
+}
+
 /* inherits documentation from base class */
 void QCPColorScale::applyDefaultAntialiasingHint(QCPPainter *painter) const
 {
@@ -19708,10 +21180,1164 @@ QCPGraphData::QCPGraphData() :
 /*!
   Constructs a data point with the specified \a key and \a value.
 */
-QCPGraphData::QCPGraphData(double key, double value) :
-  key(key),
-  value(value)
+QCPGraphData::QCPGraphData(double key, double value) :
+  key(key),
+  value(value)
+{
+}
+
+
+/*! \internal
+
+  Signature of the kernels that reduce the values of the contiguous, non-empty data range [\a begin,
+  \a end) to their minimum and maximum. All kernels behave like the plain comparison loop in \ref
+  qcpValueMinMaxScalar: NaN values are skipped, unless the very first value is NaN, in which case
+  both results are NaN.
+*/
+typedef void (*QCPValueMinMaxFunction)(const QCPGraphData *begin, const QCPGraphData *end, double &minValue, double &maxValue);
+
+Q_STATIC_ASSERT(sizeof(QCPGraphData) == 2*sizeof(double)); // the vector kernels read key/value pairs as a flat double array
+
+/*! \internal
+
+  Widens the running extrema \a lower and \a upper by the values of [\a begin, \a end) one point
+  at a time. Used by \ref qcpValueMinMaxScalar and for the remainder of the vectorized kernels.
+*/
+static inline void qcpValueMinMaxAccumulate(const QCPGraphData *begin, const QCPGraphData *end, double &lower, double &upper)
+{
+  for (const QCPGraphData *it = begin; it < end; ++it)
+  {
+    if (it->value < lower)
+      lower = it->value;
+    else if (it->value > upper)
+      upper = it->value;
+  }
+}
+
+/*! \internal
+
+  Portable reference implementation of \ref QCPValueMinMaxFunction.
+*/
+static void qcpValueMinMaxScalar(const QCPGraphData *begin, const QCPGraphData *end, double &minValue, double &maxValue)
+{
+  minValue = begin->value;
+  maxValue = begin->value;
+  qcpValueMinMaxAccumulate(begin+1, end, minValue, maxValue);
+}
+
+#ifdef QCP_SIMD_X86
+/*! \internal
+
+  SSE2 implementation of \ref QCPValueMinMaxFunction, processes four data points per iteration.
+
+  MINPD/MAXPD return their second operand if either operand is NaN. Passing the accumulator as
+  second operand therefore skips NaN data values and keeps a NaN start value, like the scalar loop.
+*/
+__attribute__((target("sse2")))
+static void qcpValueMinMaxSse2(const QCPGraphData *begin, const QCPGraphData *end, double &minValue, double &maxValue)
+{
+  __m128d lower = _mm_set1_pd(begin->value);
+  __m128d upper = lower;
+  const QCPGraphData *it = begin+1;
+  for (; end-it >= 4; it += 4)
+  {
+    const double *d = &it->key;
+    const __m128d values01 = _mm_unpackhi_pd(_mm_loadu_pd(d), _mm_loadu_pd(d+2));
+    const __m128d values23 = _mm_unpackhi_pd(_mm_loadu_pd(d+4), _mm_loadu_pd(d+6));
+    lower = _mm_min_pd(values01, lower);
+    upper = _mm_max_pd(values01, upper);
+    lower = _mm_min_pd(values23, lower);
+    upper = _mm_max_pd(values23, upper);
+  }
+  lower = _mm_min_sd(_mm_unpackhi_pd(lower, lower), lower);
+  upper = _mm_max_sd(_mm_unpackhi_pd(upper, upper), upper);
+  minValue = _mm_cvtsd_f64(lower);
+  maxValue = _mm_cvtsd_f64(upper);
+  qcpValueMinMaxAccumulate(it, end, minValue, maxValue);
+}
+
+/*! \internal
+
+  AVX2 implementation of \ref QCPValueMinMaxFunction, processes eight data points per iteration
+  with two independent accumulator pairs. See \ref qcpValueMinMaxSse2 for the NaN handling.
+*/
+__attribute__((target("avx2")))
+static void qcpValueMinMaxAvx2(const QCPGraphData *begin, const QCPGraphData *end, double &minValue, double &maxValue)
+{
+  __m256d lowerA = _mm256_set1_pd(begin->value);
+  __m256d upperA = lowerA;
+  __m256d lowerB = lowerA;
+  __m256d upperB = lowerA;
+  const QCPGraphData *it = begin+1;
+  for (; end-it >= 8; it += 8)
+  {
+    const double *d = &it->key;
+    const __m256d valuesA = _mm256_unpackhi_pd(_mm256_loadu_pd(d), _mm256_loadu_pd(d+4));
+    const __m256d valuesB = _mm256_unpackhi_pd(_mm256_loadu_pd(d+8), _mm256_loadu_pd(d+12));
+    lowerA = _mm256_min_pd(valuesA, lowerA);
+    upperA = _mm256_max_pd(valuesA, upperA);
+    lowerB = _mm256_min_pd(valuesB, lowerB);
+    upperB = _mm256_max_pd(valuesB, upperB);
+  }
+  lowerA = _mm256_min_pd(lowerB, lowerA);
+  upperA = _mm256_max_pd(upperB, upperA);
+  __m128d lower = _mm_min_pd(_mm256_extractf128_pd(lowerA, 1), _mm256_castpd256_pd128(lowerA));
+  __m128d upper = _mm_max_pd(_mm256_extractf128_pd(upperA, 1), _mm256_castpd256_pd128(upperA));
+  lower = _mm_min_sd(_mm_unpackhi_pd(lower, lower), lower);
+  upper = _mm_max_sd(_mm_unpackhi_pd(upper, upper), upper);
+  minValue = _mm_cvtsd_f64(lower);
+  maxValue = _mm_cvtsd_f64(upper);
+  qcpValueMinMaxAccumulate(it, end, minValue, maxValue);
+}
+#endif // QCP_SIMD_X86
+
+#ifdef QCUSTOMPLOT_CHECK_DATA
+/*! \internal
+
+  Returns whether the extrema \a a and \a b found by two kernels agree, NaN agreeing with NaN.
+*/
+static inline bool qcpSameExtremum(double a, double b)
+{
+  return a == b || (qIsNaN(a) && qIsNaN(b));
+}
+
+/*! \internal
+
+  Compares \a kernel with \ref qcpValueMinMaxScalar for every length up to several vector
+  iterations plus remainder, on values without NaN, with a NaN first value, with NaN values spread
+  over the vectors and the remainder, and with only the first value not NaN. Differences are
+  reported with qDebug. Only compiled with \c QCUSTOMPLOT_CHECK_DATA, where it runs once when
+  the kernel is selected.
+*/
+static void qcpCheckValueMinMax(QCPValueMinMaxFunction kernel)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  QVector<QCPGraphData> data(40);
+  for (int pattern=0; pattern<4; ++pattern)
+  {
+    for (int i=0; i<data.size(); ++i)
+      data[i] = QCPGraphData(i, qSin(i*1.7)*(i+1)); // extrema at varying positions within the vectors
+    if (pattern == 1)
+      data[0].value = nan;
+    else if (pattern == 2)
+      for (int i=3; i<data.size(); i+=5) data[i].value = nan;
+    else if (pattern == 3)
+      for (int i=1; i<data.size(); ++i) data[i].value = nan;
+    for (int count=1; count<=data.size(); ++count)
+    {
+      double minValue, maxValue, scalarMin, scalarMax;
+      kernel(data.constData(), data.constData()+count, minValue, maxValue);
+      qcpValueMinMaxScalar(data.constData(), data.constData()+count, scalarMin, scalarMax);
+      if (!qcpSameExtremum(minValue, scalarMin) || !qcpSameExtremum(maxValue, scalarMax))
+        qDebug() << Q_FUNC_INFO << "kernel differs from the scalar loop for pattern" << pattern << "and" << count << "points:" << minValue << maxValue << "instead of" << scalarMin << scalarMax;
+    }
+  }
+}
+#endif // QCUSTOMPLOT_CHECK_DATA
+
+/*! \internal
+
+  Returns the fastest \ref QCPValueMinMaxFunction the executing CPU supports. The choice is made
+  at runtime, so one binary runs on every x86 CPU and uses AVX2 where available.
+*/
+static QCPValueMinMaxFunction qcpSelectValueMinMax()
+{
+  QCPValueMinMaxFunction kernel = qcpValueMinMaxScalar;
+#ifdef QCP_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    kernel = qcpValueMinMaxAvx2;
+  else if (__builtin_cpu_supports("sse2"))
+    kernel = qcpValueMinMaxSse2;
+#endif
+#ifdef QCUSTOMPLOT_CHECK_DATA
+  qcpCheckValueMinMax(kernel);
+#endif
+  return kernel;
+}
+
+/*! \internal
+
+  Reduces the values of the data range [\a begin, \a end), which must not be empty, to their
+  minimum and maximum with the kernel selected by \ref qcpSelectValueMinMax.
+*/
+static void qcpValueMinMax(const QCPGraphData *begin, const QCPGraphData *end, double &minValue, double &maxValue)
+{
+  static const QCPValueMinMaxFunction kernel = qcpSelectValueMinMax();
+  kernel(begin, end, minValue, maxValue);
+}
+
+/*! \internal
+
+  Returns the first data point in the sorted range [\a begin, \a end) whose key is not smaller
+  than \a key. The search gallops forward from \a begin, so it costs O(log k) when the result is
+  k points away, which is cheaper than a binary search over the whole range for the short pixel
+  intervals of adaptive sampling.
+*/
+static QCPGraphDataContainer::const_iterator qcpGallopToKey(QCPGraphDataContainer::const_iterator begin, const QCPGraphDataContainer::const_iterator &end, double key)
+{
+  int step = 1;
+  while (end-begin > step && (begin+step)->key < key)
+  {
+    begin += step;
+    step *= 2;
+  }
+  QCPGraphDataContainer::const_iterator upper = end-begin > step ? begin+step+1 : end;
+  return std::lower_bound(begin, upper, QCPGraphData::fromSortKey(key), qcpLessThanSortKey<QCPGraphData>);
+}
+
+
+/*! \internal
+
+  Converts \a value to the storage type \a T of a \ref QCPGraphColumnContainer. Integer types are
+  rounded and saturated, NaN becomes zero.
+*/
+template <typename T>
+static inline T qcpColumnSaturate(double value)
+{
+  if (qIsNaN(value))
+    return 0;
+  if (value <= double(std::numeric_limits<T>::min()))
+    return std::numeric_limits<T>::min();
+  if (value >= double(std::numeric_limits<T>::max()))
+    return std::numeric_limits<T>::max();
+  return T(qRound64(value));
+}
+
+template <>
+inline float qcpColumnSaturate<float>(double value)
+{
+  return float(value);
+}
+
+/*! \internal
+
+  Stores the \a count values of \a source in \a target as <tt>(value-offset)/scale</tt>. Values of
+  the storage type itself are copied unchanged, if no scaling is applied.
+*/
+template <typename Target, typename Source>
+static void qcpColumnConvert(Target *target, const Source *source, int count, double scale, double offset)
+{
+  if (sizeof(Target) == sizeof(Source) && std::numeric_limits<Target>::is_integer == std::numeric_limits<Source>::is_integer && scale == 1 && offset == 0)
+  {
+    memcpy(target, source, size_t(count)*sizeof(Target));
+    return;
+  }
+  for (int i=0; i<count; ++i)
+    target[i] = qcpColumnSaturate<Target>((double(source[i])-offset)/scale);
+}
+
+/*! \internal
+
+  Stores \a count values of \a source in the value column memory \a target, which holds values of
+  \a valueType. See \ref qcpColumnConvert.
+*/
+template <typename Source>
+static void qcpColumnStore(QCPGraphColumnContainer::ValueType valueType, char *target, const Source *source, int count, double scale, double offset)
+{
+  switch (valueType)
+  {
+    case QCPGraphColumnContainer::vtFloat32: qcpColumnConvert(reinterpret_cast<float*>(target), source, count, scale, offset); break;
+    case QCPGraphColumnContainer::vtInt32: qcpColumnConvert(reinterpret_cast<qint32*>(target), source, count, scale, offset); break;
+    case QCPGraphColumnContainer::vtInt16: qcpColumnConvert(reinterpret_cast<qint16*>(target), source, count, scale, offset); break;
+  }
+}
+
+/*! \internal
+
+  Signature of the kernels that reduce the float values of [\a begin, \a end) to their minimum and
+  maximum, skipping NaN values. They return false if there was no value that isn't NaN.
+*/
+typedef bool (*QCPFloatMinMaxFunction)(const float *begin, const float *end, float &minValue, float &maxValue);
+
+/*! \internal
+
+  Portable reference implementation of \ref QCPFloatMinMaxFunction. Starting at infinity makes
+  every comparison with a NaN value fail, so NaN values are skipped.
+*/
+static bool qcpFloatMinMaxScalar(const float *begin, const float *end, float &minValue, float &maxValue)
+{
+  float lower = std::numeric_limits<float>::infinity();
+  float upper = -lower;
+  for (const float *it = begin; it < end; ++it)
+  {
+    if (*it < lower)
+      lower = *it;
+    if (*it > upper)
+      upper = *it;
+  }
+  minValue = lower;
+  maxValue = upper;
+  return lower <= upper;
+}
+
+#ifdef QCP_SIMD_X86
+/*! \internal
+
+  SSE2 implementation of \ref QCPFloatMinMaxFunction, processes eight values per iteration. As in
+  \ref qcpValueMinMaxSse2, the accumulator is the second operand of MINPS/MAXPS, so NaN values are
+  skipped.
+*/
+__attribute__((target("sse2")))
+static bool qcpFloatMinMaxSse2(const float *begin, const float *end, float &minValue, float &maxValue)
+{
+  __m128 lowerA = _mm_set1_ps(std::numeric_limits<float>::infinity());
+  __m128 upperA = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+  __m128 lowerB = lowerA;
+  __m128 upperB = upperA;
+  const float *it = begin;
+  for (; end-it >= 8; it += 8)
+  {
+    const __m128 valuesA = _mm_loadu_ps(it);
+    const __m128 valuesB = _mm_loadu_ps(it+4);
+    lowerA = _mm_min_ps(valuesA, lowerA);
+    upperA = _mm_max_ps(valuesA, upperA);
+    lowerB = _mm_min_ps(valuesB, lowerB);
+    upperB = _mm_max_ps(valuesB, upperB);
+  }
+  lowerA = _mm_min_ps(lowerB, lowerA);
+  upperA = _mm_max_ps(upperB, upperA);
+  lowerA = _mm_min_ps(_mm_movehl_ps(lowerA, lowerA), lowerA);
+  upperA = _mm_max_ps(_mm_movehl_ps(upperA, upperA), upperA);
+  lowerA = _mm_min_ss(_mm_shuffle_ps(lowerA, lowerA, 1), lowerA);
+  upperA = _mm_max_ss(_mm_shuffle_ps(upperA, upperA, 1), upperA);
+  float lower = _mm_cvtss_f32(lowerA);
+  float upper = _mm_cvtss_f32(upperA);
+  for (; it < end; ++it)
+  {
+    if (*it < lower)
+      lower = *it;
+    if (*it > upper)
+      upper = *it;
+  }
+  minValue = lower;
+  maxValue = upper;
+  return lower <= upper;
+}
+#endif // QCP_SIMD_X86
+
+#ifdef QCUSTOMPLOT_CHECK_DATA
+/*! \internal
+
+  Compares \a kernel with \ref qcpFloatMinMaxScalar like \ref qcpCheckValueMinMax, including
+  empty ranges and ranges of only NaN values, for which both must return false.
+*/
+static void qcpCheckFloatMinMax(QCPFloatMinMaxFunction kernel)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  QVector<float> data(40);
+  for (int pattern=0; pattern<4; ++pattern)
+  {
+    for (int i=0; i<data.size(); ++i)
+      data[i] = float(qSin(i*1.7)*(i+1));
+    if (pattern == 1)
+      data[0] = nan;
+    else if (pattern == 2)
+      for (int i=3; i<data.size(); i+=5) data[i] = nan;
+    else if (pattern == 3)
+      data.fill(nan);
+    for (int count=0; count<=data.size(); ++count)
+    {
+      float minValue = 0, maxValue = 0, scalarMin = 0, scalarMax = 0;
+      const bool found = kernel(data.constData(), data.constData()+count, minValue, maxValue);
+      const bool scalarFound = qcpFloatMinMaxScalar(data.constData(), data.constData()+count, scalarMin, scalarMax);
+      if (found != scalarFound || (found && (minValue != scalarMin || maxValue != scalarMax)))
+        qDebug() << Q_FUNC_INFO << "kernel differs from the scalar loop for pattern" << pattern << "and" << count << "values:" << found << minValue << maxValue << "instead of" << scalarFound << scalarMin << scalarMax;
+    }
+  }
+}
+#endif // QCUSTOMPLOT_CHECK_DATA
+
+/*! \internal
+
+  Returns the fastest \ref QCPFloatMinMaxFunction the executing CPU supports.
+*/
+static QCPFloatMinMaxFunction qcpSelectFloatMinMax()
+{
+  QCPFloatMinMaxFunction kernel = qcpFloatMinMaxScalar;
+#ifdef QCP_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    kernel = qcpFloatMinMaxSse2;
+#endif
+#ifdef QCUSTOMPLOT_CHECK_DATA
+  qcpCheckFloatMinMax(kernel);
+#endif
+  return kernel;
+}
+
+/*! \internal
+
+  Reduces the float values of [\a begin, \a end) with the kernel selected by \ref
+  qcpSelectFloatMinMax.
+*/
+static bool qcpFloatMinMax(const float *begin, const float *end, float &minValue, float &maxValue)
+{
+  static const QCPFloatMinMaxFunction kernel = qcpSelectFloatMinMax();
+  return kernel(begin, end, minValue, maxValue);
+}
+
+/*! \internal
+
+  Widens the raw value extrema in \a result by the \a count values of type \a T at \a data, which
+  are \a stride bytes apart. NaN values are skipped, since every comparison with them fails.
+*/
+template <typename T>
+static void qcpStridedMinMax(const char *data, int stride, int count, QCPValueExtrema &result)
+{
+  double lower = result.minValue;
+  double upper = result.maxValue;
+  for (int i=0; i<count; ++i, data += stride)
+  {
+    const double value = *reinterpret_cast<const T*>(data);
+    if (value < lower)
+      lower = value;
+    if (value > upper)
+      upper = value;
+  }
+  result.minValue = lower;
+  result.maxValue = upper;
+}
+
+/*! \internal
+
+  Reduces the non-empty integer range [\a begin, \a end) to its minimum and maximum. The loop has
+  no data dependent branches, so the compiler vectorizes it.
+*/
+template <typename T>
+static void qcpIntMinMax(const T *begin, const T *end, double &minValue, double &maxValue)
+{
+  T lower = *begin;
+  T upper = *begin;
+  for (const T *it = begin+1; it < end; ++it)
+  {
+    lower = qMin(lower, *it);
+    upper = qMax(upper, *it);
+  }
+  minValue = lower;
+  maxValue = upper;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPGraphColumnContainer
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPGraphColumnContainer
+  \brief A compact, column-oriented data container for graphs with evenly spaced keys
+
+  \ref QCPGraphDataContainer stores every data point as a pair of doubles, 16 bytes per point. For
+  signals sampled at a fixed rate, like the cyclic process data of a field bus, the keys carry no
+  information: the key of the data point with index \a i is simply <tt>origin + i*step</tt> (see
+  \ref setKeys). This container therefore only stores the values, in a single contiguous column of
+  4 byte floats or 4/2 byte integers (see \ref ValueType). The plotted value is the stored value
+  times the value scale plus the value offset (\ref setValueScale), which allows storing raw
+  fixed-point process data together with its physical scaling.
+
+  This cuts the memory per data point to 2 to 4 bytes, and the value extrema of a pixel interval are
+  computed by streaming through one array, with the interval bounds found by index arithmetic
+  instead of a search.
+
+  Values are appended with the \ref add overloads. For strip charts, the container can be limited
+  to a number of data points with \ref setRingCapacity, or to a key span with \ref
+  setRingKeySpan. It then stores its values in a ring that is mirrored into a second copy right
+  behind it, so every window of the ring is contiguous in memory: appending costs two stores per
+  value, the oldest values are evicted by moving the start of the window, and no value is ever
+  moved later.
+
+  Instead of storing the values itself, the container can also plot values that live in external
+  memory, for example a memory-mapped capture file that is larger than RAM and still growing, see
+  \ref setExternalValues.
+  
+  A graph plots the container instead of its regular data once it is set with \ref
+  QCPGraph::setColumnData. Multiple graphs may share a container.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn double QCPGraphColumnContainer::key(int index) const
+
+  Returns the key of the data point at \a index, <tt>origin + (removedFrontCount() + index)*step</tt>.
+
+  \see setKeys
+*/
+
+/*! \fn quint64 QCPGraphColumnContainer::revision() const
+
+  Returns a number that changes with every modification of the container other than appending
+  values and evicting them from the front, like \ref QCPDataContainer::revision. Changing the keys
+  (\ref setKeys), the value scaling, the ring capacity or the external storage, and clearing the
+  container change it.
+*/
+
+/*! \fn quint64 QCPGraphColumnContainer::removedFrontCount() const
+
+  Returns the number of data points that were evicted from the front of the container since it was
+  last cleared, see \ref setRingCapacity.
+*/
+
+/*! \fn bool QCPGraphColumnContainer::isExternal() const
+
+  Returns whether the container plots values in external memory, see \ref setExternalValues.
+*/
+
+/*! \fn int QCPGraphColumnContainer::stride() const
+
+  Returns the distance in bytes between two consecutive values. It equals \ref bytesPerValue,
+  unless a different stride was passed to \ref setExternalValues.
+*/
+
+/* end documentation of inline functions */
+
+/*!
+  Constructs an empty container which stores its values as \a valueType. The keys start at 0 with
+  a step of 1, the value scale is 1 and the value offset 0.
+*/
+QCPGraphColumnContainer::QCPGraphColumnContainer(ValueType valueType) :
+  mValueType(valueType),
+  mKeyOrigin(0),
+  mKeyStep(1),
+  mValueScale(1),
+  mValueOffset(0),
+  mRingCapacity(0),
+  mRingKeySpan(0),
+  mExternalValues(0),
+  mStride(bytesPerValue()),
+  mRingSlots(0),
+  mFront(0),
+  mSize(0),
+  mRevision(0),
+  mRemovedFrontCount(0)
+{
+}
+
+/*!
+  Sets the implicit keys of the data points. The first data point added after the last \ref clear
+  has the key \a origin, each further data point is \a step larger. \a step must be positive.
+
+  Evicted data points (see \ref setRingCapacity) keep counting, so the keys of the remaining data
+  points don't change by eviction.
+  
+  With a ring key span (\ref setRingKeySpan), the number of data points the ring holds follows the
+  new \a step.
+*/
+void QCPGraphColumnContainer::setKeys(double origin, double step)
+{
+  if (step <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "key step must be positive:" << step;
+    return;
+  }
+  mKeyOrigin = origin;
+  mKeyStep = step;
+  if (mRingKeySpan > 0)
+    updateRing();
+  ++mRevision;
+}
+
+/*!
+  Sets the scaling of the stored values. The plotted value of a stored value \c v is <tt>v*scale +
+  offset</tt>.
+
+  Changing the scaling doesn't modify the stored values, it changes the plotted values of all data
+  points. The values passed to \ref add(const double *values, int count) are converted with the
+  scaling at the time they are added.
+*/
+void QCPGraphColumnContainer::setValueScale(double scale, double offset)
+{
+  if (scale == 0)
+  {
+    qDebug() << Q_FUNC_INFO << "value scale must not be zero";
+    return;
+  }
+  mValueScale = scale;
+  mValueOffset = offset;
+  ++mRevision;
+}
+
+/*!
+  Limits the container to \a capacity data points. When more values are added, the oldest ones are
+  evicted. Set \a capacity to 0 to disable the limit.
+
+  The container's own storage is laid out anew for the ring, which takes time and memory
+  proportional to twice \a capacity once. Adding and evicting values then has a constant cost per
+  value, see the class description.
+  
+  \see setRingKeySpan
+*/
+void QCPGraphColumnContainer::setRingCapacity(int capacity)
+{
+  mRingCapacity = qMax(0, capacity);
+  updateRing();
+  ++mRevision;
+}
+
+/*!
+  Limits the container to the data points whose keys are at most \a keySpan smaller than the key of
+  the newest one. When more values are added, the older ones are evicted. Set \a keySpan to 0 to
+  disable the limit.
+  
+  Since the keys are evenly spaced, the key span amounts to a number of data points, which the ring
+  holds like with \ref setRingCapacity. If both limits are set, the smaller window applies. Changing
+  the key step with \ref setKeys adapts the number of data points, the ring is only laid out anew
+  if it changes.
+*/
+void QCPGraphColumnContainer::setRingKeySpan(double keySpan)
+{
+  mRingKeySpan = qMax(0.0, keySpan);
+  updateRing();
+  ++mRevision;
+}
+
+/*!
+  Makes the container plot the \a count values at \a values instead of its own storage, e.g. one
+  channel of a memory-mapped capture file. The values must have the value type of the container,
+  consecutive values are \a stride bytes apart, so one column of interleaved records can be plotted
+  directly. If \a stride is 0, the values are densely packed.
+  
+  The container doesn't take ownership of the memory, it must stay valid until the container is
+  cleared or given other external values. The external values can't be modified with \ref add.
+  When more values have been appended to the external storage, pass them with \ref
+  extendExternalValues.
+  
+  To keep zoomed-out views of huge data sets fast without reading all values on every replot, the
+  container keeps the extrema of the values in a \ref QCPValuePyramid, like for its own storage
+  (see \ref valueMinMax). For external values, a block is only read the first time its extrema are
+  needed, so this function doesn't touch the values and a capture file larger than RAM is only
+  paged in as far as it is viewed.
+  
+  Call \ref clear to return to the container's own storage.
+*/
+void QCPGraphColumnContainer::setExternalValues(const char *values, int count, int stride)
+{
+  if (!values || count < 0)
+  {
+    qDebug() << Q_FUNC_INFO << "invalid external values" << reinterpret_cast<const void*>(values) << count;
+    return;
+  }
+  clear();
+  mExternalValues = values;
+  mStride = stride > 0 ? stride : bytesPerValue();
+  mSize = count;
+  performRingEviction();
+  updatePyramid();
+}
+
+/*!
+  Tells the container that the external storage set with \ref setExternalValues now holds \a count
+  values at \a values. The values that were already known must be unchanged, only new values may
+  have been appended, but the storage may have moved, e.g. when a growing file was mapped anew.
+  
+  The values themselves are not read here, the extrema of the new blocks are computed when they are
+  first needed, see \ref setExternalValues.
+*/
+void QCPGraphColumnContainer::extendExternalValues(const char *values, int count)
+{
+  if (!mExternalValues)
+  {
+    qDebug() << Q_FUNC_INFO << "container has no external values";
+    return;
+  }
+  if (!values || count < mFront+mSize)
+  {
+    qDebug() << Q_FUNC_INFO << "external values can only grow:" << count << mFront+mSize;
+    return;
+  }
+  mExternalValues = values;
+  mSize = count-mFront;
+  performRingEviction();
+  updatePyramid();
+}
+
+/*!
+  Appends \a count physical \a values, which are converted to the value type of the container with
+  the inverse of the value scaling (\ref setValueScale). Integer value types are rounded and
+  saturated, NaN values are stored as zero since integers can't represent gaps.
+*/
+void QCPGraphColumnContainer::add(const double *values, int count)
+{
+  if (!values || count <= 0)
+    return;
+  if (mExternalValues)
+  {
+    qDebug() << Q_FUNC_INFO << "can't add to external values";
+    return;
+  }
+  const int skipped = skipEvicted(count);
+  qcpColumnStore(mValueType, appendValues(count-skipped), values+skipped, count-skipped, mValueScale, mValueOffset);
+  mirrorValues(count-skipped);
+  updatePyramid();
+}
+
+/*! \overload
+
+  Appends \a count raw \a values, i.e. values which are already stored values, the value scaling
+  (\ref setValueScale) is applied to them when they are plotted. If the value type of the container
+  isn't \ref vtFloat32, they are rounded and saturated.
+*/
+void QCPGraphColumnContainer::add(const float *values, int count)
+{
+  if (!values || count <= 0)
+    return;
+  if (mExternalValues)
+  {
+    qDebug() << Q_FUNC_INFO << "can't add to external values";
+    return;
+  }
+  const int skipped = skipEvicted(count);
+  qcpColumnStore(mValueType, appendValues(count-skipped), values+skipped, count-skipped, 1, 0);
+  mirrorValues(count-skipped);
+  updatePyramid();
+}
+
+/*! \overload
+
+  Appends \a count raw \a values, see \ref add(const float *values, int count).
+*/
+void QCPGraphColumnContainer::add(const qint32 *values, int count)
+{
+  if (!values || count <= 0)
+    return;
+  if (mExternalValues)
+  {
+    qDebug() << Q_FUNC_INFO << "can't add to external values";
+    return;
+  }
+  const int skipped = skipEvicted(count);
+  qcpColumnStore(mValueType, appendValues(count-skipped), values+skipped, count-skipped, 1, 0);
+  mirrorValues(count-skipped);
+  updatePyramid();
+}
+
+/*! \overload
+
+  Appends \a count raw \a values, see \ref add(const float *values, int count).
+*/
+void QCPGraphColumnContainer::add(const qint16 *values, int count)
+{
+  if (!values || count <= 0)
+    return;
+  if (mExternalValues)
+  {
+    qDebug() << Q_FUNC_INFO << "can't add to external values";
+    return;
+  }
+  const int skipped = skipEvicted(count);
+  qcpColumnStore(mValueType, appendValues(count-skipped), values+skipped, count-skipped, 1, 0);
+  mirrorValues(count-skipped);
+  updatePyramid();
+}
+
+/*!
+  Removes all data points. The next data point added has the key origin again (see \ref setKeys).
+  
+  If the container plotted external values (\ref setExternalValues), it lets go of them and uses
+  its own storage again.
+*/
+void QCPGraphColumnContainer::clear()
+{
+  mValues.clear();
+  mExternalValues = 0;
+  mStride = bytesPerValue();
+  mPyramid.clear();
+  mFront = 0;
+  mSize = 0;
+  mRemovedFrontCount = 0;
+  ++mRevision;
+}
+
+/*!
+  Returns the plotted value of the data point at \a index, i.e. the stored value with the value
+  scaling applied. \a index must be valid.
+*/
+double QCPGraphColumnContainer::value(int index) const
+{
+  const char *data = valueData(index);
+  switch (mValueType)
+  {
+    case vtFloat32: return *reinterpret_cast<const float*>(data)*mValueScale + mValueOffset;
+    case vtInt32: return *reinterpret_cast<const qint32*>(data)*mValueScale + mValueOffset;
+    case vtInt16: return *reinterpret_cast<const qint16*>(data)*mValueScale + mValueOffset;
+  }
+  return 0;
+}
+
+/*!
+  Returns the index of the first data point whose key is not smaller than \a key. If \a
+  expandedRange is true, the index of the data point before it is returned instead (if there is
+  one), like \ref QCPDataContainer::findBegin. Since the keys are evenly spaced, this takes
+  constant time.
+
+  \see findEnd
+*/
+int QCPGraphColumnContainer::findBegin(double key, bool expandedRange) const
+{
+  const double position = (key-this->key(0))/mKeyStep;
+  int index = 0;
+  if (position >= mSize)
+    index = mSize;
+  else if (position > 0)
+    index = qCeil(position);
+  if (expandedRange && index > 0)
+    --index;
+  return index;
+}
+
+/*!
+  Returns the index after the last data point whose key is not larger than \a key. If \a
+  expandedRange is true, the index is increased by one (if possible), like \ref
+  QCPDataContainer::findEnd. Since the keys are evenly spaced, this takes constant time.
+
+  \see findBegin
+*/
+int QCPGraphColumnContainer::findEnd(double key, bool expandedRange) const
+{
+  const double position = (key-this->key(0))/mKeyStep;
+  int index = 0;
+  if (position >= mSize)
+    index = mSize;
+  else if (position >= 0)
+    index = qFloor(position)+1;
+  if (expandedRange && index < mSize)
+    ++index;
+  return index;
+}
+
+/*!
+  Returns the range spanned by the keys of the data points, restricted to the keys in \a
+  signDomain. \a foundRange indicates whether there were data points in the sign domain.
+
+  \see QCPDataContainer::keyRange
+*/
+QCPRange QCPGraphColumnContainer::keyRange(bool &foundRange, QCP::SignDomain signDomain) const
+{
+  int begin = 0;
+  int end = mSize;
+  if (signDomain == QCP::sdPositive)
+    begin = findEnd(0, false);
+  else if (signDomain == QCP::sdNegative)
+    end = findBegin(0, false);
+  foundRange = begin < end;
+  return foundRange ? QCPRange(key(begin), key(end-1)) : QCPRange();
+}
+
+/*!
+  Returns the range spanned by the plotted values of the data points, restricted to the values in
+  \a signDomain and, if \a inKeyRange isn't the default QCPRange, to the data points with keys
+  inside \a inKeyRange. NaN values are ignored. \a foundRange indicates whether there were values
+  to consider.
+
+  \see QCPDataContainer::valueRange
+*/
+QCPRange QCPGraphColumnContainer::valueRange(bool &foundRange, QCP::SignDomain signDomain, const QCPRange &inKeyRange) const
+{
+  int begin = 0;
+  int end = mSize;
+  if (inKeyRange != QCPRange())
+  {
+    begin = findBegin(inKeyRange.lower, false);
+    end = findEnd(inKeyRange.upper, false);
+  }
+  double lower = 0, upper = 0;
+  if (signDomain == QCP::sdBoth)
+  {
+    foundRange = valueMinMax(begin, end, lower, upper);
+  } else
+  {
+    foundRange = false;
+    for (int i=begin; i<end; ++i)
+    {
+      const double current = value(i);
+      if (qIsNaN(current) || (signDomain == QCP::sdPositive && current <= 0) || (signDomain == QCP::sdNegative && current >= 0))
+        continue;
+      if (!foundRange || current < lower)
+        lower = current;
+      if (!foundRange || current > upper)
+        upper = current;
+      foundRange = true;
+    }
+  }
+  return foundRange ? QCPRange(lower, upper) : QCPRange();
+}
+
+/*!
+  Reduces the plotted values of the data points in the index range [\a begin, \a end) to their
+  minimum \a minValue and maximum \a maxValue, skipping NaN values. Returns false if the range is
+  empty or only contains NaN values.
+
+  The stored values are reduced in their own type and only the two results are scaled. Only the
+  values of the partial blocks of 64 values at both ends of the range are read, streaming through
+  the value column with vectorized kernels where available. The complete blocks in between are
+  combined from the value pyramid (see \ref QCPValuePyramid) in O(log N), which the container
+  keeps up to date while values are added and evicted.
+  
+  For external values (\ref setExternalValues), the extrema of blocks that weren't needed before
+  are read once to store them in the pyramid. This is done under a lock, so graphs sharing the
+  container may call this from several threads at once, e.g. in \ref
+  QCustomPlot::preparePlottables.
+*/
+bool QCPGraphColumnContainer::valueMinMax(int begin, int end, double &minValue, double &maxValue) const
+{
+  begin = qMax(begin, 0);
+  end = qMin(end, mSize);
+  if (begin >= end)
+    return false;
+  QCPValueExtrema result = QCPValuePyramid::emptyExtrema();
+  const qint64 blockSize = Q_INT64_C(1) << BlockShift;
+  const qint64 base = qint64(mRemovedFrontCount);
+  const qint64 first = (base+begin+blockSize-1) >> BlockShift; // first complete block
+  const qint64 last = (base+end) >> BlockShift; // block after the last complete block
+  if (first < last)
+  {
+    expandMinMax(begin, int((first << BlockShift)-base), result);
+    if (mExternalValues)
+    {
+      QMutexLocker locker(&mPyramidMutex);
+      BlockReader reader = {this};
+      mPyramid.expand(result, first, last, reader);
+    } else
+      mPyramid.expand(result, first, last); // the own storage fills the pyramid when values are added
+    expandMinMax(int((last << BlockShift)-base), end, result);
+  } else
+    expandMinMax(begin, end, result);
+  if (!(result.minValue <= result.maxValue))
+    return false;
+  double lower = result.minValue*mValueScale + mValueOffset;
+  double upper = result.maxValue*mValueScale + mValueOffset;
+  if (mValueScale < 0)
+    qSwap(lower, upper);
+  minValue = lower;
+  maxValue = upper;
+  return true;
+}
+
+/*!
+  Returns the number of bytes one stored value takes, as given by the value type.
+*/
+int QCPGraphColumnContainer::bytesPerValue() const
+{
+  switch (mValueType)
+  {
+    case vtFloat32: return 4;
+    case vtInt32: return 4;
+    case vtInt16: return 2;
+  }
+  return 4;
+}
+
+/*! \internal
+
+  Returns the number of data points the ring holds as given by the ring capacity (\ref
+  setRingCapacity) and the ring key span (\ref setRingKeySpan), or 0 if neither is set.
+*/
+int QCPGraphColumnContainer::ringWindow() const
+{
+  int window = mRingCapacity;
+  if (mRingKeySpan > 0)
+  {
+    const int spanWindow = int(qMin(mRingKeySpan/mKeyStep, double(std::numeric_limits<int>::max()/4)))+1;
+    window = window > 0 ? qMin(window, spanWindow) : spanWindow;
+  }
+  return window;
+}
+
+/*! \internal
+
+  Applies a changed \ref ringWindow. External values are evicted by moving the start of the window.
+  The container's own storage is laid out anew for the new ring size, keeping the newest values
+  that fit at the start of the new storage.
+*/
+void QCPGraphColumnContainer::updateRing()
+{
+  const int slots = ringWindow();
+  if (mExternalValues)
+  {
+    mRingSlots = slots;
+    performRingEviction();
+    updatePyramid();
+    return;
+  }
+  if (slots == mRingSlots)
+    return;
+  const int kept = slots > 0 ? qMin(mSize, slots) : mSize;
+  const int bytes = bytesPerValue();
+  QByteArray values;
+  values.resize((slots > 0 ? 2*slots : kept)*bytes);
+  if (kept > 0)
+    memcpy(values.data(), valueData(mSize-kept), size_t(kept)*bytes);
+  mValues.swap(values);
+  mRemovedFrontCount += mSize-kept;
+  mFront = 0;
+  mSize = kept;
+  mRingSlots = slots;
+  mirrorValues(kept);
+  updatePyramid();
+}
+
+/*! \internal
+
+  Grows the value column by \a count values and returns a pointer to the first new value.
+
+  Without ring capacity, the storage grows geometrically, so appending is amortized constant time
+  per value. In a ring (\ref setRingCapacity), \a count must not exceed the capacity (see \ref
+  skipEvicted). The oldest values are evicted first to make room, and the new values are placed
+  right behind the remaining ones, which is contiguous thanks to the mirrored copy. Call \ref
+  mirrorValues once they are stored.
+*/
+char *QCPGraphColumnContainer::appendValues(int count)
+{
+  const int bytes = bytesPerValue();
+  if (mRingSlots <= 0)
+  {
+    const int oldBytes = mValues.size();
+    mValues.resize(oldBytes + count*bytes);
+    mSize += count;
+    return mValues.data() + oldBytes;
+  }
+  
+  if (mValues.size() != 2*mRingSlots*bytes) // first values after a clear
+    mValues.resize(2*mRingSlots*bytes);
+  const int excess = mSize+count-mRingSlots;
+  if (excess > 0)
+  {
+    mFront = (mFront+excess) % mRingSlots;
+    mSize -= excess;
+    mRemovedFrontCount += excess;
+  }
+  char *result = mValues.data() + (mFront+mSize)*bytes;
+  mSize += count;
+  return result;
+}
+
+/*! \internal
+
+  In a ring (\ref setRingCapacity), returns how many of \a count values about to be added would be
+  evicted right away because they exceed the capacity, and evicts all current values if so. The
+  caller only stores the values after the skipped ones. Returns 0 otherwise.
+*/
+int QCPGraphColumnContainer::skipEvicted(int count)
+{
+  if (mRingSlots <= 0 || count <= mRingSlots)
+    return 0;
+  const int skipped = count-mRingSlots;
+  mRemovedFrontCount += mSize+skipped;
+  mFront = 0;
+  mSize = 0;
+  return skipped;
+}
+
+/*! \internal
+
+  In a ring (\ref setRingCapacity), copies the last \a count values into their mirrored slots one
+  capacity apart, so the next windows of the ring are contiguous as well. Does nothing otherwise.
+*/
+void QCPGraphColumnContainer::mirrorValues(int count)
+{
+  if (mRingSlots <= 0 || count <= 0)
+    return;
+  const int bytes = bytesPerValue();
+  const int begin = mFront+mSize-count;
+  const int end = mFront+mSize;
+  char *data = mValues.data();
+  // slots in the first copy are mirrored behind it, slots in the second copy in front of it
+  const int lowerEnd = qMin(end, mRingSlots);
+  if (begin < lowerEnd)
+    memcpy(data + (begin+mRingSlots)*bytes, data + begin*bytes, size_t(lowerEnd-begin)*bytes);
+  const int upperBegin = qMax(begin, mRingSlots);
+  if (upperBegin < end)
+    memcpy(data + (upperBegin-mRingSlots)*bytes, data + upperBegin*bytes, size_t(end-upperBegin)*bytes);
+}
+
+/*! \internal
+
+  Evicts the oldest external values beyond the ring capacity (see \ref setRingCapacity) by moving
+  the start of the window through the external storage. The container's own storage evicts while
+  appending, see \ref appendValues.
+*/
+void QCPGraphColumnContainer::performRingEviction()
+{
+  if (mRingSlots <= 0 || mSize <= mRingSlots)
+    return;
+  const int excess = mSize-mRingSlots;
+  mFront += excess;
+  mSize -= excess;
+  mRemovedFrontCount += excess;
+}
+
+/*! \internal
+
+  Brings the value pyramid up to date after values were added or evicted: drops the blocks that
+  were evicted and adds the blocks that were completed. The blocks are counted from the first value
+  ever added, so the remaining blocks keep their place. The extrema of new blocks of the own storage
+  are computed right away, the ones of external values when they are first needed (see \ref
+  valueMinMax).
+*/
+void QCPGraphColumnContainer::updatePyramid()
+{
+  const qint64 blockSize = Q_INT64_C(1) << BlockShift;
+  mPyramid.removeBefore((qint64(mRemovedFrontCount)+blockSize-1) >> BlockShift);
+  const qint64 endBlock = (qint64(mRemovedFrontCount)+mSize) >> BlockShift;
+  if (mExternalValues)
+    mPyramid.appendUnknownBlocks(endBlock-mPyramid.endBlock());
+  else
+  {
+    for (qint64 block=mPyramid.endBlock(); block<endBlock; ++block)
+      mPyramid.appendBlock(blockExtrema(block));
+  }
+}
+
+/*! \internal
+
+  Reads the raw value extrema of the complete block \a block, which must be held by the container.
+  A block holding only NaN values has an empty range (infinite minimum, negative infinite maximum).
+*/
+QCPValueExtrema QCPGraphColumnContainer::blockExtrema(qint64 block) const
+{
+  const qint64 begin = (block << BlockShift)-qint64(mRemovedFrontCount);
+  QCPValueExtrema result = QCPValuePyramid::emptyExtrema();
+  expandMinMax(int(begin), int(begin+(Q_INT64_C(1) << BlockShift)), result);
+  return result;
+}
+
+/*! \internal
+
+  Widens the raw value extrema in \a result by the stored values of the index range [\a begin, \a
+  end), skipping NaN values.
+*/
+void QCPGraphColumnContainer::expandMinMax(int begin, int end, QCPValueExtrema &result) const
 {
+  if (begin >= end)
+    return;
+  const char *data = valueData(begin);
+  const int count = end-begin;
+  double lower = 0, upper = 0;
+  if (mStride != bytesPerValue())
+  {
+    switch (mValueType)
+    {
+      case vtFloat32: qcpStridedMinMax<float>(data, mStride, count, result); break;
+      case vtInt32: qcpStridedMinMax<qint32>(data, mStride, count, result); break;
+      case vtInt16: qcpStridedMinMax<qint16>(data, mStride, count, result); break;
+    }
+    return;
+  }
+  switch (mValueType)
+  {
+    case vtFloat32:
+    {
+      float floatLower, floatUpper;
+      if (!qcpFloatMinMax(reinterpret_cast<const float*>(data), reinterpret_cast<const float*>(data)+count, floatLower, floatUpper))
+        return;
+      lower = floatLower;
+      upper = floatUpper;
+      break;
+    }
+    case vtInt32: qcpIntMinMax(reinterpret_cast<const qint32*>(data), reinterpret_cast<const qint32*>(data)+count, lower, upper); break;
+    case vtInt16: qcpIntMinMax(reinterpret_cast<const qint16*>(data), reinterpret_cast<const qint16*>(data)+count, lower, upper); break;
+  }
+  if (lower < result.minValue)
+    result.minValue = lower;
+  if (upper > result.maxValue)
+    result.maxValue = upper;
 }
 
 
@@ -19739,6 +22365,9 @@ QCPGraphData::QCPGraphData(double key, double value) :
   (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
   separated.
   
+  Data with evenly spaced keys, like signals sampled at a fixed rate, can be stored more compactly
+  in a \ref QCPGraphColumnContainer, see \ref setColumnData.
+  
   \section qcpgraph-appearance Changing the appearance
   
   The appearance of the graph is mainly determined by the line style, scatter style, brush and pen
@@ -19766,6 +22395,14 @@ QCPGraphData::QCPGraphData(double key, double value) :
   regular \ref setData or \ref addData methods.
 */
 
+/*! \fn QSharedPointer<QCPGraphColumnContainer> QCPGraph::columnData() const
+  
+  Returns the column container the graph plots instead of its regular data, or a null pointer if
+  the regular data is plotted.
+  
+  \see setColumnData
+*/
+
 /* end of documentation of inline functions */
 
 /*!
@@ -19793,6 +22430,7 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setScatterSkip(0);
   setChannelFillGraph(0);
   setAdaptiveSampling(true);
+  mPreparedReplot = 0;
 }
 
 QCPGraph::~QCPGraph()
@@ -19836,6 +22474,24 @@ void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &value
   addData(keys, values, alreadySorted);
 }
 
+/*!
+  Makes the graph plot the compact, column-oriented \a data instead of its regular data container
+  (\ref data). Pass a null pointer to plot the regular data again.
+  
+  Like the regular data container, a column container may be shared by multiple graphs.
+  
+  While column data is plotted, the graph can't be selected by clicking it (see \ref selectTest),
+  and everything that accesses the regular data container directly, like \ref QCPItemTracer,
+  doesn't see the column data.
+  
+  \see QCPGraphColumnContainer
+*/
+void QCPGraph::setColumnData(QSharedPointer<QCPGraphColumnContainer> data)
+{
+  mColumnData = data;
+  markDirty();
+}
+
 /*!
   Sets how the single data points are connected in the plot. For scatter-only plots, set \a ls to
   \ref lsNone and \ref setScatterStyle to the desired scatter style.
@@ -19845,6 +22501,7 @@ void QCPGraph::setData(const QVector<double> &keys, const QVector<double> &value
 void QCPGraph::setLineStyle(LineStyle ls)
 {
   mLineStyle = ls;
+  markDirty();
 }
 
 /*!
@@ -19856,6 +22513,7 @@ void QCPGraph::setLineStyle(LineStyle ls)
 void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  markDirty();
 }
 
 /*!
@@ -19872,6 +22530,7 @@ void QCPGraph::setScatterStyle(const QCPScatterStyle &style)
 void QCPGraph::setScatterSkip(int skip)
 {
   mScatterSkip = qMax(0, skip);
+  markDirty();
 }
 
 /*!
@@ -19885,6 +22544,7 @@ void QCPGraph::setScatterSkip(int skip)
 */
 void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 {
+  markDirty();
   // prevent setting channel target to this graph itself:
   if (targetGraph == this)
   {
@@ -19937,6 +22597,7 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 void QCPGraph::setAdaptiveSampling(bool enabled)
 {
   mAdaptiveSampling = enabled;
+  markDirty();
 }
 
 /*! \overload
@@ -19982,10 +22643,69 @@ void QCPGraph::addData(double key, double value)
   mDataContainer->add(QCPGraphData(key, value));
 }
 
+/*!
+  Returns the number of data points of the column container, if one is set (\ref setColumnData).
+
+  \seebaseclassmethod
+*/
+int QCPGraph::dataCount() const
+{
+  return mColumnData ? mColumnData->size() : mDataContainer->size();
+}
+
+/* inherits documentation from base class */
+double QCPGraph::dataMainKey(int index) const
+{
+  if (!mColumnData)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainKey(index);
+  if (index >= 0 && index < mColumnData->size())
+    return mColumnData->key(index);
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return 0;
+}
+
+/* inherits documentation from base class */
+double QCPGraph::dataSortKey(int index) const
+{
+  return mColumnData ? dataMainKey(index) : QCPAbstractPlottable1D<QCPGraphData>::dataSortKey(index);
+}
+
+/* inherits documentation from base class */
+double QCPGraph::dataMainValue(int index) const
+{
+  if (!mColumnData)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataMainValue(index);
+  if (index >= 0 && index < mColumnData->size())
+    return mColumnData->value(index);
+  qDebug() << Q_FUNC_INFO << "Index out of bounds" << index;
+  return 0;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPGraph::dataValueRange(int index) const
+{
+  if (!mColumnData)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataValueRange(index);
+  const double value = dataMainValue(index);
+  return QCPRange(value, value);
+}
+
+/* inherits documentation from base class */
+int QCPGraph::findBegin(double sortKey, bool expandedRange) const
+{
+  return mColumnData ? mColumnData->findBegin(sortKey, expandedRange) : QCPAbstractPlottable1D<QCPGraphData>::findBegin(sortKey, expandedRange);
+}
+
+/* inherits documentation from base class */
+int QCPGraph::findEnd(double sortKey, bool expandedRange) const
+{
+  return mColumnData ? mColumnData->findEnd(sortKey, expandedRange) : QCPAbstractPlottable1D<QCPGraphData>::findEnd(sortKey, expandedRange);
+}
+
 /* inherits documentation from base class */
 double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
-  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty() || mColumnData)
     return -1;
   if (!mKeyAxis || !mValueAxis)
     return -1;
@@ -20007,12 +22727,16 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
+  if (mColumnData)
+    return mColumnData->keyRange(foundRange, inSignDomain);
   return mDataContainer->keyRange(foundRange, inSignDomain);
 }
 
 /* inherits documentation from base class */
 QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  if (mColumnData)
+    return mColumnData->valueRange(foundRange, inSignDomain, inKeyRange);
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
@@ -20020,26 +22744,30 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain,
 void QCPGraph::draw(QCPPainter *painter)
 {
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
   QVector<QPointF> lines, scatters; // line and (if necessary) scatter pixel coordinates will be stored here while iterating over segments
   
   // loop over and draw segments of unselected/selected data:
-  QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
-  getDataSegments(selectedSegments, unselectedSegments);
-  allSegments << unselectedSegments << selectedSegments;
+  QList<QCPDataRange> allSegments;
+  int unselectedCount;
+  getDrawSegments(allSegments, unselectedCount);
+  // lines prepared by prepareDraw are only valid for the replot they were prepared for:
+  const bool usePreparedLines = mParentPlot->mReplotting && mPreparedReplot == mParentPlot->mReplotSerial && mPreparedLines.size() == allSegments.size();
   for (int i=0; i<allSegments.size(); ++i)
   {
-    bool isSelectedSegment = i >= unselectedSegments.size();
-    // get line pixel points appropriate to line style:
-    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
-    getLines(&lines, lineDataRange);
+    bool isSelectedSegment = i >= unselectedCount;
+    // get line pixel points appropriate to line style, unless prepareDraw already did:
+    if (usePreparedLines)
+      lines = mPreparedLines.at(i);
+    else
+      getLines(&lines, isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1));
     
     // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
     QCPGraphDataContainer::const_iterator it;
-    for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd(); ++it)
+    for (it = mDataContainer->constBegin(); it != mDataContainer->constEnd() && !mColumnData; ++it)
     {
       if (QCP::isInvalidData(it->key, it->value))
         qDebug() << Q_FUNC_INFO << "Data point at" << it->key << "invalid." << "Plottable name:" << name();
@@ -20084,6 +22812,73 @@ void QCPGraph::draw(QCPPainter *painter)
     mSelectionDecorator->drawDecoration(painter, selection());
 }
 
+/*!
+  Graphs don't modify their state while drawing, so they can be drawn onto several tiles
+  concurrently, unless the scatter style uses a pixmap, which may only be used on the GUI thread.
+
+  \seebaseclassmethod
+*/
+bool QCPGraph::reentrantDraw() const
+{
+  return mScatterStyle.shape() != QCPScatterStyle::ssPixmap;
+}
+
+/*!
+  The lines are prepared at most once per replot, further calls during the same replot return
+  immediately.
+
+  \seebaseclassmethod
+*/
+void QCPGraph::prepareDraw()
+{
+  if (mPreparedReplot == mParentPlot->mReplotSerial)
+    return;
+  mPreparedLines.clear();
+  mPreparedReplot = 0;
+  if (!mKeyAxis || !mValueAxis) return;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
+  if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
+  
+  QList<QCPDataRange> allSegments;
+  int unselectedCount;
+  getDrawSegments(allSegments, unselectedCount);
+  mPreparedLines.resize(allSegments.size());
+  for (int i=0; i<allSegments.size(); ++i)
+    getLines(&mPreparedLines[i], i >= unselectedCount ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1));
+  mPreparedReplot = mParentPlot->mReplotSerial;
+}
+
+/*!
+  A channel fill (\ref setChannelFillGraph) also follows the data of the target graph, so its data
+  signature is included.
+
+  \seebaseclassmethod
+*/
+quint64 QCPGraph::dataSignature() const
+{
+  const quint64 result = ownDataSignature();
+  if (!mChannelFillGraph)
+    return result;
+  return QCP::hashCombine(result, mChannelFillGraph.data()->ownDataSignature());
+}
+
+/*! \internal
+
+  Returns the data signature of the data this graph plots, either the regular data container or the
+  column container (\ref setColumnData), without the channel fill target graph.
+
+  \see dataSignature
+*/
+quint64 QCPGraph::ownDataSignature() const
+{
+  if (!mColumnData)
+    return QCPAbstractPlottable1D<QCPGraphData>::dataSignature();
+  quint64 result = QCP::hashCombine(quint64(2), quint64(quintptr(mColumnData.data())));
+  result = QCP::hashCombine(result, mColumnData->revision());
+  result = QCP::hashCombine(result, mColumnData->removedFrontCount());
+  return QCP::hashCombine(result, quint64(mColumnData->size()));
+}
+
 /* inherits documentation from base class */
 void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
@@ -20119,6 +22914,24 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   }
 }
 
+/*! \internal
+
+  Returns via \a segments the data ranges \ref draw paints one after another: first the unselected
+  segments, then the selected ones. \a unselectedCount is set to the number of unselected segments.
+
+  Unselected segments are drawn with their lines extended to the bordering selected data points, so
+  the line data range of segment \c i is \c segments[i].adjusted(-1, 1) for \c i below \a
+  unselectedCount (it's safe to exceed the total data bounds, \ref getLines takes care).
+*/
+void QCPGraph::getDrawSegments(QList<QCPDataRange> &segments, int &unselectedCount) const
+{
+  QList<QCPDataRange> selectedSegments, unselectedSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  segments = unselectedSegments;
+  segments << selectedSegments;
+  unselectedCount = unselectedSegments.size();
+}
+
 /*! \internal
 
   This method retrieves an optimized set of data points via \ref getOptimizedLineData, an branches
@@ -20142,17 +22955,30 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
 {
   if (!lines) return;
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  QVector<QCPGraphData> lineData;
+  if (mColumnData)
   {
-    lines->clear();
-    return;
+    int begin, end;
+    getColumnVisibleBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getColumnLineData(&lineData, begin, end);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      lines->clear();
+      return;
+    }
+    if (mLineStyle != lsNone)
+      getOptimizedLineData(&lineData, begin, end);
   }
-  
-  QVector<QCPGraphData> lineData;
-  if (mLineStyle != lsNone)
-    getOptimizedLineData(&lineData, begin, end);
 
   switch (mLineStyle)
   {
@@ -20184,16 +23010,28 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; scatters->clear(); return; }
   
-  QCPGraphDataContainer::const_iterator begin, end;
-  getVisibleDataBounds(begin, end, dataRange);
-  if (begin == end)
+  QVector<QCPGraphData> data;
+  if (mColumnData)
   {
-    scatters->clear();
-    return;
+    int begin, end;
+    getColumnVisibleBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getColumnScatterData(&data, begin, end);
+  } else
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    getVisibleDataBounds(begin, end, dataRange);
+    if (begin == end)
+    {
+      scatters->clear();
+      return;
+    }
+    getOptimizedScatterData(&data, begin, end);
   }
-  
-  QVector<QCPGraphData> data;
-  getOptimizedScatterData(&data, begin, end);
   scatters->resize(data.size());
   if (keyAxis->orientation() == Qt::Vertical)
   {
@@ -20557,6 +23395,12 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, const QVector<QPointF> &line
 
   This method is used by \ref getLines to retrieve the basic working set of data.
 
+  With adaptive sampling, the points of each pixel interval are located with a galloping search.
+  The value extrema of pixels with many points are taken from the value pyramid of the data
+  container in O(log N) (see \ref QCPDataContainer::valueMinMax), so a zoomed-out view doesn't read
+  every visible point. Smaller pixel intervals are reduced with a vectorized kernel (SSE2 or AVX2,
+  chosen at runtime, with a scalar fallback), see \ref qcpValueMinMax.
+
   \see getOptimizedScatterData
 */
 void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const
@@ -20578,59 +23422,41 @@ void QCPGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGr
   
   if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
   {
+    const QCPGraphData *data = &*begin; // the container is contiguous, the min/max kernels work on plain pointers
     QCPGraphDataContainer::const_iterator it = begin;
-    double minValue = it->value;
-    double maxValue = it->value;
-    QCPGraphDataContainer::const_iterator currentIntervalFirstPoint = it;
     int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
-    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-    double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(begin->key)+reversedRound));
-    double lastIntervalEndKey = currentIntervalStartKey;
-    double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of intervalStartKey
+    double intervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
+    double lastIntervalEndKey = intervalStartKey;
+    double keyEpsilon = qAbs(intervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(intervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
     bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
-    int intervalDataCount = 1;
-    ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
     while (it != end)
     {
-      if (it->key < currentIntervalStartKey+keyEpsilon) // data point is still within same pixel, so skip it and expand value span of this cluster if necessary
+      // the first point always opens the interval, all further points with keys inside the same pixel belong to it:
+      QCPGraphDataContainer::const_iterator intervalEnd = qcpGallopToKey(it+1, end, intervalStartKey+keyEpsilon);
+      if (intervalEnd-it >= 2) // pixel has multiple data points, consolidate them to a cluster
       {
-        if (it->value < minValue)
-          minValue = it->value;
-        else if (it->value > maxValue)
-          maxValue = it->value;
-        ++intervalDataCount;
-      } else // new pixel interval started
+        double minValue, maxValue;
+        const int itIndex = int(it-mDataContainer->constBegin());
+        if (intervalEnd-it < 64 || !mDataContainer->valueMinMax(itIndex, itIndex+int(intervalEnd-it), minValue, maxValue)) // scanning a few blocks is faster than the pyramid
+          qcpValueMinMax(data+(it-begin), data+(intervalEnd-begin), minValue, maxValue);
+        if (lastIntervalEndKey < intervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+          lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.2, it->value));
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.25, minValue));
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.75, maxValue));
+        if (intervalEnd != end && intervalEnd->key > intervalStartKey+keyEpsilon*2) // new pixel starts further away from this cluster, so make sure the last point of the cluster is at a real data point
+          lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.8, (intervalEnd-1)->value));
+      } else
+        lineData->append(*it);
+      lastIntervalEndKey = (intervalEnd-1)->key;
+      it = intervalEnd;
+      if (it != end)
       {
-        if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-        {
-          if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-          lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-          if (it->key > currentIntervalStartKey+keyEpsilon*2) // new pixel started further away from previous cluster, so make sure the last point of the cluster is at a real data point
-            lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.8, (it-1)->value));
-        } else
-          lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
-        lastIntervalEndKey = (it-1)->key;
-        minValue = it->value;
-        maxValue = it->value;
-        currentIntervalFirstPoint = it;
-        currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
+        intervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it->key)+reversedRound));
         if (keyEpsilonVariable)
-          keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
-        intervalDataCount = 1;
+          keyEpsilon = qAbs(intervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(intervalStartKey)+1.0*reversedFactor));
       }
-      ++it;
     }
-    // handle last interval:
-    if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them to a cluster
-    {
-      if (lastIntervalEndKey < currentIntervalStartKey-keyEpsilon) // last point wasn't a cluster, so first point of this cluster must be at a real data point
-        lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.2, currentIntervalFirstPoint->value));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.25, minValue));
-      lineData->append(QCPGraphData(currentIntervalStartKey+keyEpsilon*0.75, maxValue));
-    } else
-      lineData->append(QCPGraphData(currentIntervalFirstPoint->key, currentIntervalFirstPoint->value));
     
   } else // don't use adaptive sampling algorithm, transfer points one-to-one from the data container into the output
   {
@@ -20845,17 +23671,155 @@ void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin
     begin = end;
   } else
   {
-    QCPAxis *keyAxis = mKeyAxis.data();
-    QCPAxis *valueAxis = mValueAxis.data();
-    if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-    // get visible data range:
-    begin = mDataContainer->findBegin(keyAxis->range().lower);
-    end = mDataContainer->findEnd(keyAxis->range().upper);
+    if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+    const QCPRange keyRange = getVisibleKeyRange();
+    begin = mDataContainer->findBegin(keyRange.lower);
+    end = mDataContainer->findEnd(keyRange.upper);
     // limit lower/upperEnd to rangeRestriction:
     mDataContainer->limitIteratorsToDataRange(begin, end, rangeRestriction); // this also ensures rangeRestriction outside data bounds doesn't break anything
   }
 }
 
+/*! \internal
+
+  Returns the key range that needs to be drawn: the range of the key axis, or while an axis rect
+  scrolls this graph's layer, only the newly exposed strip (see QCPAxisRect::setScrollLayer). The
+  key axis must be valid.
+
+  \see getVisibleDataBounds, getColumnVisibleBounds
+*/
+QCPRange QCPGraph::getVisibleKeyRange() const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxisRect *axisRect = keyAxis->axisRect();
+  if (axisRect->mScrollStripActive && axisRect->mScrollLayer.data() == mLayer && axisRect->mScrollKeyAxis.data() == keyAxis)
+    return axisRect->mScrollStripKeyRange;
+  return keyAxis->range();
+}
+
+/*! \internal
+
+  Like \ref getVisibleDataBounds, but returns the visible index range [\a begin, \a end) of the
+  column container (\ref setColumnData). The bounds are computed from the evenly spaced keys, so
+  this takes constant time.
+*/
+void QCPGraph::getColumnVisibleBounds(int &begin, int &end, const QCPDataRange &rangeRestriction) const
+{
+  begin = end = 0;
+  if (rangeRestriction.isEmpty())
+    return;
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  const QCPRange keyRange = getVisibleKeyRange();
+  begin = qMax(mColumnData->findBegin(keyRange.lower), rangeRestriction.begin());
+  end = qMin(mColumnData->findEnd(keyRange.upper), rangeRestriction.end());
+  if (end < begin)
+    end = begin;
+}
+
+/*! \internal
+
+  Performs the adaptive sampling of \ref getOptimizedLineData on the index range [\a begin, \a end)
+  of the column container (\ref setColumnData). The pixel intervals are found by index arithmetic
+  on the evenly spaced keys. Their value extrema are combined from the value pyramid of the
+  container, only the values of the partial blocks at both ends of a pixel interval are read, see
+  \ref QCPGraphColumnContainer::valueMinMax.
+*/
+void QCPGraph::getColumnLineData(QVector<QCPGraphData> *lineData, int begin, int end) const
+{
+  if (!lineData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  if (begin == end) return;
+  const QCPGraphColumnContainer *column = mColumnData.data();
+  
+  int dataCount = end-begin;
+  int maxCount = std::numeric_limits<int>::max();
+  if (mAdaptiveSampling)
+  {
+    double keyPixelSpan = qAbs(keyAxis->coordToPixel(column->key(begin))-keyAxis->coordToPixel(column->key(end-1)));
+    if (2*keyPixelSpan+2 < (double)std::numeric_limits<int>::max())
+      maxCount = 2*keyPixelSpan+2;
+  }
+  
+  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  {
+    int it = begin;
+    int reversedFactor = keyAxis->pixelOrientation(); // is used to calculate keyEpsilon pixel into the correct direction
+    int reversedRound = reversedFactor==-1 ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of intervalStartKey
+    double intervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(column->key(it))+reversedRound));
+    double lastIntervalEndKey = intervalStartKey;
+    double keyEpsilon = qAbs(intervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(intervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+    bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
+    while (it != end)
+    {
+      // the first point always opens the interval, all further points with keys inside the same pixel belong to it:
+      int intervalEnd = qBound(it+1, column->findBegin(intervalStartKey+keyEpsilon, false), end);
+      if (intervalEnd-it >= 2) // pixel has multiple data points, consolidate them to a cluster
+      {
+        double minValue, maxValue;
+        if (!column->valueMinMax(it, intervalEnd, minValue, maxValue))
+          minValue = maxValue = column->value(it); // only NaN values in this pixel
+        if (lastIntervalEndKey < intervalStartKey-keyEpsilon) // last point is further away, so first point of this cluster must be at a real data point
+          lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.2, column->value(it)));
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.25, minValue));
+        lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.75, maxValue));
+        if (intervalEnd != end && column->key(intervalEnd) > intervalStartKey+keyEpsilon*2) // new pixel starts further away from this cluster, so make sure the last point of the cluster is at a real data point
+          lineData->append(QCPGraphData(intervalStartKey+keyEpsilon*0.8, column->value(intervalEnd-1)));
+      } else
+        lineData->append(QCPGraphData(column->key(it), column->value(it)));
+      lastIntervalEndKey = column->key(intervalEnd-1);
+      it = intervalEnd;
+      if (it != end)
+      {
+        intervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(column->key(it))+reversedRound));
+        if (keyEpsilonVariable)
+          keyEpsilon = qAbs(intervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(intervalStartKey)+1.0*reversedFactor));
+      }
+    }
+  } else // don't use adaptive sampling algorithm, transfer points one-to-one from the column into the output
+  {
+    lineData->reserve(dataCount+2); // +2 for possible fill end points
+    for (int i=begin; i<end; ++i)
+      lineData->append(QCPGraphData(column->key(i), column->value(i)));
+  }
+}
+
+/*! \internal
+
+  Returns via \a scatterData the data points of the index range [\a begin, \a end) of the column
+  container (\ref setColumnData) that are drawn as scatters. The scatter skip (\ref setScatterSkip)
+  counts from the first data point ever added, so the scatters don't jump when old data points are
+  evicted. With adaptive sampling, at most one scatter is drawn per key pixel.
+*/
+void QCPGraph::getColumnScatterData(QVector<QCPGraphData> *scatterData, int begin, int end) const
+{
+  if (!scatterData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  const QCPGraphColumnContainer *column = mColumnData.data();
+  
+  const int scatterModulo = mScatterSkip+1;
+  const int phase = int((column->removedFrontCount()+quint64(begin)) % quint64(scatterModulo));
+  int step = scatterModulo;
+  if (mAdaptiveSampling && end-begin > 1)
+  {
+    // don't draw more than one scatter per pixel:
+    const double pixelsPerPoint = qAbs(keyAxis->coordToPixel(column->key(end-1))-keyAxis->coordToPixel(column->key(begin)))/double(end-begin-1);
+    if (pixelsPerPoint > 0 && pixelsPerPoint < 1)
+      step *= qCeil(1.0/pixelsPerPoint);
+  }
+  const QCPRange valueRange = valueAxis->range();
+  scatterData->reserve((end-begin)/step+1);
+  for (int i=begin+(phase == 0 ? 0 : scatterModulo-phase); i<end; i+=step)
+  {
+    const double value = column->value(i);
+    if (value > valueRange.lower && value < valueRange.upper)
+      scatterData->append(QCPGraphData(column->key(i), value));
+  }
+}
+
 /*! \internal
   
   The line vector generated by e.g. \ref getLines describes only the line that connects the data
@@ -21568,6 +24532,7 @@ void QCPCurve::setData(const QVector<double> &keys, const QVector<double> &value
 void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 {
   mScatterStyle = style;
+  markDirty();
 }
 
 /*!
@@ -21584,6 +24549,7 @@ void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 void QCPCurve::setScatterSkip(int skip)
 {
   mScatterSkip = qMax(0, skip);
+  markDirty();
 }
 
 /*!
@@ -21596,6 +24562,7 @@ void QCPCurve::setScatterSkip(int skip)
 void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
 {
   mLineStyle = style;
+  markDirty();
 }
 
 /*! \overload
@@ -23303,6 +26270,7 @@ void QCPBars::setData(const QVector<double> &keys, const QVector<double> &values
 void QCPBars::setWidth(double width)
 {
   mWidth = width;
+  markDirty();
 }
 
 /*!
@@ -23316,6 +26284,7 @@ void QCPBars::setWidth(double width)
 void QCPBars::setWidthType(QCPBars::WidthType widthType)
 {
   mWidthType = widthType;
+  markDirty();
 }
 
 /*!
@@ -23333,6 +26302,7 @@ void QCPBars::setBarsGroup(QCPBarsGroup *barsGroup)
   // register at new group:
   if (mBarsGroup)
     mBarsGroup->registerBars(this);
+  markDirty();
 }
 
 /*!
@@ -23350,6 +26320,7 @@ void QCPBars::setBarsGroup(QCPBarsGroup *barsGroup)
 void QCPBars::setBaseValue(double baseValue)
 {
   mBaseValue = baseValue;
+  markDirty();
 }
 
 /*!
@@ -23360,6 +26331,7 @@ void QCPBars::setBaseValue(double baseValue)
 void QCPBars::setStackingGap(double pixels)
 {
   mStackingGap = pixels;
+  markDirty();
 }
 
 /*! \overload
@@ -23674,6 +26646,17 @@ void QCPBars::draw(QCPPainter *painter)
     mSelectionDecorator->drawDecoration(painter, selection());
 }
 
+/*!
+  Bars only read their data and the bars they are stacked on or grouped with while drawing, so they
+  can be drawn onto several tiles concurrently.
+
+  \seebaseclassmethod
+*/
+bool QCPBars::reentrantDraw() const
+{
+  return true;
+}
+
 /* inherits documentation from base class */
 void QCPBars::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 {
@@ -23686,6 +26669,19 @@ void QCPBars::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   painter->drawRect(r);
 }
 
+/*!
+  Stacked bars (\ref moveAbove, \ref moveBelow) and bars in a \ref QCPBarsGroup depend on the
+  data of other bars, so in that case the signature can't be determined and 0 is returned.
+
+  \seebaseclassmethod
+*/
+quint64 QCPBars::dataSignature() const
+{
+  if (mBarBelow || mBarAbove || mBarsGroup)
+    return 0;
+  return QCPAbstractPlottable1D<QCPBarsData>::dataSignature();
+}
+
 /*!  \internal
   
   called by \ref draw to determine which data (key) range is visible at the current key axis range
@@ -24170,6 +27166,7 @@ void QCPStatisticalBox::setData(const QVector<double> &keys, const QVector<doubl
 void QCPStatisticalBox::setWidth(double width)
 {
   mWidth = width;
+  markDirty();
 }
 
 /*!
@@ -24183,6 +27180,7 @@ void QCPStatisticalBox::setWidth(double width)
 void QCPStatisticalBox::setWhiskerWidth(double width)
 {
   mWhiskerWidth = width;
+  markDirty();
 }
 
 /*!
@@ -24199,6 +27197,7 @@ void QCPStatisticalBox::setWhiskerWidth(double width)
 void QCPStatisticalBox::setWhiskerPen(const QPen &pen)
 {
   mWhiskerPen = pen;
+  markDirty();
 }
 
 /*!
@@ -24213,6 +27212,7 @@ void QCPStatisticalBox::setWhiskerPen(const QPen &pen)
 void QCPStatisticalBox::setWhiskerBarPen(const QPen &pen)
 {
   mWhiskerBarPen = pen;
+  markDirty();
 }
 
 /*!
@@ -24224,6 +27224,7 @@ void QCPStatisticalBox::setWhiskerBarPen(const QPen &pen)
 void QCPStatisticalBox::setWhiskerAntialiased(bool enabled)
 {
   mWhiskerAntialiased = enabled;
+  markDirty();
 }
 
 /*!
@@ -24232,6 +27233,7 @@ void QCPStatisticalBox::setWhiskerAntialiased(bool enabled)
 void QCPStatisticalBox::setMedianPen(const QPen &pen)
 {
   mMedianPen = pen;
+  markDirty();
 }
 
 /*!
@@ -24243,6 +27245,7 @@ void QCPStatisticalBox::setMedianPen(const QPen &pen)
 void QCPStatisticalBox::setOutlierStyle(const QCPScatterStyle &style)
 {
   mOutlierStyle = style;
+  markDirty();
 }
 
 /*! \overload
@@ -25271,6 +28274,7 @@ void QCPColorMap::setData(QCPColorMapData *data, bool copy)
 */
 void QCPColorMap::setDataRange(const QCPRange &dataRange)
 {
+  markDirty();
   if (!QCPRange::validRange(dataRange)) return;
   if (mDataRange.lower != dataRange.lower || mDataRange.upper != dataRange.upper)
   {
@@ -25298,6 +28302,7 @@ void QCPColorMap::setDataScaleType(QCPAxis::ScaleType scaleType)
     if (mDataScaleType == QCPAxis::stLogarithmic)
       setDataRange(mDataRange.sanitizedForLogScale());
   }
+  markDirty();
 }
 
 /*!
@@ -25319,6 +28324,7 @@ void QCPColorMap::setGradient(const QCPColorGradient &gradient)
     mMapImageInvalidated = true;
     emit gradientChanged(mGradient);
   }
+  markDirty();
 }
 
 /*!
@@ -25331,6 +28337,7 @@ void QCPColorMap::setInterpolate(bool enabled)
 {
   mInterpolate = enabled;
   mMapImageInvalidated = true; // because oversampling factors might need to change
+  markDirty();
 }
 
 /*!
@@ -25347,6 +28354,7 @@ void QCPColorMap::setInterpolate(bool enabled)
 void QCPColorMap::setTightBoundary(bool enabled)
 {
   mTightBoundary = enabled;
+  markDirty();
 }
 
 /*!
@@ -25387,6 +28395,7 @@ void QCPColorMap::setColorScale(QCPColorScale *colorScale)
     connect(mColorScale.data(), SIGNAL(gradientChanged(QCPColorGradient)), this, SLOT(setGradient(QCPColorGradient)));
     connect(mColorScale.data(), SIGNAL(dataScaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
   }
+  markDirty();
 }
 
 /*!
@@ -25930,6 +28939,7 @@ void QCPFinancial::setData(const QVector<double> &keys, const QVector<double> &o
 void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
 {
   mChartStyle = style;
+  markDirty();
 }
 
 /*!
@@ -25940,6 +28950,7 @@ void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
 void QCPFinancial::setWidth(double width)
 {
   mWidth = width;
+  markDirty();
 }
 
 /*!
@@ -25953,6 +28964,7 @@ void QCPFinancial::setWidth(double width)
 void QCPFinancial::setWidthType(QCPFinancial::WidthType widthType)
 {
   mWidthType = widthType;
+  markDirty();
 }
 
 /*!
@@ -25967,6 +28979,7 @@ void QCPFinancial::setWidthType(QCPFinancial::WidthType widthType)
 void QCPFinancial::setTwoColored(bool twoColored)
 {
   mTwoColored = twoColored;
+  markDirty();
 }
 
 /*!
@@ -25981,6 +28994,7 @@ void QCPFinancial::setTwoColored(bool twoColored)
 void QCPFinancial::setBrushPositive(const QBrush &brush)
 {
   mBrushPositive = brush;
+  markDirty();
 }
 
 /*!
@@ -25995,6 +29009,7 @@ void QCPFinancial::setBrushPositive(const QBrush &brush)
 void QCPFinancial::setBrushNegative(const QBrush &brush)
 {
   mBrushNegative = brush;
+  markDirty();
 }
 
 /*!
@@ -26009,6 +29024,7 @@ void QCPFinancial::setBrushNegative(const QBrush &brush)
 void QCPFinancial::setPenPositive(const QPen &pen)
 {
   mPenPositive = pen;
+  markDirty();
 }
 
 /*!
@@ -26023,6 +29039,7 @@ void QCPFinancial::setPenPositive(const QPen &pen)
 void QCPFinancial::setPenNegative(const QPen &pen)
 {
   mPenNegative = pen;
+  markDirty();
 }
 
 /*! \overload
@@ -26841,6 +29858,7 @@ void QCPErrorBars::setData(const QVector<double> &errorMinus, const QVector<doub
 */
 void QCPErrorBars::setDataPlottable(QCPAbstractPlottable *plottable)
 {
+  markDirty();
   if (plottable && qobject_cast<QCPErrorBars*>(plottable))
   {
     mDataPlottable = 0;
@@ -26864,6 +29882,7 @@ void QCPErrorBars::setDataPlottable(QCPAbstractPlottable *plottable)
 void QCPErrorBars::setErrorType(ErrorType type)
 {
   mErrorType = type;
+  markDirty();
 }
 
 /*!
@@ -26873,6 +29892,7 @@ void QCPErrorBars::setErrorType(ErrorType type)
 void QCPErrorBars::setWhiskerWidth(double pixels)
 {
   mWhiskerWidth = pixels;
+  markDirty();
 }
 
 /*!
@@ -26883,6 +29903,7 @@ void QCPErrorBars::setWhiskerWidth(double pixels)
 void QCPErrorBars::setSymbolGap(double pixels)
 {
   mSymbolGap = pixels;
+  markDirty();
 }
 
 /*! \overload
@@ -27649,6 +30670,7 @@ QCPItemStraightLine::~QCPItemStraightLine()
 void QCPItemStraightLine::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -27659,6 +30681,7 @@ void QCPItemStraightLine::setPen(const QPen &pen)
 void QCPItemStraightLine::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -27832,6 +30855,7 @@ QCPItemLine::~QCPItemLine()
 void QCPItemLine::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -27842,6 +30866,7 @@ void QCPItemLine::setPen(const QPen &pen)
 void QCPItemLine::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -27855,6 +30880,7 @@ void QCPItemLine::setSelectedPen(const QPen &pen)
 void QCPItemLine::setHead(const QCPLineEnding &head)
 {
   mHead = head;
+  markDirty();
 }
 
 /*!
@@ -27868,6 +30894,7 @@ void QCPItemLine::setHead(const QCPLineEnding &head)
 void QCPItemLine::setTail(const QCPLineEnding &tail)
 {
   mTail = tail;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -28074,6 +31101,7 @@ QCPItemCurve::~QCPItemCurve()
 void QCPItemCurve::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28084,6 +31112,7 @@ void QCPItemCurve::setPen(const QPen &pen)
 void QCPItemCurve::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28097,6 +31126,7 @@ void QCPItemCurve::setSelectedPen(const QPen &pen)
 void QCPItemCurve::setHead(const QCPLineEnding &head)
 {
   mHead = head;
+  markDirty();
 }
 
 /*!
@@ -28110,6 +31140,7 @@ void QCPItemCurve::setHead(const QCPLineEnding &head)
 void QCPItemCurve::setTail(const QCPLineEnding &tail)
 {
   mTail = tail;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -28234,6 +31265,7 @@ QCPItemRect::~QCPItemRect()
 void QCPItemRect::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28244,6 +31276,7 @@ void QCPItemRect::setPen(const QPen &pen)
 void QCPItemRect::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28255,6 +31288,7 @@ void QCPItemRect::setSelectedPen(const QPen &pen)
 void QCPItemRect::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -28266,6 +31300,7 @@ void QCPItemRect::setBrush(const QBrush &brush)
 void QCPItemRect::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -28401,6 +31436,7 @@ QCPItemText::~QCPItemText()
 void QCPItemText::setColor(const QColor &color)
 {
   mColor = color;
+  markDirty();
 }
 
 /*!
@@ -28409,6 +31445,7 @@ void QCPItemText::setColor(const QColor &color)
 void QCPItemText::setSelectedColor(const QColor &color)
 {
   mSelectedColor = color;
+  markDirty();
 }
 
 /*!
@@ -28420,6 +31457,7 @@ void QCPItemText::setSelectedColor(const QColor &color)
 void QCPItemText::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28431,6 +31469,7 @@ void QCPItemText::setPen(const QPen &pen)
 void QCPItemText::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28442,6 +31481,7 @@ void QCPItemText::setSelectedPen(const QPen &pen)
 void QCPItemText::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -28453,6 +31493,7 @@ void QCPItemText::setBrush(const QBrush &brush)
 void QCPItemText::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -28463,6 +31504,7 @@ void QCPItemText::setSelectedBrush(const QBrush &brush)
 void QCPItemText::setFont(const QFont &font)
 {
   mFont = font;
+  markDirty();
 }
 
 /*!
@@ -28473,6 +31515,7 @@ void QCPItemText::setFont(const QFont &font)
 void QCPItemText::setSelectedFont(const QFont &font)
 {
   mSelectedFont = font;
+  markDirty();
 }
 
 /*!
@@ -28484,6 +31527,7 @@ void QCPItemText::setSelectedFont(const QFont &font)
 void QCPItemText::setText(const QString &text)
 {
   mText = text;
+  markDirty();
 }
 
 /*!
@@ -28501,6 +31545,7 @@ void QCPItemText::setText(const QString &text)
 void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 {
   mPositionAlignment = alignment;
+  markDirty();
 }
 
 /*!
@@ -28509,6 +31554,7 @@ void QCPItemText::setPositionAlignment(Qt::Alignment alignment)
 void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 {
   mTextAlignment = alignment;
+  markDirty();
 }
 
 /*!
@@ -28518,6 +31564,7 @@ void QCPItemText::setTextAlignment(Qt::Alignment alignment)
 void QCPItemText::setRotation(double degrees)
 {
   mRotation = degrees;
+  markDirty();
 }
 
 /*!
@@ -28527,6 +31574,7 @@ void QCPItemText::setRotation(double degrees)
 void QCPItemText::setPadding(const QMargins &padding)
 {
   mPadding = padding;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -28742,6 +31790,7 @@ QCPItemEllipse::~QCPItemEllipse()
 void QCPItemEllipse::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28752,6 +31801,7 @@ void QCPItemEllipse::setPen(const QPen &pen)
 void QCPItemEllipse::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28763,6 +31813,7 @@ void QCPItemEllipse::setSelectedPen(const QPen &pen)
 void QCPItemEllipse::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -28774,6 +31825,7 @@ void QCPItemEllipse::setBrush(const QBrush &brush)
 void QCPItemEllipse::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -28936,6 +31988,7 @@ void QCPItemPixmap::setPixmap(const QPixmap &pixmap)
   mScaledPixmapInvalidated = true;
   if (mPixmap.isNull())
     qDebug() << Q_FUNC_INFO << "pixmap is null";
+  markDirty();
 }
 
 /*!
@@ -28948,6 +32001,7 @@ void QCPItemPixmap::setScaled(bool scaled, Qt::AspectRatioMode aspectRatioMode,
   mAspectRatioMode = aspectRatioMode;
   mTransformationMode = transformationMode;
   mScaledPixmapInvalidated = true;
+  markDirty();
 }
 
 /*!
@@ -28958,6 +32012,7 @@ void QCPItemPixmap::setScaled(bool scaled, Qt::AspectRatioMode aspectRatioMode,
 void QCPItemPixmap::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -28968,6 +32023,7 @@ void QCPItemPixmap::setPen(const QPen &pen)
 void QCPItemPixmap::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -29216,6 +32272,7 @@ QCPItemTracer::~QCPItemTracer()
 void QCPItemTracer::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -29226,6 +32283,7 @@ void QCPItemTracer::setPen(const QPen &pen)
 void QCPItemTracer::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -29236,6 +32294,7 @@ void QCPItemTracer::setSelectedPen(const QPen &pen)
 void QCPItemTracer::setBrush(const QBrush &brush)
 {
   mBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -29246,6 +32305,7 @@ void QCPItemTracer::setBrush(const QBrush &brush)
 void QCPItemTracer::setSelectedBrush(const QBrush &brush)
 {
   mSelectedBrush = brush;
+  markDirty();
 }
 
 /*!
@@ -29255,6 +32315,7 @@ void QCPItemTracer::setSelectedBrush(const QBrush &brush)
 void QCPItemTracer::setSize(double size)
 {
   mSize = size;
+  markDirty();
 }
 
 /*!
@@ -29266,6 +32327,7 @@ void QCPItemTracer::setSize(double size)
 void QCPItemTracer::setStyle(QCPItemTracer::TracerStyle style)
 {
   mStyle = style;
+  markDirty();
 }
 
 /*!
@@ -29294,6 +32356,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
   {
     mGraph = 0;
   }
+  markDirty();
 }
 
 /*!
@@ -29308,6 +32371,7 @@ void QCPItemTracer::setGraph(QCPGraph *graph)
 void QCPItemTracer::setGraphKey(double key)
 {
   mGraphKey = key;
+  markDirty();
 }
 
 /*!
@@ -29324,6 +32388,7 @@ void QCPItemTracer::setGraphKey(double key)
 void QCPItemTracer::setInterpolating(bool enabled)
 {
   mInterpolating = enabled;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -29383,6 +32448,21 @@ double QCPItemTracer::selectTest(const QPointF &pos, bool onlySelectable, QVaria
   return -1;
 }
 
+/*!
+  The position of a tracer that follows a graph is only updated when it is drawn, so the signature
+  of the graph (\ref setGraph) is included.
+
+  \seebaseclassmethod
+*/
+quint64 QCPItemTracer::drawSignature() const
+{
+  const quint64 result = QCPAbstractItem::drawSignature();
+  if (!mGraph)
+    return result;
+  const quint64 graphSignature = mGraph->drawSignature();
+  return graphSignature == 0 ? 0 : QCP::hashCombine(result, graphSignature);
+}
+
 /* inherits documentation from base class */
 void QCPItemTracer::draw(QCPPainter *painter)
 {
@@ -29578,6 +32658,7 @@ QCPItemBracket::~QCPItemBracket()
 void QCPItemBracket::setPen(const QPen &pen)
 {
   mPen = pen;
+  markDirty();
 }
 
 /*!
@@ -29588,6 +32669,7 @@ void QCPItemBracket::setPen(const QPen &pen)
 void QCPItemBracket::setSelectedPen(const QPen &pen)
 {
   mSelectedPen = pen;
+  markDirty();
 }
 
 /*!
@@ -29601,6 +32683,7 @@ void QCPItemBracket::setSelectedPen(const QPen &pen)
 void QCPItemBracket::setLength(double length)
 {
   mLength = length;
+  markDirty();
 }
 
 /*!
@@ -29611,6 +32694,7 @@ void QCPItemBracket::setLength(double length)
 void QCPItemBracket::setStyle(QCPItemBracket::BracketStyle style)
 {
   mStyle = style;
+  markDirty();
 }
 
 /* inherits documentation from base class */
@@ -48,6 +48,7 @@
 #include <QtCore/QPointer>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 #include <QtGui/QPainter>
 #include <QtGui/QPaintEvent>
 #include <QtGui/QMouseEvent>
@@ -62,9 +63,11 @@
 #include <QtCore/QStack>
 #include <QtCore/QCache>
 #include <QtCore/QMargins>
+#include <QtCore/QMutex>
 #include <qmath.h>
 #include <limits>
 #include <algorithm>
+#include <cstring>
 #ifdef QCP_OPENGL_FBO
 #  include <QtGui/QOpenGLContext>
 #  include <QtGui/QOpenGLFramebufferObject>
@@ -235,6 +238,10 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phConcurrentLines  = 0x008 ///< <tt>0x008</tt> the data-to-pixel reduction of all visible plottables is done concurrently on the global thread pool before the layers are drawn.
+                                                ///<                Only available if QCustomPlot is compiled with \c QCUSTOMPLOT_USE_CONCURRENT (and Qt's concurrent module), see \ref QCPAbstractPlottable::prepareDraw.
+                    ,phDirtyLayersOnly  = 0x010 ///< <tt>0x010</tt> \ref QCustomPlot::replot only redraws the paint buffers of layers that were marked dirty since the last replot, all other buffers keep their contents.
+                                                ///<                See \ref QCPLayerable::markDirty and \ref QCPLayerable::drawSignature.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -352,6 +359,41 @@ inline int getMarginValue(const QMargins &margins, QCP::MarginSide side)
   return 0;
 }
 
+/*! \internal
+  
+  Mixes \a value into the hash \a seed and returns the result. This is used to build the draw
+  signatures of layerables, see \ref QCPLayerable::drawSignature.
+*/
+inline quint64 hashCombine(quint64 seed, quint64 value)
+{
+  return seed ^ (value + Q_UINT64_C(0x9e3779b97f4a7c15) + (seed<<6) + (seed>>2));
+}
+
+/*! \internal
+  \overload
+  
+  Mixes the bit pattern of the floating point \a value into the hash \a seed.
+*/
+inline quint64 hashCombine(quint64 seed, double value)
+{
+  quint64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return hashCombine(seed, bits);
+}
+
+/*! \internal
+  \overload
+  
+  Mixes the position and size of \a rect into the hash \a seed.
+*/
+inline quint64 hashCombine(quint64 seed, const QRect &rect)
+{
+  seed = hashCombine(seed, quint64(qint64(rect.left())));
+  seed = hashCombine(seed, quint64(qint64(rect.top())));
+  seed = hashCombine(seed, quint64(qint64(rect.width())));
+  return hashCombine(seed, quint64(qint64(rect.height())));
+}
+
 
 extern const QMetaObject staticMetaObject; // in moc-run we create a static meta object for QCP "fake" object. This line is the link to it via QCP::staticMetaObject in normal operation as namespace
 
@@ -530,6 +572,10 @@ public:
   virtual void donePainting() {}
   virtual void draw(QCPPainter *painter) const = 0;
   virtual void clear(const QColor &color) = 0;
+  virtual bool scroll(int dx, int dy, const QRect &rect);
+  virtual int tileCount() const;
+  virtual QRect tileRect(int index) const;
+  virtual QCPPainter *startTilePainting(int index);
   
 protected:
   // property members:
@@ -554,6 +600,7 @@ public:
   virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
   virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
   void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(int dx, int dy, const QRect &rect) Q_DECL_OVERRIDE;
   
 protected:
   // non-property members:
@@ -564,6 +611,35 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio, int tiles);
+  virtual ~QCPPaintBufferImage();
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  virtual bool scroll(int dx, int dy, const QRect &rect) Q_DECL_OVERRIDE;
+  virtual int tileCount() const Q_DECL_OVERRIDE;
+  virtual QRect tileRect(int index) const Q_DECL_OVERRIDE;
+  virtual QCPPainter *startTilePainting(int index) Q_DECL_OVERRIDE;
+  
+protected:
+  // property members:
+  int mTiles;
+  
+  // non-property members:
+  QImage mBuffer;
+  QVector<QImage> mTileImages;
+  QVector<QRect> mTileRects;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
@@ -659,6 +735,7 @@ public:
   
   // non-virtual methods:
   void replot();
+  void markDirty();
   
 protected:
   // property members:
@@ -671,18 +748,34 @@ protected:
   
   // non-property members:
   QWeakPointer<QCPAbstractPaintBuffer> mPaintBuffer;
+  QPointer<QCPAxisRect> mScrollAxisRect;
+  bool mDirty;
   
   // non-virtual methods:
-  void draw(QCPPainter *painter);
+  void draw(QCPPainter *painter, const QRect &clipRect=QRect());
+  void drawTiled(QCPPainter *painter, QCPAbstractPaintBuffer *buffer, const QRect &clipRect);
+  void drawTiles(QCPAbstractPaintBuffer *buffer, const QList<QCPLayerable*> &layerables, const QRect &clipRect);
   void drawToPaintBuffer();
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
+  static void drawLayerable(QCPPainter *painter, QCPLayerable *layerable, const QRect &clipRect);
+  
+  // one tile of a tiled layer draw, see drawTiles:
+  struct TileJob
+  {
+    QCPAbstractPaintBuffer *buffer;
+    int index;
+    const QList<QCPLayerable*> *layerables;
+    QRect clipRect;
+  };
+  static void drawTile(TileJob &job);
   
 private:
   Q_DISABLE_COPY(QCPLayer)
   
   friend class QCustomPlot;
   friend class QCPLayerable;
+  friend class QCPAxisRect;
 };
 Q_DECLARE_METATYPE(QCPLayer::LayerMode)
 
@@ -715,6 +808,8 @@ public:
   
   // introduced virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
+  virtual quint64 drawSignature() const;
+  virtual void markDirty();
 
   // non-property methods:
   bool realVisibility() const;
@@ -730,12 +825,16 @@ protected:
   QCPLayer *mLayer;
   bool mAntialiased;
   
+  // non-property members:
+  quint64 mDrawnSignature;
+  
   // introduced virtual methods:
   virtual void parentPlotInitialized(QCustomPlot *parentPlot);
   virtual QCP::Interaction selectionCategory() const;
   virtual QRect clipRect() const;
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const = 0;
   virtual void draw(QCPPainter *painter) = 0;
+  virtual bool reentrantDraw() const;
   // selection events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
@@ -1109,6 +1208,9 @@ public:
   // non-property methods:
   Q_SLOT void cancel();
   
+  // reimplemented virtual methods:
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
+  
 signals:
   void started(QMouseEvent *event);
   void changed(const QRect &rect, QMouseEvent *event);
@@ -1230,6 +1332,7 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
   
 protected:
   // property members:
@@ -1865,6 +1968,9 @@ public:
   void setSubGridPen(const QPen &pen);
   void setZeroLinePen(const QPen &pen);
   
+  // reimplemented virtual methods:
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
+  
 protected:
   // property members:
   bool mSubGridVisible;
@@ -2073,6 +2179,7 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
   
   // non-property methods:
   Qt::Orientation orientation() const { return mOrientation; }
@@ -2370,6 +2477,103 @@ Q_DECLARE_METATYPE(QCPScatterStyle::ScatterShape)
 template <class DataType>
 inline bool qcpLessThanSortKey(const DataType &a, const DataType &b) { return a.sortKey() < b.sortKey(); }
 
+/*! \relates QCPValuePyramid
+  Helper for \ref QCPValuePyramid holding the value extrema of a range of data points.
+*/
+struct QCPValueExtrema
+{
+  double minValue;
+  double maxValue;
+};
+
+class QCP_LIB_DECL QCPValuePyramid
+{
+public:
+  QCPValuePyramid();
+  
+  // getters:
+  qint64 beginBlock() const { return mBeginBlock; }
+  qint64 endBlock() const { return mLevels.isEmpty() ? mBeginBlock : mLevels.first().end; }
+  
+  // non-property methods:
+  void clear(qint64 beginBlock=0);
+  void appendBlock(const QCPValueExtrema &extrema);
+  void appendUnknownBlocks(qint64 count);
+  void removeBefore(qint64 block);
+  void removeAfter(qint64 block);
+  void expand(QCPValueExtrema &result, qint64 begin, qint64 end) const;
+  template <class BlockFunction>
+  void expand(QCPValueExtrema &result, qint64 begin, qint64 end, BlockFunction computeBlock);
+  static QCPValueExtrema emptyExtrema();
+  static void expand(QCPValueExtrema &result, const QCPValueExtrema &other);
+  
+protected:
+  struct Level
+  {
+    QVector<QCPValueExtrema> nodes; // ring with a power of two size, node i is stored at i modulo the size
+    qint64 begin; // index of the first node held
+    qint64 end; // index after the last node held
+  };
+  
+  // non-property members:
+  qint64 mBeginBlock;
+  QVector<Level> mLevels;
+  
+  // non-virtual methods:
+  QCPValueExtrema &node(int level, qint64 index) { Level &l = mLevels[level]; return l.nodes[int(index & (l.nodes.size()-1))]; }
+  const QCPValueExtrema &node(int level, qint64 index) const { const Level &l = mLevels.at(level); return l.nodes.at(int(index & (l.nodes.size()-1))); }
+  void setNode(int level, qint64 index, const QCPValueExtrema &extrema);
+  QCPValueExtrema childExtrema(int level, qint64 index) const;
+  template <class BlockFunction>
+  const QCPValueExtrema &resolveNode(int level, qint64 index, BlockFunction &computeBlock);
+};
+
+/*! \overload
+  
+  Like \ref expand(QCPValueExtrema &result, qint64 begin, qint64 end) const, but the extrema of
+  blocks that were added with \ref appendUnknownBlocks are computed on demand: \a computeBlock is
+  called with the block index and must return the extrema of that block. The computed extrema are
+  stored, so every block is only computed once.
+*/
+template <class BlockFunction>
+void QCPValuePyramid::expand(QCPValueExtrema &result, qint64 begin, qint64 end, BlockFunction computeBlock)
+{
+  for (int level = 0; begin < end; ++level)
+  {
+    if (begin & 1)
+      expand(result, resolveNode(level, begin++, computeBlock));
+    if (end & 1)
+      expand(result, resolveNode(level, --end, computeBlock));
+    begin >>= 1;
+    end >>= 1;
+  }
+}
+
+/*! \internal
+  
+  Returns the node \a index on \a level, computing it first if its extrema are unknown (NaN), from
+  \a computeBlock on the lowest level and from the child nodes above.
+*/
+template <class BlockFunction>
+const QCPValueExtrema &QCPValuePyramid::resolveNode(int level, qint64 index, BlockFunction &computeBlock)
+{
+  QCPValueExtrema &result = node(level, index);
+  if (qIsNaN(result.minValue))
+  {
+    if (level == 0)
+    {
+      result = computeBlock(index);
+    } else
+    {
+      QCPValueExtrema extrema = emptyExtrema();
+      expand(extrema, resolveNode(level-1, 2*index, computeBlock));
+      expand(extrema, resolveNode(level-1, 2*index+1, computeBlock));
+      result = extrema;
+    }
+  }
+  return result;
+}
+
 template <class DataType>
 class QCP_LIB_DECL QCPDataContainer
 {
@@ -2380,12 +2584,19 @@ public:
   QCPDataContainer();
   
   // getters:
-  int size() const { return mData.size()-mPreallocSize; }
+  int size() const { return mData.size()-mPreallocSize-mPostallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  int ringCapacity() const { return mRingCapacity; }
+  double ringKeySpan() const { return mRingKeySpan; }
+  bool isRingMode() const { return mRingCapacity > 0 || mRingKeySpan > 0; }
+  quint64 revision() const { return mRevision; }
+  quint64 removedFrontCount() const { return mRemovedFrontCount; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setRingCapacity(int capacity);
+  void setRingKeySpan(double keySpan);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2402,29 +2613,49 @@ public:
   void squeeze(bool preAllocation=true, bool postAllocation=true);
   
   const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
-  const_iterator constEnd() const { return mData.constEnd(); }
-  iterator begin() { return mData.begin()+mPreallocSize; }
-  iterator end() { return mData.end(); }
+  const_iterator constEnd() const { return mData.constEnd()-mPostallocSize; }
+  iterator begin() { unfoldRing(); mPyramidValid = false; return mData.begin()+mPreallocSize; }
+  iterator end() { unfoldRing(); mPyramidValid = false; return mData.end(); }
   const_iterator findBegin(double sortKey, bool expandedRange=true) const;
   const_iterator findEnd(double sortKey, bool expandedRange=true) const;
   const_iterator at(int index) const { return constBegin()+qBound(0, index, size()); }
   QCPRange keyRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth);
   QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange());
+  bool valueMinMax(int begin, int end, double &minValue, double &maxValue) const;
   QCPDataRange dataRange() const { return QCPDataRange(0, size()); }
   void limitIteratorsToDataRange(const_iterator &begin, const_iterator &end, const QCPDataRange &dataRange) const;
   
 protected:
+  enum { BlockShift = 4 }; // 16 data points per block of the value pyramid
+  
   // property members:
   bool mAutoSqueeze;
+  int mRingCapacity;
+  double mRingKeySpan;
   
   // non-property memebers:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  int mPostallocSize; // unused slots behind the data, only in the mirrored ring layout
+  int mRingSlots; // size of one copy of the mirrored ring layout, 0 if the data is laid out linearly
+  quint64 mRevision;
+  quint64 mRemovedFrontCount;
+  QCPValuePyramid mPyramid; // value extrema of the complete blocks of data points, counted from the first one ever added
+  bool mPyramidValid;
   
   // non-virtual methods:
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void rebuildPyramid();
+  void updatePyramid(quint64 oldRevision);
+  void expandExtrema(QCPValueExtrema &result, int begin, int end) const;
+  void removeFront(int count);
+  void appendToRing(const DataType *first, const DataType *last);
+  void performRingEviction();
+  void foldRing();
+  void unfoldRing();
+  void layoutRing(int minimumSlots);
 };
 
 // include implementation in header since it is a class template:
@@ -2465,6 +2696,18 @@ protected:
   sort. Failing to do so can not be detected by the container efficiently and will cause both
   rendering artifacts and potential data loss.
 
+  For live strip charts that only ever show the most recent data, the container can be put into
+  ring mode with \ref setRingCapacity and/or \ref setRingKeySpan. The data is then stored in a ring
+  which is mirrored into a second copy right behind it, so every window of the ring is one
+  contiguous, sorted range: the iterators, \ref findBegin and \ref findEnd work unchanged. Appending
+  writes each data point to its slot and the mirrored one, and the oldest data points are evicted
+  by moving the start of the window, so neither ever moves the existing data.
+
+  The container keeps a \ref QCPValuePyramid with the value extrema of its data points up to date
+  while data is added and removed. Appending and removing from the front only cost work
+  proportional to the changed data, any other modification rebuilds it. With it, \ref valueRange
+  and \ref valueMinMax find the value extrema of any index or key range in O(log N).
+
   Implementing one-dimensional plottables that make use of a \ref QCPDataContainer<T> is usually
   done by subclassing from \ref QCPAbstractPlottable1D "QCPAbstractPlottable1D<T>", which
   introduces an according \a mDataContainer member and some convenience methods.
@@ -2515,6 +2758,30 @@ protected:
   Returns whether this container holds no data points.
 */
 
+/*! \fn quint64 QCPDataContainer<DataType>::revision() const
+  
+  Returns a counter that is incremented whenever data points are inserted, removed or reordered
+  anywhere other than appended at the end or removed from the front.
+  
+  Together with \ref removedFrontCount and \ref size, this allows state derived from the container
+  (e.g. the scrolled plot image of \ref QCPAxisRect) to be reused for the common append/evict
+  pattern, and to be discarded only when the revision changed. Modifications through the
+  non-const iterators (\ref begin, \ref end) are not tracked.
+*/
+
+/*! \fn quint64 QCPDataContainer<DataType>::removedFrontCount() const
+  
+  Returns the total number of data points that were removed from the front of the container (e.g.
+  by \ref removeBefore or ring eviction) without changing the \ref revision.
+*/
+
+/*! \fn bool QCPDataContainer<DataType>::isRingMode() const
+  
+  Returns whether the container evicts its oldest data points by count or key span.
+  
+  \see setRingCapacity, setRingKeySpan
+*/
+
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::constBegin() const
   
   Returns a const iterator to the first data point in this container.
@@ -2532,6 +2799,13 @@ protected:
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
   description of this class.
+  
+  In ring mode, a modification through the iterators would only reach one of the two copies of the
+  mirrored ring, so the data is laid out linearly first. The next data point appended lays out the
+  ring again, which takes time proportional to the size of the container once.
+  
+  Since values may be changed through the iterators, the value pyramid is no longer used (see \ref
+  valueMinMax) until the next modification through the container's methods rebuilds it.
 */
 
 /*! \fn QCPDataContainer::iterator QCPDataContainer<DataType>::end() const
@@ -2540,7 +2814,7 @@ protected:
   
   You can manipulate the data points in-place through the non-const iterators, but great care must
   be taken when manipulating the sort key of a data point, see \ref sort, or the detailed
-  description of this class.
+  description of this class. In ring mode, see the note at \ref begin.
 */
 
 /*! \fn QCPDataContainer::const_iterator QCPDataContainer<DataType>::at(int index) const
@@ -2568,8 +2842,15 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mRingCapacity(0),
+  mRingKeySpan(0),
   mPreallocSize(0),
-  mPreallocIteration(0)
+  mPreallocIteration(0),
+  mPostallocSize(0),
+  mRingSlots(0),
+  mRevision(0),
+  mRemovedFrontCount(0),
+  mPyramidValid(true)
 {
 }
 
@@ -2592,6 +2873,51 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Puts the container into ring mode with a fixed window of \a capacity data points. Whenever data is
+  added and the container holds more than \a capacity points, the ones with the smallest keys are
+  evicted. Set \a capacity to 0 to disable the limit by count.
+
+  In ring mode, data points that are appended (with keys not smaller than the existing ones) and
+  evicted only cost a constant amount of work per data point, see the detailed description. The
+  storage of the ring grows with the data up to twice \a capacity and then stays fixed. Any other
+  modification, e.g. inserting data points in between existing ones, lays out the data linearly,
+  performs the modification like outside of ring mode and then lays out the ring again.
+
+  While in ring mode, \ref setAutoSqueeze and \ref squeeze have no effect.
+
+  \see setRingKeySpan, isRingMode
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setRingCapacity(int capacity)
+{
+  unfoldRing();
+  mRingCapacity = qMax(0, capacity);
+  foldRing();
+}
+
+/*!
+  Puts the container into ring mode with a window spanning \a keySpan in (sort-)key coordinates.
+  Whenever data is added, points with keys smaller than the largest key minus \a keySpan are evicted.
+  Set \a keySpan to 0 to disable the limit by key span.
+
+  The evicted data points are found with a binary search, so evicting by key span costs O(log N)
+  per added data range in addition to the constant cost per data point, see \ref setRingCapacity.
+  Without a capacity, the storage of the ring grows with the number of data points the key span
+  holds.
+
+  This can be combined with \ref setRingCapacity, in which case both limits apply.
+
+  \see setRingCapacity, isRingMode
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setRingKeySpan(double keySpan)
+{
+  unfoldRing();
+  mRingKeySpan = qMax(0.0, keySpan);
+  foldRing();
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2620,7 +2946,14 @@ void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool already
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
-  if (!alreadySorted)
+  mPostallocSize = 0;
+  mRingSlots = 0;
+  ++mRevision;
+  if (alreadySorted)
+  {
+    foldRing();
+    rebuildPyramid();
+  } else
     sort();
 }
 
@@ -2635,7 +2968,17 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
 {
   if (data.isEmpty())
     return;
+  if (isRingMode())
+  {
+    if (isEmpty() || !qcpLessThanSortKey<DataType>(*data.constBegin(), *(constEnd()-1))) // appends are handled in the ring
+    {
+      appendToRing(&*data.constBegin(), &*data.constBegin()+data.size());
+      return;
+    }
+    unfoldRing();
+  }
   
+  const quint64 oldRevision = mRevision;
   const int n = data.size();
   const int oldSize = size();
   
@@ -2645,13 +2988,19 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
       preallocateGrow(n);
     mPreallocSize -= n;
     std::copy(data.constBegin(), data.constEnd(), begin());
+    ++mRevision;
   } else // don't need to prepend, so append and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), mData.end()-n);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+    {
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      ++mRevision;
+    }
   }
+  foldRing();
+  updatePyramid(oldRevision);
 }
 
 /*!
@@ -2667,12 +3016,29 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 {
   if (data.isEmpty())
     return;
+  if (isRingMode())
+  {
+    if (!alreadySorted) // sort a copy of the new data, so it can still be appended to the ring
+    {
+      QVector<DataType> sortedData(data);
+      std::sort(sortedData.begin(), sortedData.end(), qcpLessThanSortKey<DataType>);
+      add(sortedData, true);
+      return;
+    }
+    if (isEmpty() || !qcpLessThanSortKey<DataType>(*data.constBegin(), *(constEnd()-1))) // appends are handled in the ring
+    {
+      appendToRing(data.constData(), data.constData()+data.size());
+      return;
+    }
+    unfoldRing();
+  }
   if (isEmpty())
   {
     set(data, alreadySorted);
     return;
   }
   
+  const quint64 oldRevision = mRevision;
   const int n = data.size();
   const int oldSize = size();
   
@@ -2682,15 +3048,21 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
       preallocateGrow(n);
     mPreallocSize -= n;
     std::copy(data.constBegin(), data.constEnd(), begin());
+    ++mRevision;
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
     mData.resize(mData.size()+n);
-    std::copy(data.constBegin(), data.constEnd(), end()-n);
+    std::copy(data.constBegin(), data.constEnd(), mData.end()-n);
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
-      std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
+      std::sort(mData.end()-n, mData.end(), qcpLessThanSortKey<DataType>);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+    {
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      ++mRevision;
+    }
   }
+  foldRing();
+  updatePyramid(oldRevision);
 }
 
 /*! \overload
@@ -2702,6 +3074,16 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
 template <class DataType>
 void QCPDataContainer<DataType>::add(const DataType &data)
 {
+  if (isRingMode())
+  {
+    if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // appends are handled in the ring
+    {
+      appendToRing(&data, &data+1);
+      return;
+    }
+    unfoldRing();
+  }
+  const quint64 oldRevision = mRevision;
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
     mData.append(data);
@@ -2711,11 +3093,15 @@ void QCPDataContainer<DataType>::add(const DataType &data)
       preallocateGrow(1);
     --mPreallocSize;
     *begin() = data;
+    ++mRevision;
   } else // handle inserts, maintaining sorted keys
   {
     QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
     mData.insert(insertionPoint, data);
+    ++mRevision;
   }
+  foldRing();
+  updatePyramid(oldRevision);
 }
 
 /*!
@@ -2726,11 +3112,8 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 template <class DataType>
 void QCPDataContainer<DataType>::removeBefore(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = begin();
-  QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  mPreallocSize += itEnd-it; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
-  if (mAutoSqueeze)
-    performAutoSqueeze();
+  QCPDataContainer<DataType>::const_iterator itEnd = std::lower_bound(constBegin(), constEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  removeFront(int(itEnd-constBegin()));
 }
 
 /*!
@@ -2741,9 +3124,14 @@ void QCPDataContainer<DataType>::removeBefore(double sortKey)
 template <class DataType>
 void QCPDataContainer<DataType>::removeAfter(double sortKey)
 {
-  QCPDataContainer<DataType>::iterator it = std::upper_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = end();
-  mData.erase(it, itEnd); // typically adds it to the postallocated block
+  QCPDataContainer<DataType>::const_iterator it = std::upper_bound(constBegin(), constEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  const int count = int(constEnd()-it);
+  if (mRingSlots > 0) // the remaining data stays mirrored, so the ring only gets shorter
+    mPostallocSize += count;
+  else
+    mData.erase(mData.end()-count, mData.end()); // typically adds it to the postallocated block
+  ++mRevision;
+  mPyramid.removeAfter((qint64(mRemovedFrontCount)+size()) >> BlockShift);
   if (mAutoSqueeze)
     performAutoSqueeze();
 }
@@ -2761,9 +3149,20 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
   if (sortKeyFrom >= sortKeyTo || isEmpty())
     return;
   
-  QCPDataContainer<DataType>::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
-  QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, end(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
-  mData.erase(it, itEnd);
+  QCPDataContainer<DataType>::const_iterator it = std::lower_bound(constBegin(), constEnd(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
+  QCPDataContainer<DataType>::const_iterator itEnd = std::upper_bound(it, constEnd(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  if (it == constBegin())
+  {
+    removeFront(int(itEnd-it));
+    return;
+  }
+  const int from = int(it-constBegin());
+  const int to = int(itEnd-constBegin());
+  unfoldRing();
+  mData.erase(begin()+from, begin()+to);
+  ++mRevision;
+  foldRing();
+  rebuildPyramid();
   if (mAutoSqueeze)
     performAutoSqueeze();
 }
@@ -2780,13 +3179,20 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
 template <class DataType>
 void QCPDataContainer<DataType>::remove(double sortKey)
 {
-  QCPDataContainer::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
-  if (it != end() && it->sortKey() == sortKey)
+  QCPDataContainer::const_iterator it = std::lower_bound(constBegin(), constEnd(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
+  if (it != constEnd() && it->sortKey() == sortKey)
   {
-    if (it == begin())
-      ++mPreallocSize; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
-    else
-      mData.erase(it);
+    if (it == constBegin())
+    {
+      removeFront(1);
+      return;
+    }
+    const int index = int(it-constBegin());
+    unfoldRing();
+    mData.erase(begin()+index);
+    ++mRevision;
+    foldRing();
+    rebuildPyramid();
   }
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2803,6 +3209,10 @@ void QCPDataContainer<DataType>::clear()
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
+  mPostallocSize = 0;
+  mRingSlots = 0;
+  ++mRevision;
+  rebuildPyramid();
 }
 
 /*!
@@ -2820,6 +3230,9 @@ template <class DataType>
 void QCPDataContainer<DataType>::sort()
 {
   std::sort(begin(), end(), qcpLessThanSortKey<DataType>);
+  ++mRevision;
+  foldRing();
+  rebuildPyramid();
 }
 
 /*!
@@ -2831,15 +3244,21 @@ void QCPDataContainer<DataType>::sort()
   
   The parameters \a preAllocation and \a postAllocation control whether pre- and/or post allocation
   should be freed, respectively.
+  
+  In ring mode (\ref setRingCapacity), the storage of the ring is kept and this method does
+  nothing.
 */
 template <class DataType>
 void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation)
 {
+  if (mRingSlots > 0)
+    return;
   if (preAllocation)
   {
     if (mPreallocSize > 0)
     {
-      std::copy(begin(), end(), mData.begin());
+      iterator dataBegin = mData.begin();
+      std::copy(dataBegin+mPreallocSize, mData.end(), dataBegin);
       mData.resize(size());
       mPreallocSize = 0;
     }
@@ -3039,6 +3458,10 @@ QCPRange QCPDataContainer<DataType>::keyRange(bool &foundRange, QCP::SignDomain
   relevant e.g. for logarithmic plots which can mathematically only display one sign domain at a
   time.
 
+  For \a signDomain \ref QCP::sdBoth, the range is found with \ref valueMinMax in O(log N), also
+  with \a inKeyRange restricting the keys, if the sort key is the main key. Otherwise the data
+  points are scanned.
+
   \see keyRange
 */
 template <class DataType>
@@ -3051,6 +3474,18 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
   }
   QCPRange range;
   const bool restrictKeyRange = inKeyRange != QCPRange();
+  if (signDomain == QCP::sdBoth && (DataType::sortKeyIsMainKey() || !restrictKeyRange))
+  {
+    int beginIndex = 0;
+    int endIndex = size();
+    if (restrictKeyRange)
+    {
+      beginIndex = int(findBegin(inKeyRange.lower, false)-constBegin());
+      endIndex = int(findEnd(inKeyRange.upper, false)-constBegin());
+    }
+    foundRange = valueMinMax(beginIndex, endIndex, range.lower, range.upper);
+    return range;
+  }
   bool haveLower = false;
   bool haveUpper = false;
   QCPRange current;
@@ -3121,6 +3556,46 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
   return range;
 }
 
+/*!
+  Determines the extrema of the value ranges (\a DataType::valueRange) of the data points with
+  indices from \a begin up to (excluding) \a end, and returns them via \a minValue and \a
+  maxValue. NaN values are ignored. Returns false if the index range is empty or only holds NaN
+  values.
+  
+  The data points of incomplete blocks at both ends of the range are scanned, the complete blocks
+  of 16 data points in between are combined from the value pyramid in O(log N). The pyramid is only
+  read here, so graphs sharing the container may call this from several threads at once, as long as
+  the container isn't modified meanwhile.
+  
+  \see valueRange
+*/
+template <class DataType>
+bool QCPDataContainer<DataType>::valueMinMax(int begin, int end, double &minValue, double &maxValue) const
+{
+  begin = qMax(begin, 0);
+  end = qMin(end, size());
+  QCPValueExtrema result = QCPValuePyramid::emptyExtrema();
+  if (begin < end)
+  {
+    const qint64 blockSize = Q_INT64_C(1) << BlockShift;
+    const qint64 base = qint64(mRemovedFrontCount);
+    const qint64 first = (base+begin+blockSize-1) >> BlockShift; // first complete block
+    const qint64 last = (base+end) >> BlockShift; // block after the last complete block
+    if (mPyramidValid && first < last)
+    {
+      expandExtrema(result, begin, int((first << BlockShift)-base));
+      mPyramid.expand(result, first, last);
+      expandExtrema(result, int((last << BlockShift)-base), end);
+    } else
+      expandExtrema(result, begin, end);
+  }
+  if (!(result.minValue <= result.maxValue))
+    return false;
+  minValue = result.minValue;
+  maxValue = result.maxValue;
+  return true;
+}
+
 /*!
   Makes sure \a begin and \a end mark a data range that is both within the bounds of this data
   container's data, as well as within the specified \a dataRange.
@@ -3179,6 +3654,8 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
 template <class DataType>
 void QCPDataContainer<DataType>::performAutoSqueeze()
 {
+  if (isRingMode()) // the ring recycles its storage itself, see appendToRing
+    return;
   const int totalAlloc = mData.capacity();
   const int postAllocSize = totalAlloc-mData.size();
   const int usedSize = size();
@@ -3197,6 +3674,224 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
   if (shrinkPreAllocation || shrinkPostAllocation)
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
+
+/*! \internal
+  
+  Builds the value pyramid anew from all data points. Called by all modifications that change the
+  data in other ways than appending and removing from the front.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::rebuildPyramid()
+{
+  mPyramid.clear((qint64(mRemovedFrontCount)+(Q_INT64_C(1) << BlockShift)-1) >> BlockShift);
+  mPyramidValid = true;
+  updatePyramid(mRevision);
+}
+
+/*! \internal
+  
+  Brings the value pyramid up to date after data points were added. If the revision changed from
+  \a oldRevision, the data was modified in between and the pyramid is rebuilt. Otherwise the data
+  was only appended, and the blocks completed by it are added to the pyramid.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::updatePyramid(quint64 oldRevision)
+{
+  if (mRevision != oldRevision || !mPyramidValid)
+  {
+    rebuildPyramid();
+    return;
+  }
+  const qint64 base = qint64(mRemovedFrontCount);
+  const qint64 endBlock = (base+size()) >> BlockShift;
+  for (qint64 block = mPyramid.endBlock(); block < endBlock; ++block)
+  {
+    QCPValueExtrema extrema = QCPValuePyramid::emptyExtrema();
+    expandExtrema(extrema, int((block << BlockShift)-base), int(((block+1) << BlockShift)-base));
+    mPyramid.appendBlock(extrema);
+  }
+}
+
+/*! \internal
+  
+  Widens \a result by the value ranges of the data points with indices from \a begin up to
+  (excluding) \a end, ignoring NaN values.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::expandExtrema(QCPValueExtrema &result, int begin, int end) const
+{
+  for (const_iterator it = constBegin()+begin, itEnd = constBegin()+end; it != itEnd; ++it)
+  {
+    const QCPRange range = it->valueRange();
+    if (range.lower < result.minValue) // comparisons with NaN are false, so NaN is skipped
+      result.minValue = range.lower;
+    if (range.upper > result.maxValue)
+      result.maxValue = range.upper;
+  }
+}
+
+/*! \internal
+  
+  Removes the first \a count data points by adding them to the preallocated block, without actually
+  deleting them. In the mirrored ring layout, the start of the window jumps back into the first
+  copy once it has passed the second one.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::removeFront(int count)
+{
+  mPreallocSize += count; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
+  mRemovedFrontCount += count;
+  if (mRingSlots > 0 && mPreallocSize >= mRingSlots)
+  {
+    mPreallocSize -= mRingSlots;
+    mPostallocSize += mRingSlots;
+  }
+  mPyramid.removeBefore((qint64(mRemovedFrontCount)+(Q_INT64_C(1) << BlockShift)-1) >> BlockShift);
+  if (mAutoSqueeze)
+    performAutoSqueeze();
+}
+
+/*! \internal
+  
+  Appends the sorted data points [\a first, \a last) in ring mode. Their keys must not be smaller
+  than the ones already in the container.
+  
+  The data points that fall out of the window are evicted first, new data points that would be
+  evicted right away are skipped. The remaining ones are written right behind the current data and
+  to the mirrored slots one ring size apart. The storage only grows (see \ref layoutRing) while the
+  window grows, so in steady state no data point is moved.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::appendToRing(const DataType *first, const DataType *last)
+{
+  if (mRingKeySpan > 0)
+  {
+    const DataType minKey = DataType::fromSortKey((last-1)->sortKey()-mRingKeySpan);
+    removeFront(int(std::lower_bound(constBegin(), constEnd(), minKey, qcpLessThanSortKey<DataType>)-constBegin()));
+    const DataType *kept = std::lower_bound(first, last, minKey, qcpLessThanSortKey<DataType>);
+    mRemovedFrontCount += kept-first;
+    first = kept;
+  }
+  if (mRingCapacity > 0)
+  {
+    if (last-first > mRingCapacity)
+    {
+      mRemovedFrontCount += (last-first)-mRingCapacity;
+      first = last-mRingCapacity;
+    }
+    const int excess = size()+int(last-first)-mRingCapacity;
+    if (excess > 0)
+      removeFront(excess);
+  }
+  
+  const int count = int(last-first);
+  if (mRingSlots == 0 || size()+count > mRingSlots)
+    layoutRing(size()+count);
+  // the slots in the first copy are mirrored behind it, the ones in the second copy in front of it:
+  DataType *data = mData.data();
+  const int begin = mPreallocSize+size();
+  const int end = begin+count;
+  const int lowerEnd = qMin(end, mRingSlots);
+  if (begin < lowerEnd)
+  {
+    std::copy(first, first+(lowerEnd-begin), data+begin);
+    std::copy(first, first+(lowerEnd-begin), data+begin+mRingSlots);
+  }
+  const int upperBegin = qMax(begin, mRingSlots);
+  if (upperBegin < end)
+  {
+    std::copy(first+(upperBegin-begin), last, data+upperBegin);
+    std::copy(first+(upperBegin-begin), last, data+upperBegin-mRingSlots);
+  }
+  mPostallocSize -= count;
+  mPyramid.removeBefore((qint64(mRemovedFrontCount)+(Q_INT64_C(1) << BlockShift)-1) >> BlockShift); // also drops the blocks of skipped data points
+  updatePyramid(mRevision);
+}
+
+/*! \internal
+  
+  Evicts the data points that fall out of the window set with \ref setRingCapacity and \ref
+  setRingKeySpan from the front of the container.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::performRingEviction()
+{
+  if (isEmpty())
+    return;
+  if (mRingCapacity > 0 && size() > mRingCapacity)
+    removeFront(size()-mRingCapacity);
+  if (mRingKeySpan > 0)
+  {
+    const DataType minKey = DataType::fromSortKey((constEnd()-1)->sortKey()-mRingKeySpan);
+    removeFront(int(std::lower_bound(constBegin(), constEnd(), minKey, qcpLessThanSortKey<DataType>)-constBegin()));
+  }
+}
+
+/*! \internal
+  
+  In ring mode, evicts the data points that fall out of the window and lays out the remaining ones
+  as a mirrored ring, unless they already are. Does nothing outside of ring mode.
+  
+  \see unfoldRing
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::foldRing()
+{
+  if (!isRingMode() || mRingSlots > 0)
+    return;
+  performRingEviction();
+  if (isEmpty()) // the storage is laid out by the next append
+  {
+    mData.clear();
+    mPreallocSize = 0;
+    mPreallocIteration = 0;
+  } else
+    layoutRing(size());
+}
+
+/*! \internal
+  
+  Lays out the data linearly again if it is stored in a mirrored ring, so it can be modified like
+  outside of ring mode. The data points themselves are unchanged.
+  
+  \see foldRing
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::unfoldRing()
+{
+  if (mRingSlots == 0)
+    return;
+  QVector<DataType> data = mData.mid(mPreallocSize, size());
+  mData.swap(data);
+  mPreallocSize = 0;
+  mPreallocIteration = 0;
+  mPostallocSize = 0;
+  mRingSlots = 0;
+}
+
+/*! \internal
+  
+  Copies the data into new storage for a mirrored ring that holds at least \a minimumSlots data
+  points, and at most \ref setRingCapacity. Below the capacity, the ring is made twice as large as
+  needed, so a growing window is laid out anew only a logarithmic number of times.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::layoutRing(int minimumSlots)
+{
+  int slots = qMax(qMin(minimumSlots, std::numeric_limits<int>::max()/4)*2, 1024);
+  if (mRingCapacity > 0)
+    slots = qMin(slots, mRingCapacity);
+  slots = qMax(slots, minimumSlots);
+  const int count = size();
+  QVector<DataType> data(2*slots);
+  std::copy(constBegin(), constEnd(), data.begin());
+  std::copy(constBegin(), constEnd(), data.begin()+slots);
+  mData.swap(data);
+  mPreallocSize = 0;
+  mPreallocIteration = 0;
+  mPostallocSize = 2*slots-count;
+  mRingSlots = slots;
+}
 /* end of 'src/datacontainer.cpp' */
 
 
@@ -3303,6 +3998,10 @@ public:
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const = 0;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const = 0;
   
+  // reimplemented virtual methods:
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
+  virtual void markDirty() Q_DECL_OVERRIDE;
+  
   // non-property methods:
   void coordsToPixels(double key, double value, double &x, double &y) const;
   const QPointF coordsToPixels(double key, double value) const;
@@ -3343,6 +4042,8 @@ protected:
   
   // introduced virtual methods:
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const = 0;
+  virtual void prepareDraw();
+  virtual quint64 dataSignature() const;
   
   // non-virtual methods:
   void applyFillAntialiasingHint(QCPPainter *painter) const;
@@ -3498,6 +4199,7 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE = 0;
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
   
   // non-virtual methods:
   QList<QCPItemPosition*> positions() const { return mPositions; }
@@ -3548,6 +4250,57 @@ private:
 /* including file 'src/core.h', size 14797                                   */
 /* commit 633339dadc92cb10c58ef3556b55570685fafb99 2016-09-13 23:54:56 +0200 */
 
+class QCP_LIB_DECL QCPReplotStats
+{
+public:
+  /*!
+    Holds the time one named part of the plot took to draw during the last replot.
+  */
+  struct Timing
+  {
+    Timing() : nanoseconds(0) {}
+    Timing(const QString &name, qint64 nanoseconds) : name(name), nanoseconds(nanoseconds) {}
+    QString name;
+    qint64 nanoseconds;
+  };
+  
+  QCPReplotStats();
+  
+  // getters:
+  int historySize() const { return mHistorySize; }
+  
+  // setters:
+  void setHistorySize(int size);
+  
+  // non-property methods:
+  void clear();
+  void addToHistory(qint64 replotTime);
+  QVector<qint64> history() const;
+  QVector<int> histogram(qint64 binWidth, int binCount) const;
+  qint64 percentile(double fraction) const;
+  
+  // timings of the last replot, in nanoseconds:
+  int replotCount;
+  qint64 replotTime;
+  qint64 updateLayoutTime;
+  qint64 setupPaintBuffersTime;
+  qint64 prepareTime;
+  qint64 layerDrawTime;
+  qint64 paintEventTime;
+  QVector<Timing> layerTimes;
+  QVector<Timing> plottableTimes;
+  
+protected:
+  // property members:
+  int mHistorySize;
+  
+  // non-property members:
+  QVector<qint64> mHistory;
+  int mHistoryIndex;
+};
+Q_DECLARE_TYPEINFO(QCPReplotStats::Timing, Q_MOVABLE_TYPE);
+
+
 class QCP_LIB_DECL QCustomPlot : public QWidget
 {
   Q_OBJECT
@@ -3562,6 +4315,7 @@ class QCP_LIB_DECL QCustomPlot : public QWidget
   Q_PROPERTY(bool noAntialiasingOnDrag READ noAntialiasingOnDrag WRITE setNoAntialiasingOnDrag)
   Q_PROPERTY(Qt::KeyboardModifier multiSelectModifier READ multiSelectModifier WRITE setMultiSelectModifier)
   Q_PROPERTY(bool openGl READ openGl WRITE setOpenGl)
+  Q_PROPERTY(bool tiledRendering READ tiledRendering WRITE setTiledRendering)
   /// \endcond
 public:
   /*!
@@ -3607,6 +4361,10 @@ public:
   QCP::SelectionRectMode selectionRectMode() const { return mSelectionRectMode; }
   QCPSelectionRect *selectionRect() const { return mSelectionRect; }
   bool openGl() const { return mOpenGl; }
+  bool tiledRendering() const { return mTiledRendering; }
+  int renderTiles() const { return mRenderTiles; }
+  bool replotTiming() const { return mReplotTiming; }
+  const QCPReplotStats &replotStats() const { return mReplotStats; }
   
   // setters:
   void setViewport(const QRect &rect);
@@ -3631,6 +4389,8 @@ public:
   void setSelectionRectMode(QCP::SelectionRectMode mode);
   void setSelectionRect(QCPSelectionRect *selectionRect);
   void setOpenGl(bool enabled, int multisampling=16);
+  void setTiledRendering(bool enabled, int tiles=0);
+  void setReplotTiming(bool enabled, int historySize=0);
   
   // non-property methods:
   // plottable interface:
@@ -3745,15 +4505,20 @@ protected:
   QCP::SelectionRectMode mSelectionRectMode;
   QCPSelectionRect *mSelectionRect;
   bool mOpenGl;
+  bool mTiledRendering;
+  int mRenderTiles;
+  bool mReplotTiming;
   
   // non-property members:
   QList<QSharedPointer<QCPAbstractPaintBuffer> > mPaintBuffers;
+  QCPReplotStats mReplotStats;
   QPoint mMousePressPos;
   bool mMouseHasMoved;
   QPointer<QCPLayerable> mMouseEventLayerable;
   QVariant mMouseEventLayerableDetails;
   bool mReplotting;
   bool mReplotQueued;
+  quint64 mReplotSerial;
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
@@ -3794,6 +4559,9 @@ protected:
   void setupPaintBuffers();
   QCPAbstractPaintBuffer *createPaintBuffer();
   bool hasInvalidatedPaintBuffers();
+  void updateDirtyLayers();
+  void preparePlottables();
+  static void preparePlottable(QCPAbstractPlottable *plottable);
   bool setupOpenGl();
   void freeOpenGl();
   
@@ -3859,6 +4627,9 @@ protected:
   // property members:
   QSharedPointer<QCPDataContainer<DataType> > mDataContainer;
   
+  // reimplemented virtual methods:
+  virtual quint64 dataSignature() const;
+  
   // helpers for subclasses:
   void getDataSegments(QList<QCPDataRange> &selectedSegments, QList<QCPDataRange> &unselectedSegments) const;
   void drawPolyline(QCPPainter *painter, const QVector<QPointF> &lineData) const;
@@ -4299,6 +5070,31 @@ double QCPAbstractPlottable1D<DataType>::selectTest(const QPointF &pos, bool onl
   return qSqrt(minDistSqr);
 }
 
+/*! \internal
+
+  Identifies the data container and its state by the container's \ref QCPDataContainer::revision,
+  \ref QCPDataContainer::removedFrontCount and size, and the last data point. This changes when
+  data is set, added, removed or evicted, but not when data points are modified in place through
+  the non-const iterators of the container. After such modifications, call \ref markDirty.
+
+  \seebaseclassmethod
+*/
+template <class DataType>
+quint64 QCPAbstractPlottable1D<DataType>::dataSignature() const
+{
+  quint64 result = QCP::hashCombine(quint64(1), quint64(quintptr(mDataContainer.data())));
+  result = QCP::hashCombine(result, mDataContainer->revision());
+  result = QCP::hashCombine(result, mDataContainer->removedFrontCount());
+  result = QCP::hashCombine(result, quint64(mDataContainer->size()));
+  if (!mDataContainer->isEmpty())
+  {
+    const DataType &last = *(mDataContainer->constEnd()-1);
+    result = QCP::hashCombine(result, last.mainKey());
+    result = QCP::hashCombine(result, last.mainValue());
+  }
+  return result;
+}
+
 /*!
   Splits all data into selected and unselected segments and outputs them via \a selectedSegments
   and \a unselectedSegments, respectively.
@@ -4571,6 +5367,8 @@ public:
   QList<QCPAxis*> rangeDragAxes(Qt::Orientation orientation);
   QList<QCPAxis*> rangeZoomAxes(Qt::Orientation orientation);
   double rangeZoomFactor(Qt::Orientation orientation);
+  QCPLayer *scrollLayer() const { return mScrollLayer.data(); }
+  QCPAxis *scrollKeyAxis() const { return mScrollKeyAxis.data(); }
   
   // setters:
   void setBackground(const QPixmap &pm);
@@ -4588,8 +5386,10 @@ public:
   void setRangeZoomAxes(QList<QCPAxis*> horizontal, QList<QCPAxis*> vertical);
   void setRangeZoomFactor(double horizontalFactor, double verticalFactor);
   void setRangeZoomFactor(double factor);
+  void setScrollLayer(QCPLayer *layer, QCPAxis *keyAxis=0);
   
   // non-property methods:
+  void invalidateScrollBuffer();
   int axisCount(QCPAxis::AxisType type) const;
   QCPAxis *axis(QCPAxis::AxisType type, int index=0) const;
   QList<QCPAxis*> axes(QCPAxis::AxisTypes types) const;
@@ -4636,6 +5436,8 @@ protected:
   QList<QPointer<QCPAxis> > mRangeDragHorzAxis, mRangeDragVertAxis;
   QList<QPointer<QCPAxis> > mRangeZoomHorzAxis, mRangeZoomVertAxis;
   double mRangeZoomFactorHorz, mRangeZoomFactorVert;
+  QPointer<QCPLayer> mScrollLayer;
+  QPointer<QCPAxis> mScrollKeyAxis;
   
   // non-property members:
   QList<QCPRange> mDragStartHorzRange, mDragStartVertRange;
@@ -4643,6 +5445,20 @@ protected:
   QPoint mDragStart;
   bool mDragging;
   QHash<QCPAxis::AxisType, QList<QCPAxis*> > mAxes;
+  // state of the scroll layer contents left by the previous replot:
+  bool mScrollValid;
+  QWeakPointer<QCPAbstractPaintBuffer> mScrollBuffer;
+  QSize mScrollBufferSize;
+  double mScrollBufferRatio;
+  QRect mScrollRect;
+  double mScrollKeySpan;
+  double mScrollAnchorKey, mScrollAnchorPixel;
+  QList<QCPRange> mScrollValueRanges;
+  uint mScrollSignature;
+  // strip of the scroll layer that is redrawn during the current replot:
+  bool mScrollStripActive;
+  QRect mScrollStripRect;
+  QCPRange mScrollStripKeyRange;
   
   // reimplemented virtual methods:
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const Q_DECL_OVERRIDE;
@@ -4658,11 +5474,19 @@ protected:
   // non-property methods:
   void drawBackground(QCPPainter *painter);
   void updateAxesOffset(QCPAxis::AxisType type);
+  void alignScrollRange();
+  void setupScrollBuffer();
+  void finishScrollFrame();
+  bool scrollKeyAxisUsable() const;
+  QList<QCPRange> scrollValueRanges() const;
+  uint scrollSignature() const;
   
 private:
   Q_DISABLE_COPY(QCPAxisRect)
   
   friend class QCustomPlot;
+  friend class QCPLayer;
+  friend class QCPGraph;
 };
 
 
@@ -5046,6 +5870,7 @@ public:
   
   // reimplemented virtual methods:
   virtual void update(UpdatePhase phase) Q_DECL_OVERRIDE;
+  virtual void markDirty() Q_DECL_OVERRIDE;
   
 signals:
   void dataRangeChanged(const QCPRange &newRange);
@@ -5116,6 +5941,105 @@ Q_DECLARE_TYPEINFO(QCPGraphData, Q_PRIMITIVE_TYPE);
 */
 typedef QCPDataContainer<QCPGraphData> QCPGraphDataContainer;
 
+class QCP_LIB_DECL QCPGraphColumnContainer
+{
+  Q_GADGET
+public:
+  /*!
+    Defines how the values are stored. The plotted value is the stored value multiplied with the
+    value scale plus the value offset (see \ref setValueScale).
+  */
+  enum ValueType { vtFloat32 ///< 4 byte IEEE floating point, may hold NaN to mark gaps in the data
+                   ,vtInt32  ///< 4 byte signed integer, e.g. raw fixed-point process data
+                   ,vtInt16  ///< 2 byte signed integer, e.g. raw fixed-point process data
+                 };
+  Q_ENUMS(ValueType)
+  
+  explicit QCPGraphColumnContainer(ValueType valueType=vtFloat32);
+  
+  // getters:
+  ValueType valueType() const { return mValueType; }
+  double keyOrigin() const { return mKeyOrigin; }
+  double keyStep() const { return mKeyStep; }
+  double valueScale() const { return mValueScale; }
+  double valueOffset() const { return mValueOffset; }
+  int ringCapacity() const { return mRingCapacity; }
+  double ringKeySpan() const { return mRingKeySpan; }
+  int size() const { return mSize; }
+  bool isEmpty() const { return mSize == 0; }
+  quint64 revision() const { return mRevision; }
+  quint64 removedFrontCount() const { return mRemovedFrontCount; }
+  bool isExternal() const { return mExternalValues != 0; }
+  int stride() const { return mStride; }
+  
+  // setters:
+  void setKeys(double origin, double step);
+  void setValueScale(double scale, double offset=0);
+  void setRingCapacity(int capacity);
+  void setRingKeySpan(double keySpan);
+  void setExternalValues(const char *values, int count, int stride=0);
+  
+  // non-property methods:
+  void extendExternalValues(const char *values, int count);
+  void add(const double *values, int count);
+  void add(const float *values, int count);
+  void add(const qint32 *values, int count);
+  void add(const qint16 *values, int count);
+  void clear();
+  double key(int index) const { return mKeyOrigin + (double(mRemovedFrontCount)+index)*mKeyStep; }
+  double value(int index) const;
+  int findBegin(double key, bool expandedRange=true) const;
+  int findEnd(double key, bool expandedRange=true) const;
+  QCPRange keyRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth) const;
+  QCPRange valueRange(bool &foundRange, QCP::SignDomain signDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const;
+  bool valueMinMax(int begin, int end, double &minValue, double &maxValue) const;
+  int bytesPerValue() const;
+  
+protected:
+  // property members:
+  ValueType mValueType;
+  double mKeyOrigin;
+  double mKeyStep;
+  double mValueScale;
+  double mValueOffset;
+  int mRingCapacity;
+  double mRingKeySpan;
+  
+  enum { BlockShift = 6 }; // 64 values per block of the value pyramid
+  
+  // reads the raw value extrema of a block of the value pyramid on demand:
+  struct BlockReader
+  {
+    const QCPGraphColumnContainer *container;
+    QCPValueExtrema operator()(qint64 block) const { return container->blockExtrema(block); }
+  };
+  
+  // non-property members:
+  QByteArray mValues;
+  const char *mExternalValues;
+  int mStride;
+  int mRingSlots; // values held by one copy of the mirrored ring, 0 without ring
+  int mFront;
+  int mSize;
+  quint64 mRevision;
+  quint64 mRemovedFrontCount;
+  mutable QCPValuePyramid mPyramid; // raw value extrema of the complete blocks, counted from the first value ever added, unknown (NaN) for external values until first needed
+  mutable QMutex mPyramidMutex; // guards filling in the unknown blocks of mPyramid, since graphs sharing the container may be prepared concurrently
+  
+  // non-virtual methods:
+  int ringWindow() const;
+  void updateRing();
+  char *appendValues(int count);
+  int skipEvicted(int count);
+  void mirrorValues(int count);
+  void performRingEviction();
+  void updatePyramid();
+  void expandMinMax(int begin, int end, QCPValueExtrema &result) const;
+  QCPValueExtrema blockExtrema(qint64 block) const;
+  const char *valueData(int index) const { return (mExternalValues ? mExternalValues : mValues.constData()) + (qptrdiff(mFront)+index)*mStride; }
+};
+Q_DECLARE_METATYPE(QCPGraphColumnContainer::ValueType)
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
 {
   Q_OBJECT
@@ -5147,6 +6071,7 @@ public:
   
   // getters:
   QSharedPointer<QCPGraphDataContainer> data() const { return mDataContainer; }
+  QSharedPointer<QCPGraphColumnContainer> columnData() const { return mColumnData; }
   LineStyle lineStyle() const { return mLineStyle; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   int scatterSkip() const { return mScatterSkip; }
@@ -5156,6 +6081,7 @@ public:
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
   void setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
+  void setColumnData(QSharedPointer<QCPGraphColumnContainer> data);
   void setLineStyle(LineStyle ls);
   void setScatterStyle(const QCPScatterStyle &style);
   void setScatterSkip(int skip);
@@ -5167,21 +6093,36 @@ public:
   void addData(double key, double value);
   
   // reimplemented virtual methods:
+  virtual int dataCount() const Q_DECL_OVERRIDE;
+  virtual double dataMainKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataSortKey(int index) const Q_DECL_OVERRIDE;
+  virtual double dataMainValue(int index) const Q_DECL_OVERRIDE;
+  virtual QCPRange dataValueRange(int index) const Q_DECL_OVERRIDE;
+  virtual int findBegin(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
+  virtual int findEnd(double sortKey, bool expandedRange=true) const Q_DECL_OVERRIDE;
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
 protected:
   // property members:
+  QSharedPointer<QCPGraphColumnContainer> mColumnData;
   LineStyle mLineStyle;
   QCPScatterStyle mScatterStyle;
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
   
+  // non-property members:
+  QVector<QVector<QPointF> > mPreparedLines;
+  quint64 mPreparedReplot;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  virtual bool reentrantDraw() const Q_DECL_OVERRIDE;
+  virtual void prepareDraw() Q_DECL_OVERRIDE;
+  virtual quint64 dataSignature() const Q_DECL_OVERRIDE;
   
   // introduced virtual methods:
   virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lines) const;
@@ -5194,8 +6135,14 @@ protected:
   
   // non-virtual methods:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
+  QCPRange getVisibleKeyRange() const;
+  void getColumnVisibleBounds(int &begin, int &end, const QCPDataRange &rangeRestriction) const;
+  void getColumnLineData(QVector<QCPGraphData> *lineData, int begin, int end) const;
+  void getColumnScatterData(QVector<QCPGraphData> *scatterData, int begin, int end) const;
+  quint64 ownDataSignature() const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
+  void getDrawSegments(QList<QCPDataRange> &segments, int &unselectedCount) const;
   QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepLeftLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepRightLines(const QVector<QCPGraphData> &data) const;
@@ -5506,6 +6453,8 @@ protected:
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
+  virtual bool reentrantDraw() const Q_DECL_OVERRIDE;
+  virtual quint64 dataSignature() const Q_DECL_OVERRIDE;
   
   // non-virtual methods:
   void getVisibleDataBounds(QCPBarsDataContainer::const_iterator &begin, QCPBarsDataContainer::const_iterator &end) const;
@@ -6529,6 +7478,7 @@ public:
 
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
+  virtual quint64 drawSignature() const Q_DECL_OVERRIDE;
   
   // non-virtual methods:
   void updatePosition();